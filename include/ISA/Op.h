@@ -26,6 +26,19 @@ public:
   int getEnd() const { return end; }
 
   int getStride() const { return stride; }
+
+  // Number of elements selected by start:end:stride.
+  int getSize() const {
+    if (stride <= 0 || end <= start)
+      return 0;
+    return (end - start + stride - 1) / stride;
+  }
+
+  bool operator==(const Dim &other) const {
+    return start == other.start && end == other.end && stride == other.stride;
+  }
+
+  bool operator!=(const Dim &other) const { return !(*this == other); }
 };
 
 class SliceOperand {
@@ -47,9 +60,16 @@ public:
 
   int getBaseAddress() const { return baseAddress; }
 
-  Dim getDim1() const { return dim1; }
+  const Dim &getDim1() const { return dim1; }
 
-  Dim getDim0() const { return dim0; }
+  const Dim &getDim0() const { return dim0; }
+
+  bool operator==(const SliceOperand &other) const {
+    return baseAddress == other.baseAddress && dim1 == other.dim1 &&
+           dim0 == other.dim0;
+  }
+
+  bool operator!=(const SliceOperand &other) const { return !(*this == other); }
 };
 
 class BoolOperand {
@@ -75,9 +95,11 @@ private:
 public:
   Op(int opCode, ID coreId) : opCode(opCode), coreId(coreId) {}
 
+  int getOpCode() const { return opCode; }
+
   int getCoreNum() const { return coreId; }
 
-  ~Op() = default;
+  virtual ~Op() = default;
 
   virtual void dump() const = 0;
 };
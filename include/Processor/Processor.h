@@ -14,6 +14,11 @@ class MatmulUnit {
   int tile_n;
   int tile_k;
 
+  // Timing: cycles before the first result, and MACs retired per cycle once
+  // the pipeline is full (0 = one tile_m x tile_n wavefront per cycle).
+  int latency_cycles = 16;
+  int macs_per_cycle = 0;
+
 public:
   // Constructor using member initializer list
   MatmulUnit(int id, int tile_m, int tile_n, int tile_k)
@@ -23,10 +28,23 @@ public:
   std::string get_info() const {
     std::stringstream ss;
     ss << "Matmul Unit ID: " << id << ", with tile sizes M: " << tile_m
-       << ", N: " << tile_n << ", K: " << tile_k;
+       << ", N: " << tile_n << ", K: " << tile_k
+       << ", latency: " << latency_cycles
+       << " cycles, throughput: " << getMacsPerCycle() << " MACs/cycle";
     return ss.str();
   }
 
+  void setTiming(int latencyCycles, int macsPerCycle) {
+    latency_cycles = latencyCycles;
+    macs_per_cycle = macsPerCycle;
+  }
+
+  int getLatencyCycles() const { return latency_cycles; }
+
+  int getMacsPerCycle() const {
+    return macs_per_cycle > 0 ? macs_per_cycle : tile_m * tile_n;
+  }
+
   int getTileM() { return tile_m; }
 
   int getTileK() { return tile_k; }
@@ -40,6 +58,11 @@ class ComputeCore {
   size_t local_memory; // size_t is best for memory sizes
   std::vector<MatmulUnit> matmul_units;
 
+  // Timing of the core's DMA engine, which serves its cp ops: fixed setup
+  // cycles per transfer plus the transfer at the given bandwidth.
+  int dma_latency_cycles = 64;
+  int dma_bytes_per_cycle = 64;
+
 public:
   // Constructor
   ComputeCore(int id, size_t local_memory,
@@ -49,12 +72,24 @@ public:
   std::string get_info() const {
     std::stringstream ss;
     ss << "Compute Unit ID: " << id << " with Local Memory: " << local_memory
-       << " bytes";
+       << " bytes, DMA latency: " << dma_latency_cycles
+       << " cycles, DMA bandwidth: " << dma_bytes_per_cycle << " bytes/cycle";
     return ss.str();
   }
 
   const std::vector<MatmulUnit> &getMatmulUnits() const { return matmul_units; }
 
+  std::vector<MatmulUnit> &getMatmulUnits() { return matmul_units; }
+
+  void setDMATiming(int latencyCycles, int bytesPerCycle) {
+    dma_latency_cycles = latencyCycles;
+    dma_bytes_per_cycle = bytesPerCycle;
+  }
+
+  int getDMALatencyCycles() const { return dma_latency_cycles; }
+
+  int getDMABytesPerCycle() const { return dma_bytes_per_cycle; }
+
   int getLocalMemory() const { return local_memory; }
 };
 
@@ -65,6 +100,9 @@ public:
   size_t global_memory;
   std::vector<ComputeCore> compute_cores;
 
+  // Cycles for all cores to synchronize at an end_parallel.
+  int join_cycles = 32;
+
   // Constructor
   Processor(std::string name, size_t global_memory,
             const std::vector<ComputeCore> &compute_cores)
@@ -91,11 +129,16 @@ public:
 
   std::string getDeviceName() const { return name; }
 
+  int getJoinCycles() const { return join_cycles; }
+
+  void setJoinCycles(int cycles) { join_cycles = cycles; }
+
   std::string get_device_info() const {
     std::stringstream ss;
     ss << "Device: " << name << "\n";
     ss << "Global Memory: " << global_memory << " bytes\n";
     ss << "Number of Compute Cores: " << compute_cores.size() << "\n";
+    ss << "Parallel Join: " << join_cycles << " cycles\n";
 
     for (const auto &core : compute_cores) {
       ss << "  " << core.get_info() << "\n";
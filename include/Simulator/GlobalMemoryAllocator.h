@@ -0,0 +1,53 @@
+#include <cstddef>
+#include <map>
+
+#ifndef GLOBAL_MEMORY_ALLOCATOR_H
+#define GLOBAL_MEMORY_ALLOCATOR_H
+
+// Best-fit allocator for ranges of simulated global memory.
+//
+// Free ranges are indexed both by offset, to coalesce neighbours on release,
+// and by size, to find the smallest range that fits in O(log n). Every
+// allocation starts at a multiple of the alignment and is padded to one, so
+// handles never share a cache line.
+class GlobalMemoryAllocator {
+private:
+  size_t capacity = 0;
+  size_t alignment = 64;
+  size_t usedBytes = 0;
+  size_t highWaterMark = 0;
+
+  std::map<size_t, size_t> freeByOffset;     // offset -> size
+  std::multimap<size_t, size_t> freeBySize;  // size -> offset
+
+  void insertFree(size_t offset, size_t size);
+  void eraseFree(std::map<size_t, size_t>::iterator range);
+
+public:
+  GlobalMemoryAllocator() = default;
+
+  GlobalMemoryAllocator(size_t capacity, size_t alignment = 64);
+
+  size_t getAlignment() const { return alignment; }
+
+  // Bytes an allocation of `numBytes` actually occupies.
+  size_t getAllocationSize(size_t numBytes) const;
+
+  // Returns false if no free range is large enough.
+  bool allocate(size_t numBytes, size_t &offset);
+
+  // `numBytes` must be the size passed to allocate().
+  void release(size_t offset, size_t numBytes);
+
+  // Frees everything.
+  void reset();
+
+  size_t getUsedBytes() const { return usedBytes; }
+
+  // End of the highest range ever allocated since construction or reset().
+  size_t getHighWaterMark() const { return highWaterMark; }
+
+  size_t getNumFreeRanges() const { return freeByOffset.size(); }
+};
+
+#endif // GLOBAL_MEMORY_ALLOCATOR_H
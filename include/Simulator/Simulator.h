@@ -1,5 +1,10 @@
 #include "ISA/Op.h"
 #include "Processor/Processor.h"
+#include "Simulator/GlobalMemoryAllocator.h"
+#include "Simulator/SimulatorProfiler.h"
+#include "Simulator/TensorView.h"
+#include "Utils/MappedFile.h"
+#include <atomic>
 #include <map>
 #include <memory>
 #include <cstring>
@@ -7,6 +12,78 @@
 #ifndef SIMULATOR_H
 #define SIMULATOR_H
 
+// How the simulator's memory is backed by host pages.
+enum class HugePageMode {
+  // Regular pages.
+  NONE,
+  // Regular mapping with transparent huge pages requested via madvise.
+  TRANSPARENT,
+  // MAP_HUGETLB from the explicit huge page pool. The pool must hold the
+  // whole mapping up front; otherwise regular pages are used.
+  EXPLICIT
+};
+
+enum class HandleDirection { UNUSED, INPUT, OUTPUT };
+
+enum class HandleDType { FLOAT32 };
+
+// A global tensor registered with the simulator.
+struct HandleEntry {
+  HandleDirection direction = HandleDirection::UNUSED;
+  HandleDType dtype = HandleDType::FLOAT32;
+  // Offset of the first element in global memory. Unused for external data.
+  size_t offset = 0;
+  // Set for input handles read in place from a caller buffer or mapped file.
+  const uint8_t *externalData = nullptr;
+  std::vector<int> shape;
+  // Elements between consecutive rows.
+  int rowPitch = 0;
+  size_t numBytes = 0;
+};
+
+struct SimulatorMemoryConfig {
+  HugePageMode hugePages = HugePageMode::NONE;
+};
+
+// Host memory reserved for the simulated memories vs. actually touched.
+struct SimulatorMemoryUsage {
+  size_t reservedBytes = 0;
+  size_t residentBytes = 0;
+  size_t residentGlobalBytes = 0;
+  std::vector<size_t> residentLocalBytes; // per core
+};
+
+class Simulator;
+
+// Read-only snapshot of a simulator's global memory and handle table, held in
+// an anonymous in-memory file. Simulators forked from an image map it
+// copy-on-write: they share its pages and only copy the pages they write, so
+// weights loaded once can back many concurrent simulations.
+class SimulatorMemoryImage {
+private:
+  int fd = -1;
+  size_t globalMemorySize = 0;
+  size_t globalRegionSize = 0;
+  GlobalMemoryAllocator globalAllocator;
+  std::vector<HandleEntry> handleTable;
+  std::map<int, std::shared_ptr<const MappedFile>> mappedInputFiles;
+
+  friend class Simulator;
+
+  SimulatorMemoryImage() = default;
+
+public:
+  ~SimulatorMemoryImage();
+
+  SimulatorMemoryImage(const SimulatorMemoryImage &) = delete;
+  SimulatorMemoryImage &operator=(const SimulatorMemoryImage &) = delete;
+
+  size_t getGlobalMemorySize() const { return globalMemorySize; }
+
+  // Bytes of global memory in use when the image was taken.
+  size_t getUsedBytes() const { return globalAllocator.getUsedBytes(); }
+};
+
 class Simulator {
 protected:
   Processor processor;
@@ -14,59 +91,192 @@ protected:
   int localMemoryPerCore;
   int numberOfCores;
 
+  // Global memory and every core's local memory live in one anonymous,
+  // lazily committed mapping. Each region starts on its own page so simulated
+  // cores never share host pages or cache lines.
+  size_t pageSize;
+  size_t globalRegionSize;
+  size_t localRegionStride;
   size_t totalMemorySize;
   uint8_t *memory; // raw byte-addressable memory
 
-  int nextFreeGlobalMemoryOffset = 0;
-  std::map<int, int> inputHandleToMemoryLocMap;
-  std::map<int, std::vector<int>> inputHandleToShapeMap;
-  std::map<int, int> outputHandleToMemoryLocMap;
-  std::map<int, std::vector<int>> outputHandleToShapeMap;
+  GlobalMemoryAllocator globalAllocator;
+
+  // Image this simulator was forked from, if any; reset() returns to it.
+  std::shared_ptr<const SimulatorMemoryImage> baseImage;
+
+  // Registered handles indexed by handle ID. Only registration writes the
+  // table, and registration is rejected while the table is frozen, so
+  // lookups during a simulation are plain array reads from any thread.
+  std::vector<HandleEntry> handleTable;
+  std::atomic<unsigned> handleFreezeCount{0};
+
+  // Owns the mappings of handles registered by registerMappedInputHandle.
+  // Shared with memory images and the simulators forked from them.
+  std::map<int, std::shared_ptr<const MappedFile>> mappedInputFiles;
+
+  SimulatorProfiler profiler;
+
+  // Bumped whenever a handle is (re)registered so derived simulators can
+  // invalidate anything they cached from the handle table.
+  unsigned handleEpoch = 0;
+
+  // Freezes the handle table for the lifetime of the scope.
+  class FrozenHandleScope {
+  private:
+    Simulator &sim;
+
+  public:
+    explicit FrozenHandleScope(Simulator &sim) : sim(sim) {
+      sim.freezeHandles();
+    }
+    ~FrozenHandleScope() { sim.unfreezeHandles(); }
+  };
 
   uint8_t *getGlobalMemoryBaseAddress() const { return memory; }
 
+  // Entry registered under `handleId` with the given direction, or nullptr.
+  const HandleEntry *lookupHandle(int handleId,
+                                  HandleDirection direction) const {
+    if (handleId < 0 || static_cast<size_t>(handleId) >= handleTable.size())
+      return nullptr;
+    const HandleEntry &entry = handleTable[handleId];
+    return entry.direction == direction ? &entry : nullptr;
+  }
+
+  TensorView<float> makeHandleView(int handleId,
+                                   HandleDirection direction) const;
+
+  // Host address of a handle's first element, wherever it lives.
+  uint8_t *getHandleAddress(const HandleEntry &entry) const {
+    return entry.externalData ? const_cast<uint8_t *>(entry.externalData)
+                              : memory + entry.offset;
+  }
+
+  // Checks that `handleId` can be registered with `direction` and creates
+  // its table entry if needed. Throws if the table is frozen, the ID is out
+  // of range or the ID is registered with the other direction.
+  void checkHandleRegistration(int handleId, HandleDirection direction);
+
+  // Replaces the entry of a checked handle with `entry`, releasing whatever
+  // the old one held. Registration builds `entry` first, so a failed
+  // registration leaves the old handle in place.
+  void installHandle(int handleId, const HandleEntry &entry);
+
+  // Allocates global memory for a handle or throws if there is no space.
+  size_t allocateGlobalMemory(size_t numBytes);
+
+  // Frees a handle's global memory and mapping and zeroes the memory so it
+  // is handed out clean again.
+  void releaseHandleStorage(int handleId, HandleEntry &entry);
+
+  // Zeroes [begin, begin + numBytes) of the simulator memory. Whole pages
+  // are dropped rather than written, so only touched pages cost anything.
+  void clearMemory(uint8_t *begin, size_t numBytes, bool isImageBacked);
+
   uint8_t *getLocalMemoryBaseAddress(int coreId) const {
     if (coreId < 0 || coreId >= numberOfCores) {
       return nullptr; // or throw an exception
     }
-    return memory + globalMemorySize + (coreId * localMemoryPerCore);
+    return memory + globalRegionSize + (coreId * localRegionStride);
   }
 
 public:
-  Simulator(const Processor &proc) : processor(proc) {
-    globalMemorySize = proc.getGlobalMemory();
-    numberOfCores = proc.getNumberOfCores();
-    if (numberOfCores > 0) {
-      localMemoryPerCore = proc.getLocalMemoryPerCore();
-    } else {
-      localMemoryPerCore = 0;
-    }
+  Simulator(
+      const Processor &proc,
+      const SimulatorMemoryConfig &memoryConfig = SimulatorMemoryConfig());
 
-    totalMemorySize = globalMemorySize + (localMemoryPerCore * numberOfCores);
+  // Starts from `image` instead of empty memory: global memory maps the
+  // image copy-on-write and every handle of the image is registered. Forks
+  // keep their image alive and use regular pages.
+  Simulator(const Processor &proc,
+            std::shared_ptr<const SimulatorMemoryImage> image);
 
-    memory = new uint8_t[totalMemorySize];
-  }
+  virtual ~Simulator();
 
-  virtual ~Simulator() { delete[] memory; }
+  // Snapshots global memory and the handle table. External input handles
+  // keep pointing at their caller buffers, which must then outlive every
+  // fork too.
+  std::shared_ptr<const SimulatorMemoryImage> createMemoryImage() const;
 
   Simulator(const Simulator &) = delete;
   Simulator &operator=(const Simulator &) = delete;
 
+  // Resident host memory of the simulated memories, i.e. how much of the
+  // reservation was actually touched.
+  SimulatorMemoryUsage getMemoryUsage() const;
+
+  // Host-side profiling of simulations; disabled until enabled here.
+  SimulatorProfiler &getProfiler() { return profiler; }
+
   virtual void simulateInstructions(
       const std::vector<std::unique_ptr<Op>> &instructions) = 0;
 
+  // A handle ID names a single handle, either an input or an output.
+  // Registering an ID again with the same direction replaces its handle;
+  // registering it with the other direction throws until the ID is released
+  // with releaseHandle.
   void registerInputHandle(int handleId, const void *rawData, size_t numBytes,
                            std::vector<int> dims);
 
+  // Registers an input handle that reads the caller's buffer in place instead
+  // of copying it into global memory. The buffer must stay valid and
+  // unmodified until the handle is re-registered or the simulator is
+  // destroyed.
+  void registerExternalInputHandle(int handleId, const void *rawData,
+                                   size_t numBytes, std::vector<int> dims);
+
+  // Maps a float32 tensor file read-only and registers it as an input handle;
+  // pages are read from disk on first access. A `.npy` file (little-endian
+  // float32, C order, 2d) supplies its own shape, which must match `dims` if
+  // both are given. Any other file is taken as raw row-major floats and needs
+  // `dims`.
+  void registerMappedInputHandle(int handleId, const std::string &path,
+                                 std::vector<int> dims = {});
+
   void registerOutputHandle(int handleId, size_t numBytes,
                             std::vector<int> dims);
 
+  // Unregisters a handle and frees its global memory for reuse. Throws if
+  // the handle is unknown or the handle table is frozen.
+  void releaseHandle(int handleId);
+
+  // Returns the simulator to its freshly constructed state: every handle
+  // released and all memory zeroed (or, for a fork, back to its image).
+  // Touched pages are dropped, so the cost follows what the last jobs used,
+  // not the size of the simulated memories.
+  void reset();
+
+  // Global memory currently allocated to handles, including padding.
+  size_t getGlobalMemoryInUse() const { return globalAllocator.getUsedBytes(); }
+
+  // While frozen (by a caller or by a running simulation) the handle table
+  // is immutable and every register*Handle call throws. Freezes nest.
+  void freezeHandles() { handleFreezeCount.fetch_add(1); }
+
+  void unfreezeHandles() { handleFreezeCount.fetch_sub(1); }
+
+  bool areHandlesFrozen() const { return handleFreezeCount.load() > 0; }
+
+  // The retrieve* functions copy into the caller's buffer and throw if the
+  // requested range exceeds the handle or the core's local memory.
   void retrieveLocalMemoryData(int coreNum, int offset, void *outputBufferm,
                                size_t numBytes);
 
   void retrieveInputData(int handleId, void *outputBuffer, size_t numBytes);
 
   void retrieveOutputData(int handleId, void *outputBuffer, size_t numBytes);
+
+  // Zero-copy alternatives to the retrieve* functions, shaped like the
+  // handle; see TensorView for when a view stays valid.
+  TensorView<float> getInputView(int handleId) const;
+
+  TensorView<float> getOutputView(int handleId) const;
+
+  // `rows` x `cols` floats of a core's local memory starting at byte
+  // `offset`, with `rowPitch` elements between rows (`cols` if zero).
+  TensorView<float> getLocalMemoryView(int coreNum, size_t offset, int rows,
+                                       int cols, int rowPitch = 0) const;
 };
 
 #endif // SIMULATOR_H
@@ -0,0 +1,128 @@
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifndef SIMULATOR_PROFILER_H
+#define SIMULATOR_PROFILER_H
+
+// Totals for a set of executed ops. Times are host nanoseconds.
+struct OpProfileStats {
+  uint64_t count = 0;
+  uint64_t bytes = 0; // bytes copied
+  uint64_t flops = 0;
+  uint64_t wallNs = 0;
+  // Time between an op becoming runnable and a thread starting it.
+  uint64_t poolWaitNs = 0;
+};
+
+struct SimulatorProfile {
+  // Indexed by op type; types that never ran are left out of print().
+  std::vector<std::string> opTypeNames;
+  std::vector<OpProfileStats> byOpType;
+  // Indexed by simulated core.
+  std::vector<OpProfileStats> byCore;
+
+  void print(std::ostream &os) const;
+};
+
+// Host-side profiling of a simulation: per op type and per core counters,
+// and optionally a span per executed op for a Chrome trace-event timeline
+// (chrome://tracing, Perfetto).
+//
+// Disabled by default. Simulators check isEnabled() once per op and only
+// then time and record it, so a disabled profiler costs one predictable
+// branch. Configuring with -DSIMULATOR_PROFILING=OFF makes isEnabled() a
+// constant false and removes the hooks altogether.
+class SimulatorProfiler {
+public:
+  static constexpr int MAX_OP_TYPES = 32;
+
+private:
+  struct AtomicStats {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> flops{0};
+    std::atomic<uint64_t> wallNs{0};
+    std::atomic<uint64_t> poolWaitNs{0};
+
+    void add(uint64_t bytes, uint64_t flops, uint64_t wallNs,
+             uint64_t poolWaitNs);
+    OpProfileStats load() const;
+    void clear();
+  };
+
+  struct Span {
+    int opType;
+    int core;
+    int lane;
+    uint32_t hostThread;
+    uint64_t startNs;
+    uint64_t endNs;
+    uint64_t bytes;
+    uint64_t flops;
+    uint64_t poolWaitNs;
+  };
+
+  int numCores;
+  std::atomic<bool> enabled{false};
+  std::atomic<bool> tracing{false};
+  uint64_t epochNs = 0;
+
+  std::unique_ptr<AtomicStats[]> opTypeStats;
+  std::unique_ptr<AtomicStats[]> coreStats;
+  std::vector<std::string> opTypeNames;
+  std::vector<std::string> laneNames;
+
+  mutable std::mutex spanMutex;
+  std::vector<Span> spans;
+
+public:
+  explicit SimulatorProfiler(int numCores);
+
+  SimulatorProfiler(const SimulatorProfiler &) = delete;
+  SimulatorProfiler &operator=(const SimulatorProfiler &) = delete;
+
+  static uint64_t nowNs();
+
+  // Starts collecting counters, and spans too if `recordTrace` is set.
+  void enable(bool recordTrace = false);
+
+  void disable() { enabled.store(false); }
+
+  bool isEnabled() const {
+#ifdef SIMULATOR_DISABLE_PROFILING
+    return false;
+#else
+    return enabled.load(std::memory_order_relaxed);
+#endif
+  }
+
+  // Display names; unnamed op types and lanes get numbered names.
+  void setOpTypeName(int opType, const std::string &name);
+
+  // Lanes split a core's trace row, e.g. into its DMA engine and each of its
+  // matmul units, so concurrent ops on one core do not overlap.
+  void setLaneName(int lane, const std::string &name);
+
+  // Records one executed op. `readyNs` is when the op became runnable, or 0
+  // if it ran as soon as it was ready. Thread-safe.
+  void record(int opType, int core, int lane, uint64_t readyNs,
+              uint64_t startNs, uint64_t endNs, uint64_t bytes,
+              uint64_t flops);
+
+  SimulatorProfile getProfile() const;
+
+  // Clears counters and spans; trace timestamps restart at zero.
+  void reset();
+
+  // Writes the recorded spans as Chrome trace-event JSON, one process row
+  // per simulated core with one thread row per lane. Throws if the file
+  // cannot be written.
+  void writeChromeTrace(const std::string &path) const;
+};
+
+#endif // SIMULATOR_PROFILER_H
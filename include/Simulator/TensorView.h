@@ -0,0 +1,76 @@
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#ifndef TENSOR_VIEW_H
+#define TENSOR_VIEW_H
+
+// Read-only, zero-copy view of a 2d tensor in simulator memory.
+//
+// A view is tied to the simulator state it was taken from: registering or
+// releasing a handle and resetting the simulator all invalidate it, after
+// which every access throws. A view must not outlive its simulator, and
+// reading it while a simulation is writing the tensor is a data race; wait
+// for the simulation (or its future) first.
+template <typename T> class TensorView {
+private:
+  const T *base = nullptr;
+  int rows = 0;
+  int cols = 0;
+  // Elements between consecutive rows.
+  int rowPitch = 0;
+
+  // Simulator state counter and its value when the view was taken.
+  const unsigned *epoch = nullptr;
+  unsigned validEpoch = 0;
+
+  void checkValid() const {
+    if (!isValid())
+      throw std::runtime_error(
+          "Tensor view used after its simulator state changed");
+  }
+
+public:
+  TensorView() = default;
+
+  TensorView(const T *base, int rows, int cols, int rowPitch,
+             const unsigned *epoch)
+      : base(base), rows(rows), cols(cols), rowPitch(rowPitch), epoch(epoch),
+        validEpoch(*epoch) {}
+
+  bool isValid() const { return epoch && *epoch == validEpoch; }
+
+  int getRows() const { return rows; }
+
+  int getCols() const { return cols; }
+
+  int getRowPitch() const { return rowPitch; }
+
+  size_t getNumElements() const { return static_cast<size_t>(rows) * cols; }
+
+  // Rows follow each other without padding, so data() covers the tensor as
+  // one getNumElements() array.
+  bool isContiguous() const { return rowPitch == cols || rows <= 1; }
+
+  const T *data() const {
+    checkValid();
+    return base;
+  }
+
+  const T *row(int r) const {
+    checkValid();
+    if (r < 0 || r >= rows)
+      throw std::runtime_error("Tensor view row " + std::to_string(r) +
+                               " out of range");
+    return base + static_cast<size_t>(r) * rowPitch;
+  }
+
+  const T &operator()(int r, int c) const {
+    if (c < 0 || c >= cols)
+      throw std::runtime_error("Tensor view column " + std::to_string(c) +
+                               " out of range");
+    return row(r)[c];
+  }
+};
+
+#endif // TENSOR_VIEW_H
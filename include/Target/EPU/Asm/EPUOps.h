@@ -1,5 +1,6 @@
 #include "ISA/Op.h"
 #include <iostream>
+#include <vector>
 
 #ifndef ISA_OP_H
 #define ISA_OP_H
@@ -9,19 +10,25 @@ enum OpCode {
   LOCAL_TO_GLOBAL_MEM_COPY,
   MATMUL,
   START_PARALLEL,
-  END_PARALLEL
+  END_PARALLEL,
+  SIGNAL,
+  WAIT,
+  BARRIER,
+  DMA_WAIT
 };
 
 class GlobalToLocalMemCopyOp : public Op {
 private:
   SliceOperand srcSlice;
   SliceOperand dstSlice;
+  // DMA token of the asynchronous form; -1 for a synchronous copy.
+  int dmaToken;
 
 public:
   GlobalToLocalMemCopyOp(ID coreNum, SliceOperand srcSlice,
-                         SliceOperand dstSlice)
+                         SliceOperand dstSlice, int dmaToken = -1)
       : Op(OpCode::GLOBAL_TO_LOCAL_MEM_COPY, coreNum), srcSlice(srcSlice),
-        dstSlice(dstSlice) {}
+        dstSlice(dstSlice), dmaToken(dmaToken) {}
 
   void dump() const override {
     // Implementation of dump for GlobalToLocalMemCopyOp
@@ -33,12 +40,23 @@ public:
     std::cout << "\tLocal Memory " << std::endl;
 
     dstSlice.print("\t  ");
+
+    if (isAsync())
+      std::cout << "\tDMA Token: " << dmaToken << std::endl;
   }
 
   SliceOperand &getSrcSlice() { return srcSlice; }
 
+  const SliceOperand &getSrcSlice() const { return srcSlice; }
+
   SliceOperand &getDstSlice() { return dstSlice; }
 
+  const SliceOperand &getDstSlice() const { return dstSlice; }
+
+  bool isAsync() const { return dmaToken >= 0; }
+
+  int getDMAToken() const { return dmaToken; }
+
   ~GlobalToLocalMemCopyOp() = default;
 };
 
@@ -46,12 +64,14 @@ class LocalToGlobalMemCopyOp : public Op {
 private:
   SliceOperand srcSlice;
   SliceOperand dstSlice;
+  // DMA token of the asynchronous form; -1 for a synchronous copy.
+  int dmaToken;
 
 public:
   LocalToGlobalMemCopyOp(ID coreNum, SliceOperand srcSlice,
-                         SliceOperand dstSlice)
+                         SliceOperand dstSlice, int dmaToken = -1)
       : Op(OpCode::LOCAL_TO_GLOBAL_MEM_COPY, coreNum), srcSlice(srcSlice),
-        dstSlice(dstSlice) {}
+        dstSlice(dstSlice), dmaToken(dmaToken) {}
 
   void dump() const override {
     // Implementation of dump for GlobalToLocalMemCopyOp
@@ -62,12 +82,23 @@ public:
 
     std::cout << "\tDsr Global Memory " << std::endl;
     dstSlice.print("\t  ");
+
+    if (isAsync())
+      std::cout << "\tDMA Token: " << dmaToken << std::endl;
   }
 
   SliceOperand &getSrcSlice() { return srcSlice; }
 
+  const SliceOperand &getSrcSlice() const { return srcSlice; }
+
   SliceOperand &getDstSlice() { return dstSlice; }
 
+  const SliceOperand &getDstSlice() const { return dstSlice; }
+
+  bool isAsync() const { return dmaToken >= 0; }
+
+  int getDMAToken() const { return dmaToken; }
+
   ~LocalToGlobalMemCopyOp() = default;
 };
 
@@ -106,10 +137,16 @@ public:
 
   SliceOperand &getSliceA() { return sliceA; }
 
+  const SliceOperand &getSliceA() const { return sliceA; }
+
   SliceOperand &getSliceB() { return sliceB; }
 
+  const SliceOperand &getSliceB() const { return sliceB; }
+
   SliceOperand &getSliceC() { return sliceC; }
 
+  const SliceOperand &getSliceC() const { return sliceC; }
+
   bool getAccumulate() const { return accumulate.asBool(); }
 
   ~MatmulOp() = default;
@@ -133,4 +170,86 @@ public:
   ~EndParallelOp() = default;
 };
 
+class SignalOp : public Op {
+private:
+  int semaphore;
+
+public:
+  SignalOp(ID coreNum, int semaphore)
+      : Op(OpCode::SIGNAL, coreNum), semaphore(semaphore) {}
+
+  void dump() const override {
+    std::cout << "\nSignalOp" << std::endl;
+    std::cout << "\tCore ID: " << getCoreNum() << std::endl;
+    std::cout << "\tSemaphore: " << semaphore << std::endl;
+  }
+
+  int getSemaphore() const { return semaphore; }
+
+  ~SignalOp() = default;
+};
+
+class WaitOp : public Op {
+private:
+  int semaphore;
+
+public:
+  WaitOp(ID coreNum, int semaphore)
+      : Op(OpCode::WAIT, coreNum), semaphore(semaphore) {}
+
+  void dump() const override {
+    std::cout << "\nWaitOp" << std::endl;
+    std::cout << "\tCore ID: " << getCoreNum() << std::endl;
+    std::cout << "\tSemaphore: " << semaphore << std::endl;
+  }
+
+  int getSemaphore() const { return semaphore; }
+
+  ~WaitOp() = default;
+};
+
+// Joins a subset of the cores. The op is attributed to the first core.
+class BarrierOp : public Op {
+private:
+  std::vector<ID> cores;
+
+public:
+  BarrierOp(std::vector<ID> cores)
+      : Op(OpCode::BARRIER, cores.empty() ? 0 : cores.front()),
+        cores(std::move(cores)) {}
+
+  void dump() const override {
+    std::cout << "\nBarrierOp" << std::endl;
+    std::cout << "\tCores:";
+    for (ID core : cores)
+      std::cout << " " << core;
+    std::cout << std::endl;
+  }
+
+  const std::vector<ID> &getCores() const { return cores; }
+
+  ~BarrierOp() = default;
+};
+
+// Waits until the asynchronous copies of a core issued with a DMA token have
+// completed.
+class DMAWaitOp : public Op {
+private:
+  int dmaToken;
+
+public:
+  DMAWaitOp(ID coreNum, int dmaToken)
+      : Op(OpCode::DMA_WAIT, coreNum), dmaToken(dmaToken) {}
+
+  void dump() const override {
+    std::cout << "\nDMAWaitOp" << std::endl;
+    std::cout << "\tCore ID: " << getCoreNum() << std::endl;
+    std::cout << "\tDMA Token: " << dmaToken << std::endl;
+  }
+
+  int getDMAToken() const { return dmaToken; }
+
+  ~DMAWaitOp() = default;
+};
+
 #endif // ISA_OP_H
@@ -0,0 +1,128 @@
+#include "Target/EPU/Asm/EPUOps.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#ifndef EPU_PROGRAM_H
+#define EPU_PROGRAM_H
+
+// Compact, contiguous storage for an EPU program.
+//
+// Every op is a 12-byte record in one array, indexed in program order;
+// appending never moves an index. Slice operands live in a second array,
+// with their dims interned in a table shared by the whole program (real
+// programs use a handful of distinct start:end:stride triples), and barrier
+// cores in a third. An op therefore costs 36 to 48 bytes with no allocation
+// of its own, against one heap object with a vtable per op for
+// std::vector<std::unique_ptr<Op>>, and walking the program touches
+// consecutive memory.
+//
+// Core numbers must fit in 16 bits; appending an op with a larger one
+// throws std::runtime_error.
+class EPUProgram {
+public:
+  enum Flags : uint8_t { ACCUMULATE = 1 };
+
+  static constexpr ID MIN_CORE = INT16_MIN;
+  static constexpr ID MAX_CORE = INT16_MAX;
+
+  struct Instr {
+    uint8_t opCode;
+    uint8_t flags;
+    int16_t core;
+    // Matmul unit, semaphore, number of barrier cores, or the DMA token of
+    // copies (-1 if synchronous) and dma_wait.
+    int32_t imm;
+    // First slice of copies and matmuls, first core of barriers.
+    uint32_t operands;
+  };
+
+private:
+  struct PackedSlice {
+    int32_t baseAddress;
+    // Indices into `dims`.
+    uint32_t dim1;
+    uint32_t dim0;
+  };
+
+  struct DimHash {
+    size_t operator()(const Dim &dim) const;
+  };
+
+  std::vector<Instr> instrs;
+  std::vector<PackedSlice> slices;
+  std::vector<ID> barrierCores;
+  std::vector<Dim> dims;
+  std::unordered_map<Dim, uint32_t, DimHash> dimIndex;
+
+  Instr &appendInstr(int opCode, ID core, int32_t imm, uint32_t operands);
+
+  uint32_t internDim(const Dim &dim);
+
+  void appendSlice(const SliceOperand &slice);
+
+public:
+  size_t size() const { return instrs.size(); }
+
+  bool empty() const { return instrs.empty(); }
+
+  // Bytes held by the program's arrays.
+  size_t getNumBytes() const;
+
+  void reserve(size_t numOps);
+
+  // -----------------------------
+  // Building
+  // -----------------------------
+  // `opCode` is GLOBAL_TO_LOCAL_MEM_COPY or LOCAL_TO_GLOBAL_MEM_COPY.
+  void appendCopy(int opCode, ID core, const SliceOperand &src,
+                  const SliceOperand &dst, int dmaToken = -1);
+
+  void appendMatmul(ID core, ID mmUnit, const SliceOperand &sliceA,
+                    const SliceOperand &sliceB, const SliceOperand &sliceC,
+                    bool accumulate);
+
+  // START_PARALLEL or END_PARALLEL.
+  void appendMarker(int opCode);
+
+  // SIGNAL or WAIT.
+  void appendSync(int opCode, ID core, int semaphore);
+
+  void appendBarrier(const std::vector<ID> &cores);
+
+  void appendDMAWait(ID core, int dmaToken);
+
+  void append(const Op &op);
+
+  // Appends the ops of `other`, re-interning its dims.
+  void append(const EPUProgram &other);
+
+  static EPUProgram fromOps(const std::vector<std::unique_ptr<Op>> &ops);
+
+  // -----------------------------
+  // Access
+  // -----------------------------
+  const Instr &getInstr(size_t i) const { return instrs[i]; }
+
+  int getOpCode(size_t i) const { return instrs[i].opCode; }
+
+  ID getCoreNum(size_t i) const { return instrs[i].core; }
+
+  // Slice `k` of a copy (0 src, 1 dst) or matmul (0 A, 1 B, 2 C).
+  SliceOperand getSlice(size_t i, int k) const;
+
+  std::vector<ID> getBarrierCores(size_t i) const;
+
+  // The op at `i` as a standalone Op.
+  std::unique_ptr<Op> getOp(size_t i) const;
+
+  std::vector<std::unique_ptr<Op>> toOps() const;
+
+  void dump(size_t i) const { getOp(i)->dump(); }
+
+  void dump() const;
+};
+
+#endif // EPU_PROGRAM_H
@@ -1,35 +1,68 @@
 #include "Parser/Parser.h"
 #include "Target/EPU/Asm/EPUOps.h"
+#include "Target/EPU/Asm/EPUProgram.h"
+#include "Target/EPU/Simulator/EPUThreadPool.h"
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
 
 #ifndef EPU_ASM_PARSER_H
 #define EPU_ASM_PARSER_H
 
 using namespace std;
 
+// Parser for EPU assembly, one instruction per line (see EPU.md).
+//
+// Each line is lexed in a single pass over a string_view: numbers are read
+// with std::from_chars and mnemonics are compared in place, so nothing is
+// allocated per token. Large inputs are cut into chunks of whole lines that
+// are parsed on several threads and stitched back in order; the nesting of
+// parallel regions is checked once all chunks are done.
+// Malformed input throws std::runtime_error with a
+// "<source>:<line>:<column>: <message>" description.
 class EPUAsmParser : public Parser {
-  int parseInt(const string &s);
+private:
+  unsigned numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  // Created by the first input large enough to be chunked.
+  std::unique_ptr<EPUThreadPool> pool;
 
-  Dim parseDim(const string &text);
-
-  SliceOperand parseSlice(const string &text);
+public:
+  EPUAsmParser(const Processor &proc) : Parser(proc) {}
 
-  MatmulOp parseMatmul(const std::string &line);
+  // Threads parsing one input, including the calling thread.
+  void setNumThreads(unsigned threads);
 
-  LocalToGlobalMemCopyOp parseLocalToGlobalMemCopy(const std::string &line);
+  unsigned getNumThreads() const { return numThreads; }
 
-  GlobalToLocalMemCopyOp parseGlobalToLocalMemCopy(const std::string &line);
+  ~EPUAsmParser() = default;
 
-  StartParallelOp parseStartParallel(const std::string &line);
+  // Reads a whole file through an mmap. Files in the binary program format
+  // (see EPUBinaryFormat.h) are decoded instead of lexed.
+  std::vector<std::unique_ptr<Op>>
+  parseFile(const std::string &filename) override;
 
-  EndParallelOp parseEndParallel(const std::string &line);
+  // Parses assembly held in memory; `sourceName` prefixes error messages.
+  std::vector<std::unique_ptr<Op>>
+  parseBuffer(std::string_view text,
+              const std::string &sourceName = "<buffer>");
 
-public:
-  EPUAsmParser(const Processor &proc) : Parser(proc) {}
+  // Parses `text` on the calling thread and hands every op to `consume` as
+  // soon as its line is parsed, so no more than one op is held at a time.
+  // Errors are reported like parseBuffer's; ops before the error have
+  // already been consumed.
+  void parseStream(std::string_view text, const std::string &sourceName,
+                   const std::function<void(std::unique_ptr<Op>)> &consume);
 
-  ~EPUAsmParser() = default;
+  // Like parseBuffer, but appends every op straight into an EPUProgram
+  // instead of allocating it. Cores must fit in 16 bits.
+  EPUProgram parseProgram(std::string_view text,
+                          const std::string &sourceName = "<buffer>");
 
-  std::vector<std::unique_ptr<Op>>
-  parseFile(const std::string &filename) override;
+  // Reads a file into an EPUProgram, decoding the binary program format like
+  // parseFile. Throws std::runtime_error if the file cannot be read.
+  EPUProgram parseProgramFile(const std::string &filename);
 };
 
-#endif // EPU_ASM_PARSER_H
\ No newline at end of file
+#endif // EPU_ASM_PARSER_H
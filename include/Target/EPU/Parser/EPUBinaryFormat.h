@@ -0,0 +1,81 @@
+#include "Target/EPU/Asm/EPUOps.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifndef EPU_BINARY_FORMAT_H
+#define EPU_BINARY_FORMAT_H
+
+// Binary encoding of an EPU program (see EPU.md).
+//
+// A file is an EPUBinaryHeader followed by numRecords fixed-width
+// EPUBinaryRecords, one per op, in host byte order. Loading a program only
+// copies the fields of each record into its op, so large programs are loaded
+// at memory bandwidth from an mmap of the file instead of being lexed.
+
+constexpr char EPU_BINARY_MAGIC[8] = {'E', 'P', 'U', 'B', 'I', 'N', '\0', '\0'};
+constexpr uint32_t EPU_BINARY_VERSION = 1;
+
+struct EPUBinaryHeader {
+  char magic[8];
+  uint32_t version;
+  // sizeof(EPUBinaryRecord) of the writer.
+  uint32_t recordSize;
+  uint64_t numRecords;
+};
+
+struct EPUBinaryRecord {
+  enum Flags : uint16_t { ACCUMULATE = 1 };
+
+  // Slices are stored as base, dim1 start:end:stride, dim0 start:end:stride.
+  static constexpr int SLICE_WORDS = 7;
+  static constexpr int OPERAND_WORDS = 3 * SLICE_WORDS;
+
+  uint16_t opCode;
+  uint16_t flags;
+  int32_t core;
+  // Matmul unit, semaphore, or number of barrier cores.
+  int32_t imm;
+  // DMA token of copies and dma_wait; -1 for a synchronous copy.
+  int32_t dmaToken;
+  // Copy src and dst slices, matmul A, B and C slices, or barrier cores.
+  int32_t operands[OPERAND_WORDS];
+};
+
+static_assert(sizeof(EPUBinaryHeader) == 24, "unexpected header padding");
+static_assert(sizeof(EPUBinaryRecord) == 100, "unexpected record padding");
+
+// Whether `data` starts with the binary program magic.
+bool isEPUBinary(const uint8_t *data, size_t size);
+
+// Decodes a binary program held in memory. Malformed input throws
+// std::runtime_error prefixed with `sourceName`.
+std::vector<std::unique_ptr<Op>>
+loadEPUBinary(const uint8_t *data, size_t size,
+              const std::string &sourceName = "<buffer>");
+
+// Decodes a binary program one record at a time, handing every op to
+// `consume` as soon as it is decoded.
+void streamEPUBinary(const uint8_t *data, size_t size,
+                     const std::string &sourceName,
+                     const std::function<void(std::unique_ptr<Op>)> &consume);
+
+// Maps `filename` and decodes it with loadEPUBinary.
+std::vector<std::unique_ptr<Op>> loadEPUBinaryFile(const std::string &filename);
+
+// Encodes `ops`. Throws std::runtime_error for ops that have no encoding.
+void writeEPUBinary(const std::vector<std::unique_ptr<Op>> &ops,
+                    std::ostream &os);
+
+void writeEPUBinaryFile(const std::vector<std::unique_ptr<Op>> &ops,
+                        const std::string &filename);
+
+// Prints `ops` as assembly that EPUAsmParser reads back, one op per line.
+void writeEPUAsm(const std::vector<std::unique_ptr<Op>> &ops,
+                 std::ostream &os);
+
+#endif // EPU_BINARY_FORMAT_H
@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef EPU_BATCH_H
+#define EPU_BATCH_H
+
+// Caller buffer bound to a handle for one batch member.
+struct EPUBatchInput {
+  int handleId;
+  const void *data;
+  size_t numBytes;
+};
+
+struct EPUBatchOutput {
+  int handleId;
+  void *data;
+  size_t numBytes;
+};
+
+// Per-member handle bindings of a batched run. Input handles a member does
+// not bind are shared by the whole batch (weights, constants) and read from
+// wherever they were registered. Every output handle the program stores to
+// must be bound, and only the elements the program stores are written.
+struct EPUBatchBinding {
+  std::vector<EPUBatchInput> inputs;
+  std::vector<EPUBatchOutput> outputs;
+};
+
+struct EPUBatchReport {
+  size_t numMembers = 0;
+  // Local memory views the simulator holds after the batch: the most
+  // members it has ever run at once.
+  unsigned numViews = 0;
+  uint64_t wallNs = 0;
+  double membersPerSecond = 0.0;
+  std::vector<uint64_t> memberWallNs;
+};
+
+// Private copy of every core's local memory for one running batch member.
+// Lazily committed and zeroed again (cheaply, by dropping its pages) after
+// each use, so members never observe each other's data.
+class EPULocalMemoryView {
+private:
+  uint8_t *base = nullptr;
+  size_t size = 0;
+
+public:
+  explicit EPULocalMemoryView(size_t size);
+
+  ~EPULocalMemoryView();
+
+  EPULocalMemoryView(const EPULocalMemoryView &) = delete;
+  EPULocalMemoryView &operator=(const EPULocalMemoryView &) = delete;
+
+  uint8_t *getBase() const { return base; }
+
+  size_t getSize() const { return size; }
+
+  void clear();
+};
+
+#endif // EPU_BATCH_H
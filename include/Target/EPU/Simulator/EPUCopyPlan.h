@@ -0,0 +1,49 @@
+#include "ISA/Op.h"
+#include <cstddef>
+
+#ifndef EPU_COPY_PLAN_H
+#define EPU_COPY_PLAN_H
+
+// Precomputed description of a 2D slice copy between two float tensors.
+//
+// Building a plan resolves the slice starts, row pitches and strides once and
+// classifies the copy so execution does no per-element index math:
+//  - BULK:    source and destination are both fully contiguous, one memcpy.
+//  - ROWS:    each row is contiguous on both sides, one memcpy per row.
+//  - STRIDED: real element strides, vectorized gather/scatter.
+struct CopyPlan {
+  enum Kind { INVALID, EMPTY, BULK, ROWS, STRIDED };
+
+  Kind kind = INVALID;
+  const float *src = nullptr;
+  float *dst = nullptr;
+  int rows = 0;
+  int cols = 0;
+
+  // All in elements.
+  ptrdiff_t srcRowPitch = 0;
+  ptrdiff_t srcColStride = 0;
+  ptrdiff_t dstRowPitch = 0;
+  ptrdiff_t dstColStride = 0;
+
+  size_t getNumBytes() const {
+    return static_cast<size_t>(rows) * cols * sizeof(float);
+  }
+};
+
+// srcFullCols/dstFullCols are the row widths (in elements) of the underlying
+// tensors the slices index into. Returns an INVALID plan if the slice shapes
+// do not match.
+CopyPlan makeCopyPlan(const float *srcBase, int srcFullCols,
+                      const SliceOperand &src, float *dstBase,
+                      int dstFullCols, const SliceOperand &dst);
+
+void runCopyPlan(const CopyPlan &plan);
+
+// Part `part` of `plan` cut into `numParts` near-equal pieces that can run
+// concurrently. Rows are divided when there are enough of them, otherwise
+// the columns of every row. Pieces keep the plan's kind, except that column
+// pieces of a multi-row BULK plan are copied row by row.
+CopyPlan splitCopyPlan(const CopyPlan &plan, int part, int numParts);
+
+#endif // EPU_COPY_PLAN_H
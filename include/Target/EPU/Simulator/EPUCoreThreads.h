@@ -0,0 +1,50 @@
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef EPU_CORE_THREADS_H
+#define EPU_CORE_THREADS_H
+
+// One long-lived host thread per simulated core. run() hands every thread
+// its core index and returns once all of them are done, so a core's work
+// always lands on the same host thread and, when pinned, the same host CPU,
+// keeping that core's local memory in one cache.
+class EPUCoreThreads {
+private:
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  std::condition_variable startWork;
+  std::condition_variable workDone;
+  std::function<void(unsigned)> work;
+  // Bumped for every run(); threads run the work once per generation.
+  unsigned generation = 0;
+  unsigned running = 0;
+  bool stopping = false;
+  std::exception_ptr error;
+
+  void threadLoop(unsigned index);
+
+  static void pinToHostCPU(std::thread &thread, unsigned index);
+
+public:
+  // With `pin`, thread i is bound to the i-th CPU the process may run on
+  // (wrapping around when there are more threads than CPUs).
+  EPUCoreThreads(unsigned numThreads, bool pin);
+
+  ~EPUCoreThreads();
+
+  EPUCoreThreads(const EPUCoreThreads &) = delete;
+  EPUCoreThreads &operator=(const EPUCoreThreads &) = delete;
+
+  unsigned getNumThreads() const { return threads.size(); }
+
+  // Runs `fn(i)` on thread i for every thread and waits for all of them.
+  // Rethrows the first exception thrown by any thread.
+  void run(const std::function<void(unsigned)> &fn);
+};
+
+#endif // EPU_CORE_THREADS_H
@@ -0,0 +1,110 @@
+#include "Target/EPU/Asm/EPUOps.h"
+#include "Target/EPU/Simulator/EPUCopyPlan.h"
+#include <cstdint>
+#include <vector>
+
+#ifndef EPU_DECODED_PROGRAM_H
+#define EPU_DECODED_PROGRAM_H
+
+// Operands of a decoded matmul. Strides are in elements, so element (m, k) of
+// A lives at A[m * aRowStride + k * aColStride]; same for B and C.
+struct DecodedMatmul {
+  const float *A;
+  const float *B;
+  float *C;
+  int32_t aRowStride;
+  int32_t aColStride;
+  int32_t bRowStride;
+  int32_t bColStride;
+  int32_t cRowStride;
+  int32_t cColStride;
+  int32_t M;
+  int32_t N;
+  int32_t K;
+};
+
+// Operands of a decoded signal, wait or barrier.
+struct DecodedSync {
+  int32_t semaphore;
+  // Barrier: bit c is set for every participating core c.
+  uint32_t coreMask;
+  // Wait: program index of the signal it consumes.
+  int32_t signalOp;
+};
+
+// Fixed-size, self-contained record for one op. Decoding resolves handles,
+// local memory bases, row pitches and element counts against the simulator
+// state once, so executing a record needs no RTTI, map lookups or
+// SliceOperand copies.
+struct DecodedOp {
+  enum Flags : uint8_t {
+    ACCUMULATE = 1 << 0,
+    // Unit-stride, non-overlapping 32x32x32 matmul for the SIMD fast path.
+    TILE32 = 1 << 1,
+    // Copy issued to the core's DMA engine; completes at a dma_wait.
+    ASYNC = 1 << 2,
+    // Matmul whose C overlaps A or B, so it must run whole and in order.
+    ALIASED = 1 << 3,
+  };
+
+  // Problems found while decoding. They are reported (and the op skipped)
+  // when the record executes, matching where the interpreter used to
+  // report them.
+  enum Error : uint8_t {
+    NONE,
+    UNKNOWN_INPUT_HANDLE,
+    UNKNOWN_OUTPUT_HANDLE,
+    GLOBAL_TO_LOCAL_SHAPE_MISMATCH,
+    LOCAL_TO_GLOBAL_SHAPE_MISMATCH,
+    MATMUL_DIM_MISMATCH,
+    MATMUL_OUTPUT_SHAPE_MISMATCH,
+    INVALID_SYNC_OPERAND,
+    INVALID_DMA_OPERAND,
+    INVALID_MATMUL_UNIT,
+    INVALID_CORE,
+  };
+
+  uint8_t opCode = 0; // OpCode of the source op
+  uint8_t flags = 0;
+  uint8_t error = NONE;
+  uint8_t mmUnit = 0;
+  int32_t core = 0;
+  int32_t handleId = -1; // global handle of copies
+  int32_t dmaToken = -1;  // async copies and dma_wait
+
+  union {
+    CopyPlan copy;
+    DecodedMatmul matmul;
+    DecodedSync sync;
+  };
+
+  DecodedOp() : copy() {}
+
+  bool hasFlag(Flags flag) const { return (flags & flag) != 0; }
+
+  // Ops that only order other ops.
+  bool isSync() const {
+    return opCode == OpCode::SIGNAL || opCode == OpCode::WAIT ||
+           opCode == OpCode::BARRIER || opCode == OpCode::DMA_WAIT;
+  }
+};
+
+// A program lowered for one simulator instance. Records hold host pointers
+// into that simulator's memory, so a decoded program is only valid for the
+// simulator that produced it and until its handles are re-registered.
+struct EPUDecodedProgram {
+  // Runs of consecutive matmuls outside parallel regions, ops[begin, end),
+  // that in-order execution issues to their units' queues at once: they use
+  // at least two units and no two units' ops touch overlapping memory.
+  struct MatmulGroup {
+    uint32_t begin;
+    uint32_t end;
+  };
+
+  std::vector<DecodedOp> ops;
+  std::vector<MatmulGroup> matmulGroups;
+  const void *owner = nullptr;
+  unsigned handleEpoch = 0;
+};
+
+#endif // EPU_DECODED_PROGRAM_H
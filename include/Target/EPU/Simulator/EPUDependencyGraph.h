@@ -0,0 +1,93 @@
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#ifndef EPU_DEPENDENCY_GRAPH_H
+#define EPU_DEPENDENCY_GRAPH_H
+
+// Byte range [begin, end) inside one memory space. A space is either the
+// local memory of one core or one global memory handle.
+struct MemoryRange {
+  enum SpaceKind : uint32_t { LOCAL = 0, GLOBAL = 1 };
+
+  SpaceKind kind;
+  int spaceId; // core id for LOCAL, handle id for GLOBAL
+  uint64_t begin;
+  uint64_t end;
+
+  int64_t getSpaceKey() const {
+    return (static_cast<int64_t>(kind) << 32) |
+           static_cast<uint32_t>(spaceId);
+  }
+
+  bool overlaps(const MemoryRange &other) const {
+    return begin < other.end && other.begin < end;
+  }
+
+  bool covers(const MemoryRange &other) const {
+    return begin <= other.begin && other.end <= end;
+  }
+};
+
+// Memory an op reads and writes. Ops whose footprint cannot be determined are
+// marked as barriers and are ordered against everything.
+struct OpFootprint {
+  std::vector<MemoryRange> reads;
+  std::vector<MemoryRange> writes;
+  bool isBarrier = false;
+};
+
+// Dependency DAG built incrementally in program order. An op depends on every
+// earlier op it has a RAW, WAR or WAW hazard with, so any topological order
+// of the graph produces the same memory state as executing the program
+// serially.
+class EPUDependencyGraph {
+private:
+  struct Node {
+    std::vector<uint32_t> successors;
+    uint32_t numPredecessors = 0;
+  };
+
+  struct Access {
+    MemoryRange range;
+    uint32_t op;
+    bool isWrite;
+  };
+
+  std::vector<Node> nodes;
+  size_t numEdges = 0;
+
+  // Live accesses per memory space. Accesses fully covered by a later write
+  // are dropped since anything conflicting with them also conflicts with
+  // (and therefore waits for) that write.
+  std::unordered_map<int64_t, std::vector<Access>> liveAccesses;
+
+  // Ops added since the last barrier, and the barrier itself.
+  std::vector<uint32_t> opsSinceBarrier;
+  int64_t lastBarrier = -1;
+
+  void addEdge(uint32_t from, uint32_t to);
+
+public:
+  // Appends the next op in program order and returns its index.
+  uint32_t addOp(const OpFootprint &footprint);
+
+  // Orders the most recently added op `to` after `from` on top of its
+  // memory hazards, for synchronization the footprints cannot express.
+  void addDependency(uint32_t from, uint32_t to);
+
+  size_t size() const { return nodes.size(); }
+
+  size_t getNumEdges() const { return numEdges; }
+
+  const std::vector<uint32_t> &getSuccessors(uint32_t op) const {
+    return nodes[op].successors;
+  }
+
+  uint32_t getNumPredecessors(uint32_t op) const {
+    return nodes[op].numPredecessors;
+  }
+};
+
+#endif // EPU_DEPENDENCY_GRAPH_H
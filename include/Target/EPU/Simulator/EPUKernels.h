@@ -0,0 +1,43 @@
+#include <cstddef>
+
+#ifndef EPU_KERNELS_H
+#define EPU_KERNELS_H
+
+// Host vector instruction sets the simulator kernels can be dispatched to.
+// Ordered from least to most capable so levels can be compared.
+enum class HostVectorISA { SCALAR = 0, AVX2 = 1, AVX512 = 2 };
+
+// Tile edge of the EPU matmul unit (see EPU.md, section 3).
+constexpr int EPU_MM_TILE = 32;
+
+// Best ISA supported by the host CPU, optionally capped through the
+// EPU_HOST_ISA environment variable (scalar | avx2 | avx512). The result is
+// computed once and cached.
+HostVectorISA getHostVectorISA();
+
+const char *getHostVectorISAName(HostVectorISA isa);
+
+// C[32x32] = A[32x32] * B[32x32], or C += A * B when accumulate is set.
+//
+// All tiles are unit-stride in both dims; lda/ldb/ldc are row pitches in
+// elements. Every output element is reduced over k in ascending order with a
+// separate multiply and add (no FMA), which is exactly what the generic
+// strided loop in EPUSimulator::executeMatmul does, so all variants are
+// bit-for-bit identical to it.
+void matmulTile32(const float *A, int lda, const float *B, int ldb, float *C,
+                  int ldc, bool accumulate);
+
+// Same as above but forces a specific ISA. Requesting an ISA the host does not
+// support falls back to the best supported one below it.
+void matmulTile32(HostVectorISA isa, const float *A, int lda, const float *B,
+                  int ldb, float *C, int ldc, bool accumulate);
+
+// dst[r * dstRowPitch + c * dstColStride] =
+//     src[r * srcRowPitch + c * srcColStride]
+// for r < rows, c < cols. Pitches and strides are in elements. Uses hardware
+// gather (and scatter on AVX-512) when available.
+void stridedCopy2D(const float *src, ptrdiff_t srcRowPitch,
+                   ptrdiff_t srcColStride, float *dst, ptrdiff_t dstRowPitch,
+                   ptrdiff_t dstColStride, int rows, int cols);
+
+#endif // EPU_KERNELS_H
@@ -0,0 +1,118 @@
+#include "Target/EPU/Simulator/EPUBatch.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef EPU_PIPELINE_H
+#define EPU_PIPELINE_H
+
+class EPUSimulator;
+struct EPUDecodedProgram;
+
+// One run of the pipeline's program. Inputs are copied when the job is
+// submitted, so their buffers may be reused as soon as submit() returns.
+// Output buffers are written in full once the job has run, before its future
+// becomes ready; elements the program does not store are unspecified.
+struct EPUPipelineJob {
+  std::vector<EPUBatchInput> inputs;
+  std::vector<EPUBatchOutput> outputs;
+};
+
+// Time is in nanoseconds, summed over all jobs.
+struct EPUPipelineStats {
+  uint64_t jobsCompleted = 0;
+  // Copying inputs into staging buffers (on the submitting thread).
+  uint64_t stageNs = 0;
+  uint64_t simulateNs = 0;
+  // Copying outputs out of staging buffers.
+  uint64_t drainNs = 0;
+  // Time submit() blocked waiting for a free staging slot.
+  uint64_t submitWaitNs = 0;
+};
+
+// Three-stage host pipeline around one decoded program: while job N
+// simulates, the caller stages inputs for job N+1 and a drain thread copies
+// out the outputs of job N-1. Jobs run in submission order, each against
+// its own staging slot through simulateBatch(), so the simulator's global
+// memory is never written. The handle table stays frozen while the pipeline
+// exists.
+class EPUPipeline {
+private:
+  struct Slot {
+    std::vector<std::vector<uint8_t>> inputBuffers;
+    std::vector<std::vector<uint8_t>> outputBuffers;
+    EPUBatchBinding binding;
+    std::vector<EPUBatchOutput> destinations;
+    std::promise<void> done;
+    std::exception_ptr error;
+  };
+
+  // Blocking FIFO of slots handed between stages; a null slot tells the
+  // receiving stage to shut down.
+  class SlotQueue {
+  private:
+    std::mutex mutex;
+    std::condition_variable nonEmpty;
+    std::deque<Slot *> slots;
+
+  public:
+    void push(Slot *slot);
+
+    Slot *pop();
+  };
+
+  EPUSimulator &simulator;
+  const EPUDecodedProgram &program;
+
+  std::vector<std::unique_ptr<Slot>> slots;
+  SlotQueue freeSlots;
+  SlotQueue simulateQueue;
+  SlotQueue drainQueue;
+
+  std::mutex idleMutex;
+  std::condition_variable idle;
+  size_t jobsInFlight = 0;
+
+  std::atomic<uint64_t> jobsCompleted{0};
+  std::atomic<uint64_t> stageNs{0};
+  std::atomic<uint64_t> simulateNs{0};
+  std::atomic<uint64_t> drainNs{0};
+  std::atomic<uint64_t> submitWaitNs{0};
+
+  std::thread simulateThread;
+  std::thread drainThread;
+
+  void simulateLoop();
+
+  void drainLoop();
+
+public:
+  // `depth` staging slots bound how many jobs can be in flight; three keep
+  // every stage busy. `program` must outlive the pipeline.
+  EPUPipeline(EPUSimulator &simulator, const EPUDecodedProgram &program,
+              unsigned depth = 3);
+
+  // Finishes every submitted job.
+  ~EPUPipeline();
+
+  EPUPipeline(const EPUPipeline &) = delete;
+  EPUPipeline &operator=(const EPUPipeline &) = delete;
+
+  // Stages the job's inputs and queues it, blocking while every slot is in
+  // use. The future rethrows the job's simulation error, if any.
+  std::future<void> submit(const EPUPipelineJob &job);
+
+  // Blocks until every submitted job has completed.
+  void waitIdle();
+
+  EPUPipelineStats getStats() const;
+};
+
+#endif // EPU_PIPELINE_H
@@ -1,29 +1,415 @@
 #include "Simulator/Simulator.h"
 #include "Target/EPU/Asm/EPUOps.h"
+#include "Target/EPU/Asm/EPUProgram.h"
+#include "Target/EPU/Simulator/EPUBatch.h"
+#include "Target/EPU/Simulator/EPUCopyPlan.h"
+#include "Target/EPU/Simulator/EPUCoreThreads.h"
+#include "Target/EPU/Simulator/EPUDecodedProgram.h"
+#include "Target/EPU/Simulator/EPUDependencyGraph.h"
+#include "Target/EPU/Simulator/EPUThreadPool.h"
+#include "Target/EPU/Simulator/EPUTimingModel.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
 
 #ifndef EPUSIMULATOR_H
 #define EPUSIMULATOR_H
 
+enum class EPUExecutionMode {
+  // Program order; only start_parallel/end_parallel regions run
+  // concurrently.
+  IN_ORDER,
+  // Ops are scheduled from a dependency DAG built from their slice
+  // read/write footprints; parallel markers are not needed (and ignored).
+  DATAFLOW,
+  // Every simulated core runs its own ops in program order on a dedicated
+  // host thread, and its async copies on a second one. Cores only wait for
+  // each other at end_parallel joins, sync ops and where an op depends on
+  // another core's op through memory.
+  PER_CORE
+};
+
+// What the core threads of the last PER_CORE simulation did, per core
+// (including its DMA thread).
+struct EPUCoreStreamStats {
+  std::vector<uint64_t> opsExecuted;
+  // Ordering points on other cores' progress the stream passed.
+  std::vector<uint64_t> crossCoreWaits;
+  // Waits that found the other core behind and had to stall.
+  std::vector<uint64_t> stalls;
+  std::vector<uint64_t> stallNs;
+};
+
+// What the last streaming simulation did.
+struct EPUStreamStats {
+  uint64_t opsStreamed = 0;
+  // Most ops the executor held at once: a whole parallel region, or a run
+  // of matmuls being grouped.
+  size_t maxBufferedOps = 0;
+  // Times the parser found the queue full, and the executor found it empty.
+  uint64_t parserStalls = 0;
+  uint64_t executorStalls = 0;
+};
+
+// Upper bound of the default worker count.
+constexpr unsigned DEFAULT_WORKER_THREADS = 4;
+
+// Construction-time knobs of the EPU simulator. The defaults keep a
+// simulator cheap to create and leave the host alone: a few workers, no DMA
+// threads, no pinning. Callers that own the machine opt in to more.
+struct EPUSimulatorOptions {
+  // Worker threads executing start_parallel/end_parallel regions. With zero
+  // workers regions run on the simulating thread.
+  unsigned numWorkerThreads =
+      std::min(DEFAULT_WORKER_THREADS, std::thread::hardware_concurrency());
+
+  EPUExecutionMode executionMode = EPUExecutionMode::IN_ORDER;
+
+  // Predict the cycle count of every simulated program with the timing
+  // model; see getTimingReport().
+  bool enableTimingModel = false;
+
+  // Intra-op parallelism: a copy or matmul is cut into pieces run across the
+  // worker pool when the pool has nothing queued and every piece still moves
+  // at least this many bytes (copies) or performs this many flops
+  // (matmuls). Zero disables splitting for that kind of op.
+  size_t intraOpMinBytes = 256 * 1024;
+  uint64_t intraOpMinFlops = 1 << 20;
+
+  // In in-order mode, consecutive matmuls outside parallel regions run
+  // concurrently when they target different matmul units and touch
+  // disjoint memory; each unit still runs its own matmuls in order.
+  bool concurrentMatmulUnits = false;
+
+  // Bind each PER_CORE core thread to its own host CPU.
+  bool pinCoreThreads = false;
+
+  // Threads running in-order mode's asynchronous copies. With zero threads
+  // a copy runs when something waits for it.
+  unsigned numDMAThreads = 0;
+
+  // Decoded ops the streaming parser may run ahead of execution.
+  size_t streamQueueCapacity = 1024;
+
+  SimulatorMemoryConfig memory;
+};
+
 class EPUSimulator : public Simulator {
 private:
-  void executeGlobalToLocalMemCopy(GlobalToLocalMemCopyOp *op);
+  EPUSimulatorOptions options;
+
+  EPUThreadPool threadPool;
+
+  EPUThreadPool dmaPool;
+
+  EPUTimingReport timingReport;
+
+  // Simulations that write this simulator's memory run one at a time.
+  std::mutex simulationMutex;
+
+  // Async simulations run one at a time, in launch order, on a worker
+  // thread started by the first launch. A run is dropped, with everything
+  // it captured, before its future becomes ready.
+  struct AsyncRun {
+    std::function<void()> run;
+    std::promise<void> done;
+  };
+
+  std::mutex asyncMutex;
+  std::condition_variable asyncWakeUp;
+  std::deque<AsyncRun> asyncRuns;
+  bool asyncStopping = false;
+  std::thread asyncWorker;
+
+  void asyncWorkerLoop();
+
+  std::future<void> launchAsync(std::function<void()> run);
+
+  // -----------------------------
+  // Decoding
+  // -----------------------------
+  DecodedOp decodeOp(Op *op) const;
+
+  DecodedOp decodeOp(const EPUProgram &program, size_t i) const;
+
+  // The helpers below fill in `decoded`, whose opCode and core are set.
+  void decodeGlobalToLocalMemCopy(const SliceOperand &src,
+                                  const SliceOperand &dst,
+                                  DecodedOp &decoded) const;
+
+  void decodeLocalToGlobalMemCopy(const SliceOperand &src,
+                                  const SliceOperand &dst,
+                                  DecodedOp &decoded) const;
+
+  void decodeMatmul(int mmUnit, bool accumulate, const SliceOperand &A,
+                    const SliceOperand &B, const SliceOperand &C,
+                    DecodedOp &decoded) const;
+
+  void decodeSync(int semaphore, DecodedOp &decoded) const;
+
+  void decodeBarrier(const std::vector<ID> &cores, DecodedOp &decoded) const;
+
+  // Marks a copy asynchronous if `dmaToken` is not negative.
+  void decodeAsync(int dmaToken, DecodedOp &decoded) const;
+
+  void decodeDMAWait(int dmaToken, DecodedOp &decoded) const;
+
+  // Pairs waits with their signals and groups matmuls once every op of
+  // `program` is decoded.
+  void finishDecode(EPUDecodedProgram &program) const;
+
+  // Appends the matmul groups of ops[0, numOps) to `groups`.
+  void findMatmulGroups(const DecodedOp *ops, uint32_t numOps,
+                        std::vector<EPUDecodedProgram::MatmulGroup> &groups)
+      const;
+
+  // -----------------------------
+  // Execution
+  // -----------------------------
+  void reportDecodeError(const DecodedOp &op) const;
+
+  void executeMatmul(const DecodedOp &op);
+
+  // Pieces worth cutting `op` into under the intra-op cost model; 1 to run
+  // it whole.
+  int getIntraOpSplit(const DecodedOp &op) const;
+
+  // Part `part` of `op` cut into `numParts` pieces: copies by rows (or
+  // columns), matmuls by output rows.
+  DecodedOp splitDecoded(const DecodedOp &op, int part, int numParts) const;
+
+  void nameProfilerEvents();
+
+  // Runs an op, split across the worker pool if it is large enough.
+  void runDecoded(const DecodedOp &op);
+
+  void runDecodedPiece(const DecodedOp &op);
+
+  void executeProfiled(const DecodedOp &op, uint64_t readyNs);
+
+  // `readyNs` is when the op became runnable, for the profiler; 0 if it ran
+  // right away.
+  void executeDecoded(const DecodedOp &op, uint64_t readyNs = 0);
 
-  void executeLocalToGlobalMemCopy(LocalToGlobalMemCopyOp *op);
+  void dispatchParallelRegion(const DecodedOp *begin, const DecodedOp *end);
 
-  void executeMatmul(MatmulOp *op);
+  // Runs a matmul group with one in-order queue per matmul unit.
+  void dispatchMatmulGroup(const DecodedOp *begin, const DecodedOp *end);
+
+  // -----------------------------
+  // Asynchronous copies (in-order mode)
+  // -----------------------------
+  static constexpr int32_t ALL_DMA = -1;
+
+  // Copies in flight, by (core, DMA token).
+  std::mutex dmaMutex;
+  std::map<std::pair<int32_t, int32_t>, std::unique_ptr<EPUTaskGroup>>
+      dmaInFlight;
+
+  void issueDMA(const DecodedOp &op, uint64_t readyNs);
+
+  // Waits for the copies in flight on `core` with `token`; ALL_DMA matches
+  // every core or token.
+  void waitDMA(int32_t core, int32_t token);
+
+  // Runs an op of an in-order program: async copies are issued to the DMA
+  // pool and sync ops also wait for the copies they cover.
+  void executeInOrder(const DecodedOp &op, uint64_t readyNs = 0);
+
+  // In-order execution of ops[0, numOps) given their matmul groups. Async
+  // copies may still be in flight on return.
+  void runInOrder(const DecodedOp *ops, size_t numOps,
+                  const std::vector<EPUDecodedProgram::MatmulGroup> &groups);
+
+  OpFootprint computeFootprint(const DecodedOp &op) const;
+
+  // Dependency DAG of the program's non-marker ops, which are returned in
+  // `ops` in graph order.
+  void buildDependencyGraph(const EPUDecodedProgram &program,
+                            std::vector<const DecodedOp *> &ops,
+                            EPUDependencyGraph &graph) const;
+
+  void simulateDataflow(const EPUDecodedProgram &program);
+
+  // Runs a parallel region holding sync ops, which order only the cores
+  // they name.
+  void dispatchSyncRegion(const DecodedOp *begin, const DecodedOp *end);
+
+  // Runs `ops` with `execute` on the worker pool, each once its
+  // predecessors in `graph` are done.
+  void runGraph(const std::vector<const DecodedOp *> &ops,
+                const EPUDependencyGraph &graph,
+                void (EPUSimulator::*execute)(const DecodedOp &, uint64_t));
+
+  // -----------------------------
+  // Per-core execution
+  // -----------------------------
+  // An op of a core stream may start once `core` has completed `progress`
+  // ops of its own stream.
+  struct StreamWait {
+    uint32_t core;
+    uint32_t progress;
+  };
+
+  struct CoreStream {
+    std::vector<const DecodedOp *> ops;
+    // Waits of ops[i] are waits[waitBegin[i] .. waitBegin[i + 1]).
+    std::vector<uint32_t> waitBegin;
+    std::vector<StreamWait> waits;
+  };
+
+  // Created by the first PER_CORE simulation.
+  std::unique_ptr<EPUCoreThreads> coreThreads;
+
+  EPUCoreStreamStats coreStreamStats;
+
+  void buildCoreStreams(const EPUDecodedProgram &program,
+                        std::vector<CoreStream> &streams) const;
+
+  void simulatePerCore(const EPUDecodedProgram &program);
+
+  // -----------------------------
+  // Streaming execution
+  // -----------------------------
+  using OpConsumer = std::function<void(std::unique_ptr<Op>)>;
+
+  EPUStreamStats streamStats;
+
+  // Runs `produce` on a parser thread; every op it hands to its consumer is
+  // decoded there and executed in order on the calling thread.
+  void simulateStream(const std::function<void(const OpConsumer &)> &produce);
+
+  // -----------------------------
+  // Batched execution
+  // -----------------------------
+  // Local memory views of batch members, kept across batches.
+  std::mutex batchViewMutex;
+  std::vector<std::unique_ptr<EPULocalMemoryView>> batchViews;
+  std::vector<EPULocalMemoryView *> freeBatchViews;
+
+  EPULocalMemoryView *acquireBatchView();
+
+  void releaseBatchView(EPULocalMemoryView *view);
+
+  void validateBatch(const EPUDecodedProgram &program,
+                     const std::vector<EPUBatchBinding> &batch) const;
+
+  // Points `op` at the member's local memory view and bound handles.
+  void relocateForBatch(DecodedOp &op, const EPUBatchBinding &binding,
+                        uint8_t *localView) const;
+
+  void runBatchMember(const EPUDecodedProgram &program,
+                      const EPUBatchBinding &binding,
+                      EPULocalMemoryView &view);
 
 public:
-  EPUSimulator(const Processor &proc) : Simulator(proc) {}
+  EPUSimulator(const Processor &proc,
+               const EPUSimulatorOptions &options = EPUSimulatorOptions())
+      : Simulator(proc, options.memory), options(options),
+        threadPool(options.numWorkerThreads),
+        dmaPool(options.numDMAThreads) {
+    nameProfilerEvents();
+  }
+
+  // Forks a simulator from a memory image; see Simulator. The memory config
+  // of `options` is ignored.
+  EPUSimulator(const Processor &proc,
+               std::shared_ptr<const SimulatorMemoryImage> image,
+               const EPUSimulatorOptions &options = EPUSimulatorOptions())
+      : Simulator(proc, std::move(image)), options(options),
+        threadPool(options.numWorkerThreads),
+        dmaPool(options.numDMAThreads) {
+    nameProfilerEvents();
+  }
+
+  // Waits for outstanding async simulations.
+  ~EPUSimulator();
+
+  // Lowers a parsed program into decoded records bound to this simulator's
+  // current handles. The result can be executed any number of times with
+  // simulateDecoded() as long as no handle is registered in between.
+  EPUDecodedProgram
+  decode(const std::vector<std::unique_ptr<Op>> &instructions) const;
+
+  EPUDecodedProgram decode(const EPUProgram &instructions) const;
+
+  void simulateDecoded(const EPUDecodedProgram &program);
+
+  // Asynchronous simulateDecoded(): returns at once and runs the program on
+  // a separate thread; the future reports completion or rethrows the error.
+  // The handle table is frozen from this call until the run ends, and async
+  // runs execute in the order they were launched. `program` must stay alive
+  // until the future is ready, and outputs must not be retrieved before.
+  std::future<void> simulateDecodedAsync(const EPUDecodedProgram &program);
+
+  // As above, but the run shares ownership of `program` and lets go of it
+  // before the future becomes ready.
+  std::future<void>
+  simulateDecodedAsync(std::shared_ptr<const EPUDecodedProgram> program);
 
-  ~EPUSimulator() = default;
+  // Decodes `instructions` right away (so they need not outlive the call)
+  // and simulates them asynchronously like simulateDecodedAsync().
+  std::future<void> simulateInstructionsAsync(
+      const std::vector<std::unique_ptr<Op>> &instructions);
+
+  // Runs `program` once per binding. Members run concurrently on the worker
+  // pool, each in program order against a private view of local memory and
+  // its own bound input/output buffers, while sharing the decoded program
+  // and every unbound input handle. Nothing is copied into global memory.
+  EPUBatchReport simulateBatch(const EPUDecodedProgram &program,
+                               const std::vector<EPUBatchBinding> &batch);
 
   void execute(Op *inst);
 
   void dispatchParallelInstructions(const std::vector<Op *> &insts);
 
+  const EPUSimulatorOptions &getOptions() const { return options; }
+
+  EPUThreadPoolStats getThreadPoolStats() const {
+    return threadPool.getStats();
+  }
+
+  void resetThreadPoolStats() { threadPool.resetStats(); }
+
+  // Empty unless the last simulation ran in PER_CORE mode.
+  const EPUCoreStreamStats &getCoreStreamStats() const {
+    return coreStreamStats;
+  }
+
+  // Predicted runtime of `program` under the configured execution mode,
+  // without running it.
+  EPUTimingReport estimateTiming(const EPUDecodedProgram &program) const;
+
+  // Timing of the last simulated program; empty unless the timing model is
+  // enabled.
+  const EPUTimingReport &getTimingReport() const { return timingReport; }
+
   void simulateInstructions(
       const std::vector<std::unique_ptr<Op>> &instructions) override;
+
+  // simulateInstructions() for a program parsed with
+  // EPUAsmParser::parseProgram.
+  void simulateProgram(const EPUProgram &program);
+
+  // Streaming simulation of the program in `filename`, assembly or binary.
+  // A parser thread decodes ops while this thread executes them, so memory
+  // stays bounded by streamQueueCapacity plus the longest parallel region
+  // and execution starts with the first op. Ops run in order as in
+  // IN_ORDER mode, the only mode supported; the timing model is not
+  // applied. A parse error is thrown once the ops before it have run.
+  void simulateStreaming(const std::string &filename);
+
+  void simulateStreamingText(std::string_view text,
+                             const std::string &sourceName = "<buffer>");
+
+  const EPUStreamStats &getStreamStats() const { return streamStats; }
 };
 
-#endif // EPUSIMULATOR_H
\ No newline at end of file
+#endif // EPUSIMULATOR_H
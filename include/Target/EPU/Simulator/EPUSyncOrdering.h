@@ -0,0 +1,53 @@
+#include "Target/EPU/Simulator/EPUDecodedProgram.h"
+#include "Target/EPU/Simulator/EPUDependencyGraph.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#ifndef EPU_SYNC_ORDERING_H
+#define EPU_SYNC_ORDERING_H
+
+// Ordering that signal, wait, barrier and dma_wait add on top of memory
+// hazards, tracked while a graph is built in program order: a signal or
+// barrier waits for every earlier op of its cores, a wait for the signal it
+// consumes, a dma_wait for its async copies, and later ops of those cores
+// for the sync op. Cores a sync op does not name are not held back.
+class EPUSyncOrdering {
+private:
+  EPUDependencyGraph &graph;
+  std::vector<int64_t> lastSync;
+  std::vector<std::vector<uint32_t>> opsSinceSync;
+  // Graph node of each program op; empty when the graph covers one
+  // parallel region only.
+  std::vector<int64_t> nodeOfOp;
+  // Region signals by semaphore, when waits cannot name their signal.
+  std::map<int32_t, std::vector<uint32_t>> signalsOf;
+  // Async copies not yet waited for, by (core, DMA token).
+  std::map<std::pair<int32_t, int32_t>, std::vector<uint32_t>> dmaInFlight;
+
+  // Orders `node` after everything core `core` did so far.
+  void joinCore(int core, uint32_t node);
+
+public:
+  // Ordering of a whole decoded program, whose waits know their signal.
+  EPUSyncOrdering(EPUDependencyGraph &graph, int numCores, size_t numOps)
+      : graph(graph), lastSync(numCores, -1), opsSinceSync(numCores),
+        nodeOfOp(numOps, -1) {}
+
+  // Ordering of a parallel region run in order with the rest of the
+  // program. Its waits may consume a signal from before the region, which
+  // has run already, or any earlier signal of the region on the same
+  // semaphore, so they wait for all of those. The region's ops have no
+  // memory edges, so a wait or dma_wait also waits for every earlier op of
+  // its core; async copies in the region finish once issued.
+  EPUSyncOrdering(EPUDependencyGraph &graph, int numCores)
+      : graph(graph), lastSync(numCores, -1), opsSinceSync(numCores) {}
+
+  // Adds the ordering of `op`, the program op at `opIndex`, which was just
+  // added to the graph as `node`.
+  void addOp(size_t opIndex, const DecodedOp &op, uint32_t node);
+};
+
+#endif // EPU_SYNC_ORDERING_H
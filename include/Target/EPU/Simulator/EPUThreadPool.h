@@ -0,0 +1,135 @@
+#include "Utils/BoundedMPMCQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef EPU_THREAD_POOL_H
+#define EPU_THREAD_POOL_H
+
+class EPUThreadPool;
+
+// Completion barrier for a set of tasks submitted to an EPUThreadPool. The
+// first exception thrown by any task of the group is rethrown from wait().
+class EPUTaskGroup {
+private:
+  size_t pending = 0;
+  std::mutex mutex;
+  std::condition_variable done;
+  std::exception_ptr error;
+
+  friend class EPUThreadPool;
+
+  void add() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++pending;
+  }
+
+  void finishOne(std::exception_ptr taskError) {
+    // Decrement under the lock so a waiter cannot observe completion (and
+    // destroy the group) while we are still notifying.
+    std::lock_guard<std::mutex> lock(mutex);
+    if (taskError && !error)
+      error = taskError;
+    if (--pending == 0)
+      done.notify_all();
+  }
+
+  bool isDone() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending == 0;
+  }
+
+public:
+  EPUTaskGroup() = default;
+  EPUTaskGroup(const EPUTaskGroup &) = delete;
+  EPUTaskGroup &operator=(const EPUTaskGroup &) = delete;
+};
+
+// Counters describing how the pool spent its time. Times are in nanoseconds
+// and summed over all threads.
+struct EPUThreadPoolStats {
+  unsigned numThreads = 0;
+  uint64_t tasksSubmitted = 0;
+  uint64_t tasksExecuted = 0;
+  // Tasks run by the thread waiting on a group (or inline because the queue
+  // was full) rather than by a pool worker.
+  uint64_t tasksExecutedByCaller = 0;
+  // Time between a task being queued and a thread starting it.
+  uint64_t queueWaitNs = 0;
+  // Time workers spent running tasks.
+  uint64_t busyNs = 0;
+  // Time workers spent spinning or sleeping without work.
+  uint64_t idleNs = 0;
+};
+
+// Long-lived worker pool used to execute parallel regions.
+//
+// Tasks go through a lock-free bounded MPMC queue. Idle workers spin briefly
+// and then sleep until new work is submitted. A thread waiting on a task group
+// helps by running queued tasks itself, so a pool with zero workers is valid
+// and simply runs everything on the waiting thread.
+class EPUThreadPool {
+private:
+  struct PoolTask {
+    std::function<void()> fn;
+    EPUTaskGroup *group = nullptr;
+    uint64_t enqueueNs = 0;
+  };
+
+  static constexpr size_t QUEUE_CAPACITY = 4096;
+  static constexpr int SPIN_ITERATIONS = 64;
+
+  BoundedMPMCQueue<PoolTask> queue;
+  std::vector<std::thread> workers;
+
+  std::atomic<size_t> queued{0};
+  std::atomic<unsigned> sleepers{0};
+  std::atomic<bool> stopping{false};
+  std::mutex sleepMutex;
+  std::condition_variable wakeUp;
+
+  std::atomic<uint64_t> tasksSubmitted{0};
+  std::atomic<uint64_t> tasksExecuted{0};
+  std::atomic<uint64_t> tasksExecutedByCaller{0};
+  std::atomic<uint64_t> queueWaitNs{0};
+  std::atomic<uint64_t> busyNs{0};
+  std::atomic<uint64_t> idleNs{0};
+
+  static uint64_t nowNs();
+
+  void workerLoop();
+
+  bool tryRunOne(bool byCaller);
+
+  void runTask(PoolTask &task);
+
+public:
+  explicit EPUThreadPool(unsigned numThreads);
+
+  ~EPUThreadPool();
+
+  EPUThreadPool(const EPUThreadPool &) = delete;
+  EPUThreadPool &operator=(const EPUThreadPool &) = delete;
+
+  unsigned getNumThreads() const { return workers.size(); }
+
+  // Tasks submitted but not yet started.
+  size_t getNumQueuedTasks() const { return queued.load(); }
+
+  void submit(EPUTaskGroup &group, std::function<void()> fn);
+
+  // Blocks until every task of the group has finished, running queued tasks
+  // on the calling thread meanwhile. Rethrows the group's first exception.
+  void wait(EPUTaskGroup &group);
+
+  EPUThreadPoolStats getStats() const;
+
+  void resetStats();
+};
+
+#endif // EPU_THREAD_POOL_H
@@ -0,0 +1,109 @@
+#include "Processor/Processor.h"
+#include "Target/EPU/Simulator/EPUDecodedProgram.h"
+#include "Target/EPU/Simulator/EPUDependencyGraph.h"
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#ifndef EPU_TIMING_MODEL_H
+#define EPU_TIMING_MODEL_H
+
+struct EPUMatmulUnitTiming {
+  uint64_t numOps = 0;
+  uint64_t busyCycles = 0;
+  double utilization = 0.0; // busy / total cycles
+};
+
+struct EPUCoreTiming {
+  // Cycles during which the core's DMA engine or any of its matmul units
+  // was working, and the rest of the run.
+  uint64_t busyCycles = 0;
+  uint64_t idleCycles = 0;
+  uint64_t dmaOps = 0;
+  uint64_t dmaBusyCycles = 0;
+  uint64_t dmaBytes = 0;
+  std::vector<EPUMatmulUnitTiming> matmulUnits;
+};
+
+// Predicted runtime of a program on the modeled EPU.
+struct EPUTimingReport {
+  uint64_t totalCycles = 0;
+  uint64_t joinCycles = 0; // spent synchronizing at end_parallel
+  std::vector<EPUCoreTiming> cores;
+
+  void print(std::ostream &os) const;
+};
+
+// Cycle-approximate EPU timing.
+//
+// Each core has one DMA engine serving its cp ops and one pipeline per
+// matmul unit; a resource runs one op at a time. Ops are scheduled in
+// program order at the earliest cycle where their resource is free and
+// their inputs are ready:
+//  - in-order mode, an op outside a parallel region starts after everything
+//    before it has finished; ops inside a region wait for their resource
+//    and for the ordering the region's sync ops add (EPUSyncOrdering), and
+//    the region ends with a join costing the processor's join cycles.
+//    Async copies only hold the DMA engine: the program moves on and the
+//    copy's end is waited for at a dma_wait, a signal or barrier of its
+//    core, or the end of the region or program. Matmul groups (see
+//    EPUDecodedProgram) start all their ops together and only serialize on
+//    each unit;
+//  - dataflow mode, an op waits for its predecessors in the dependency
+//    graph.
+// The costs are:
+//  - cp ops: DMA latency + bytes / DMA bytes per cycle;
+//  - matmul: unit latency + M * N * K / unit MACs per cycle.
+class EPUTimingModel {
+private:
+  const Processor &processor;
+
+  struct ResourceTimeline {
+    uint64_t freeAt = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> busy;
+  };
+
+  // One DMA timeline followed by one per matmul unit, for every core.
+  std::vector<ResourceTimeline> timelines;
+  std::vector<size_t> coreFirstTimeline;
+  EPUTimingReport report;
+
+  // In-order mode: finish cycle of the async copies in flight, by (core,
+  // DMA token).
+  std::map<std::pair<int32_t, int32_t>, uint64_t> dmaInFlight;
+
+  void resetState();
+
+  ResourceTimeline *getResource(const DecodedOp &op);
+
+  // Schedules `op` no earlier than `readyAt` and returns its finish cycle.
+  uint64_t scheduleOp(const DecodedOp &op, uint64_t readyAt);
+
+  EPUTimingReport finish(uint64_t endCycle);
+
+  // Retires the async copies in flight on `core` with `token` (-1 matches
+  // any) and returns the cycle the last of them finishes.
+  uint64_t waitDMA(int32_t core, int32_t token);
+
+  // Schedules an op of an in-order program starting at `now` and returns
+  // the cycle the program moves on.
+  uint64_t scheduleInOrder(const DecodedOp &op, uint64_t now);
+
+public:
+  explicit EPUTimingModel(const Processor &processor)
+      : processor(processor) {}
+
+  // Cycles `op` occupies its resource; 0 for ops that take no time.
+  uint64_t getOpCycles(const DecodedOp &op) const;
+
+  EPUTimingReport estimateInOrder(const EPUDecodedProgram &program);
+
+  // `ops` are the program's non-marker ops in the order they were added to
+  // `graph`.
+  EPUTimingReport estimateDataflow(const std::vector<const DecodedOp *> &ops,
+                                   const EPUDependencyGraph &graph);
+};
+
+#endif // EPU_TIMING_MODEL_H
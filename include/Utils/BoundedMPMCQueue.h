@@ -0,0 +1,100 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#ifndef BOUNDED_MPMC_QUEUE_H
+#define BOUNDED_MPMC_QUEUE_H
+
+// Lock-free bounded multi-producer/multi-consumer queue (Vyukov's array queue).
+//
+// Every cell carries a sequence number that tells producers and consumers
+// whether the cell is free for the current lap, so a push or pop is a single
+// CAS on the shared position plus one release store. Capacity is rounded up to
+// a power of two. tryPush/tryPop never block; callers decide how to back off.
+template <typename T> class BoundedMPMCQueue {
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  static constexpr size_t CACHE_LINE = 64;
+
+  std::unique_ptr<Cell[]> cells;
+  size_t mask;
+
+  alignas(CACHE_LINE) std::atomic<size_t> enqueuePos{0};
+  alignas(CACHE_LINE) std::atomic<size_t> dequeuePos{0};
+
+  static size_t roundUpToPowerOfTwo(size_t n) {
+    size_t capacity = 2;
+    while (capacity < n)
+      capacity <<= 1;
+    return capacity;
+  }
+
+public:
+  explicit BoundedMPMCQueue(size_t capacity) {
+    size_t size = roundUpToPowerOfTwo(capacity);
+    cells.reset(new Cell[size]);
+    mask = size - 1;
+    for (size_t i = 0; i < size; ++i)
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  BoundedMPMCQueue(const BoundedMPMCQueue &) = delete;
+  BoundedMPMCQueue &operator=(const BoundedMPMCQueue &) = delete;
+
+  size_t capacity() const { return mask + 1; }
+
+  bool tryPush(T &&value) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells[pos & mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // full
+      } else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->data = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool tryPop(T &value) {
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells[pos & mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // empty
+      } else {
+        pos = dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    value = std::move(cell->data);
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+#endif // BOUNDED_MPMC_QUEUE_H
@@ -0,0 +1,79 @@
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+// Read-only, private memory mapping of a whole file. Pages are faulted in on
+// demand, so mapping a multi-GB file costs nothing until it is read.
+class MappedFile {
+private:
+  void *data = nullptr;
+  size_t size = 0;
+
+  void release() {
+    if (data)
+      munmap(data, size);
+    data = nullptr;
+    size = 0;
+  }
+
+public:
+  MappedFile() = default;
+
+  explicit MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      throw std::runtime_error("Cannot open file: " + path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      throw std::runtime_error("Cannot stat file: " + path);
+    }
+
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+      void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("Cannot map file: " + path);
+      }
+      data = mapping;
+    }
+
+    // The mapping keeps the file alive.
+    close(fd);
+  }
+
+  ~MappedFile() { release(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept
+      : data(std::exchange(other.data, nullptr)),
+        size(std::exchange(other.size, 0)) {}
+
+  MappedFile &operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+      release();
+      data = std::exchange(other.data, nullptr);
+      size = std::exchange(other.size, 0);
+    }
+    return *this;
+  }
+
+  const uint8_t *getData() const { return static_cast<const uint8_t *>(data); }
+
+  size_t getSize() const { return size; }
+};
+
+#endif // MAPPED_FILE_H
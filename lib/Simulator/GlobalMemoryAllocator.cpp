@@ -0,0 +1,88 @@
+#include "Simulator/GlobalMemoryAllocator.h"
+#include <algorithm>
+#include <stdexcept>
+
+GlobalMemoryAllocator::GlobalMemoryAllocator(size_t capacity,
+                                             size_t alignment)
+    : capacity(capacity), alignment(alignment) {
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    throw std::runtime_error("Allocator alignment must be a power of two");
+  reset();
+}
+
+size_t GlobalMemoryAllocator::getAllocationSize(size_t numBytes) const {
+  // Zero-byte handles still get a distinct range.
+  size_t size = std::max<size_t>(numBytes, 1);
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+void GlobalMemoryAllocator::insertFree(size_t offset, size_t size) {
+  freeByOffset[offset] = size;
+  freeBySize.insert({size, offset});
+}
+
+void GlobalMemoryAllocator::eraseFree(
+    std::map<size_t, size_t>::iterator range) {
+  auto bySize = freeBySize.equal_range(range->second);
+  for (auto it = bySize.first; it != bySize.second; ++it) {
+    if (it->second == range->first) {
+      freeBySize.erase(it);
+      break;
+    }
+  }
+  freeByOffset.erase(range);
+}
+
+bool GlobalMemoryAllocator::allocate(size_t numBytes, size_t &offset) {
+  size_t size = getAllocationSize(numBytes);
+
+  auto best = freeBySize.lower_bound(size);
+  if (best == freeBySize.end())
+    return false;
+
+  offset = best->second;
+  size_t rangeSize = best->first;
+  eraseFree(freeByOffset.find(offset));
+  if (rangeSize > size)
+    insertFree(offset + size, rangeSize - size);
+
+  usedBytes += size;
+  highWaterMark = std::max(highWaterMark, offset + size);
+  return true;
+}
+
+void GlobalMemoryAllocator::release(size_t offset, size_t numBytes) {
+  size_t size = getAllocationSize(numBytes);
+  usedBytes -= size;
+
+  // Merge with the free neighbours on either side.
+  auto next = freeByOffset.lower_bound(offset);
+  if (next != freeByOffset.end() && next->first == offset + size) {
+    size += next->second;
+    eraseFree(next);
+  }
+
+  auto prev = freeByOffset.lower_bound(offset);
+  if (prev != freeByOffset.begin()) {
+    --prev;
+    if (prev->first + prev->second == offset) {
+      offset = prev->first;
+      size += prev->second;
+      eraseFree(prev);
+    }
+  }
+
+  insertFree(offset, size);
+}
+
+void GlobalMemoryAllocator::reset() {
+  freeByOffset.clear();
+  freeBySize.clear();
+  usedBytes = 0;
+  highWaterMark = 0;
+
+  // Only whole aligned units are handed out.
+  size_t usable = capacity & ~(alignment - 1);
+  if (usable > 0)
+    insertFree(0, usable);
+}
@@ -4,59 +4,555 @@
 #include <cstring>
 #include <exception>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
 
-void Simulator::registerInputHandle(int handleId, const void *rawData,
-                                    size_t numBytes, std::vector<int> shape) {
-  if (nextFreeGlobalMemoryOffset + numBytes > globalMemorySize)
+static size_t roundUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+Simulator::Simulator(const Processor &proc,
+                     const SimulatorMemoryConfig &memoryConfig)
+    : processor(proc), profiler(proc.getNumberOfCores()) {
+  globalMemorySize = proc.getGlobalMemory();
+  numberOfCores = proc.getNumberOfCores();
+  if (numberOfCores > 0) {
+    localMemoryPerCore = proc.getLocalMemoryPerCore();
+  } else {
+    localMemoryPerCore = 0;
+  }
+
+  constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+  bool explicitHugePages = memoryConfig.hugePages == HugePageMode::EXPLICIT;
+
+  auto computeLayout = [&]() {
+    pageSize = explicitHugePages ? HUGE_PAGE_SIZE : sysconf(_SC_PAGESIZE);
+    globalRegionSize = roundUp(globalMemorySize, pageSize);
+    localRegionStride = roundUp(localMemoryPerCore, pageSize);
+    totalMemorySize = globalRegionSize + localRegionStride * numberOfCores;
+  };
+
+  // Reserve address space only; pages are committed (zero-filled) on first
+  // touch, so a simulator that uses a few KiB costs a few KiB.
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+  void *mapping = MAP_FAILED;
+
+  if (explicitHugePages) {
+    // Without MAP_NORESERVE so the huge page pool is checked here rather
+    // than by a SIGBUS on first touch.
+    computeLayout();
+    mapping = mmap(nullptr, totalMemorySize, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapping == MAP_FAILED) {
+      std::cerr << "WARNING: explicit huge pages unavailable, falling back to "
+                   "regular pages\n";
+      explicitHugePages = false;
+    }
+  }
+
+  if (mapping == MAP_FAILED) {
+    computeLayout();
+    mapping = mmap(nullptr, totalMemorySize, PROT_READ | PROT_WRITE, flags,
+                   -1, 0);
+    if (mapping == MAP_FAILED)
+      throw std::runtime_error("Failed to reserve simulator memory");
+
+    if (memoryConfig.hugePages == HugePageMode::TRANSPARENT)
+      madvise(mapping, totalMemorySize, MADV_HUGEPAGE);
+  }
+
+  memory = static_cast<uint8_t *>(mapping);
+  globalAllocator = GlobalMemoryAllocator(globalMemorySize);
+}
+
+Simulator::Simulator(const Processor &proc,
+                     std::shared_ptr<const SimulatorMemoryImage> image)
+    : Simulator(proc, SimulatorMemoryConfig()) {
+  if (image->globalMemorySize != static_cast<size_t>(globalMemorySize))
+    throw std::runtime_error(
+        "Memory image was taken from a processor with a different global "
+        "memory size");
+
+  // Replace the global part of the reservation with a private mapping of
+  // the image; pages stay shared until written.
+  baseImage = std::move(image);
+  reset();
+}
+
+Simulator::~Simulator() { munmap(memory, totalMemorySize); }
+
+SimulatorMemoryImage::~SimulatorMemoryImage() {
+  if (fd >= 0)
+    close(fd);
+}
+
+std::shared_ptr<const SimulatorMemoryImage>
+Simulator::createMemoryImage() const {
+  std::shared_ptr<SimulatorMemoryImage> image(new SimulatorMemoryImage());
+  image->globalMemorySize = globalMemorySize;
+  image->globalRegionSize = roundUp(globalMemorySize, sysconf(_SC_PAGESIZE));
+  image->globalAllocator = globalAllocator;
+  image->handleTable = handleTable;
+  image->mappedInputFiles = mappedInputFiles;
+
+  image->fd = memfd_create("simulator-memory-image", MFD_CLOEXEC);
+  if (image->fd < 0)
+    throw std::runtime_error("Failed to create memory image file");
+
+  // The file is sparse: only the bytes up to the highest allocation are
+  // written, the rest reads as zero like fresh simulator memory.
+  if (ftruncate(image->fd, image->globalRegionSize) != 0)
+    throw std::runtime_error("Failed to size memory image file");
+
+  size_t written = 0;
+  size_t usedBytes = globalAllocator.getHighWaterMark();
+  while (written < usedBytes) {
+    ssize_t n = pwrite(image->fd, memory + written, usedBytes - written,
+                       written);
+    if (n <= 0)
+      throw std::runtime_error("Failed to write memory image file");
+    written += n;
+  }
+
+  return image;
+}
+
+// Bytes of [begin, begin + numBytes) currently backed by host memory.
+static size_t countResidentBytes(uint8_t *begin, size_t numBytes) {
+  if (numBytes == 0)
+    return 0;
+
+  // mincore always works in base pages, even inside huge page mappings.
+  const size_t basePage = sysconf(_SC_PAGESIZE);
+  size_t numPages = (numBytes + basePage - 1) / basePage;
+  std::vector<unsigned char> residency(numPages);
+  if (mincore(begin, numBytes, residency.data()) != 0)
+    return 0;
+
+  size_t resident = 0;
+  for (unsigned char page : residency)
+    resident += (page & 1) ? basePage : 0;
+  return resident;
+}
+
+SimulatorMemoryUsage Simulator::getMemoryUsage() const {
+  SimulatorMemoryUsage usage;
+  usage.reservedBytes = totalMemorySize;
+  usage.residentGlobalBytes = countResidentBytes(memory, globalRegionSize);
+  usage.residentBytes = usage.residentGlobalBytes;
+
+  for (int core = 0; core < numberOfCores; ++core) {
+    size_t resident = countResidentBytes(getLocalMemoryBaseAddress(core),
+                                         localRegionStride);
+    usage.residentLocalBytes.push_back(resident);
+    usage.residentBytes += resident;
+  }
+
+  return usage;
+}
+
+// Handle IDs index a dense table; keep them small.
+static constexpr int MAX_HANDLE_ID = 1 << 20;
+
+void Simulator::checkHandleRegistration(int handleId,
+                                        HandleDirection direction) {
+  if (areHandlesFrozen())
+    throw std::runtime_error("Cannot register handle " +
+                             std::to_string(handleId) +
+                             " while the handle table is frozen");
+
+  if (handleId < 0 || handleId >= MAX_HANDLE_ID)
+    throw std::runtime_error("Handle ID out of range: " +
+                             std::to_string(handleId));
+
+  if (static_cast<size_t>(handleId) >= handleTable.size())
+    handleTable.resize(handleId + 1);
+
+  HandleDirection current = handleTable[handleId].direction;
+  if (current != HandleDirection::UNUSED && current != direction)
+    throw std::runtime_error(
+        "Handle " + std::to_string(handleId) + " is registered as an " +
+        (current == HandleDirection::INPUT ? "input" : "output") +
+        " handle; release it before registering it as an " +
+        (direction == HandleDirection::INPUT ? "input" : "output"));
+}
+
+void Simulator::installHandle(int handleId, const HandleEntry &entry) {
+  ++handleEpoch;
+  releaseHandleStorage(handleId, handleTable[handleId]);
+  handleTable[handleId] = entry;
+}
+
+size_t Simulator::allocateGlobalMemory(size_t numBytes) {
+  size_t offset;
+  if (!globalAllocator.allocate(numBytes, offset))
     throw std::runtime_error("No space in global memory");
+  return offset;
+}
+
+void Simulator::clearMemory(uint8_t *begin, size_t numBytes,
+                            bool isImageBacked) {
+  uint8_t *end = begin + numBytes;
+  uintptr_t pageMask = pageSize - 1;
+  uint8_t *firstPage = reinterpret_cast<uint8_t *>(
+      (reinterpret_cast<uintptr_t>(begin) + pageMask) & ~pageMask);
+  uint8_t *lastPage = reinterpret_cast<uint8_t *>(
+      reinterpret_cast<uintptr_t>(end) & ~pageMask);
+
+  if (firstPage >= lastPage) {
+    std::memset(begin, 0, numBytes);
+    return;
+  }
+
+  std::memset(begin, 0, firstPage - begin);
+  std::memset(lastPage, 0, end - lastPage);
+
+  size_t pagesBytes = lastPage - firstPage;
+  if (isImageBacked) {
+    // Dropping private pages of a file mapping would bring back the file's
+    // contents; map fresh zero pages over them instead.
+    if (mmap(firstPage, pagesBytes, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1,
+             0) != MAP_FAILED)
+      return;
+  } else if (madvise(firstPage, pagesBytes, MADV_DONTNEED) == 0) {
+    return;
+  }
+
+  std::memset(firstPage, 0, pagesBytes);
+}
+
+void Simulator::releaseHandleStorage(int handleId, HandleEntry &entry) {
+  if (entry.direction != HandleDirection::UNUSED && !entry.externalData) {
+    clearMemory(memory + entry.offset,
+                globalAllocator.getAllocationSize(entry.numBytes),
+                baseImage != nullptr);
+    globalAllocator.release(entry.offset, entry.numBytes);
+  }
+
+  mappedInputFiles.erase(handleId);
+  entry = HandleEntry();
+}
+
+void Simulator::releaseHandle(int handleId) {
+  if (areHandlesFrozen())
+    throw std::runtime_error("Cannot release handle " +
+                             std::to_string(handleId) +
+                             " while the handle table is frozen");
 
+  if (handleId < 0 || static_cast<size_t>(handleId) >= handleTable.size() ||
+      handleTable[handleId].direction == HandleDirection::UNUSED)
+    throw std::runtime_error("Unknown handle ID: " + std::to_string(handleId));
+
+  releaseHandleStorage(handleId, handleTable[handleId]);
+  ++handleEpoch;
+}
+
+void Simulator::reset() {
+  if (areHandlesFrozen())
+    throw std::runtime_error(
+        "Cannot reset the simulator while the handle table is frozen");
+
+  if (baseImage) {
+    // Mapping the image again discards every private page.
+    void *mapping =
+        mmap(memory, baseImage->globalRegionSize, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_FIXED, baseImage->fd, 0);
+    if (mapping == MAP_FAILED)
+      throw std::runtime_error("Failed to map memory image");
+
+    globalAllocator = baseImage->globalAllocator;
+    handleTable = baseImage->handleTable;
+    mappedInputFiles = baseImage->mappedInputFiles;
+  } else {
+    clearMemory(memory, globalRegionSize, false);
+    globalAllocator.reset();
+    handleTable.clear();
+    mappedInputFiles.clear();
+  }
+
+  clearMemory(memory + globalRegionSize, totalMemorySize - globalRegionSize,
+              false);
+  ++handleEpoch;
+}
+
+void Simulator::registerInputHandle(int handleId, const void *rawData,
+                                    size_t numBytes, std::vector<int> shape) {
   assert(shape.size() == 2 && "Supports only 2d input/output type for now");
 
+  checkHandleRegistration(handleId, HandleDirection::INPUT);
+  size_t offset = allocateGlobalMemory(numBytes);
+
   // Copy input bytes into memory
-  std::memcpy(memory + nextFreeGlobalMemoryOffset, rawData, numBytes);
-  inputHandleToMemoryLocMap[handleId] = nextFreeGlobalMemoryOffset;
-  inputHandleToShapeMap[handleId] = shape;
+  std::memcpy(memory + offset, rawData, numBytes);
+  HandleEntry entry;
+  entry.direction = HandleDirection::INPUT;
+  entry.offset = offset;
+  entry.shape = shape;
+  entry.rowPitch = shape[1];
+  entry.numBytes = numBytes;
+  installHandle(handleId, entry);
+}
+
+static size_t getTensorBytes(const std::vector<int> &dims) {
+  size_t numElements = 1;
+  for (int dim : dims) {
+    if (dim < 0)
+      throw std::runtime_error("Negative tensor dimension");
+    numElements *= dim;
+  }
+  return numElements * sizeof(float);
+}
+
+void Simulator::registerExternalInputHandle(int handleId, const void *rawData,
+                                            size_t numBytes,
+                                            std::vector<int> shape) {
+  assert(shape.size() == 2 && "Supports only 2d input/output type for now");
+
+  if (numBytes < getTensorBytes(shape))
+    throw std::runtime_error("External buffer smaller than its shape");
 
-  nextFreeGlobalMemoryOffset += numBytes;
+  checkHandleRegistration(handleId, HandleDirection::INPUT);
+  HandleEntry entry;
+  entry.direction = HandleDirection::INPUT;
+  entry.externalData = static_cast<const uint8_t *>(rawData);
+  entry.shape = shape;
+  entry.rowPitch = shape[1];
+  entry.numBytes = numBytes;
+  installHandle(handleId, entry);
+}
+
+// Parsed header of a NumPy `.npy` file.
+struct NpyHeader {
+  std::string descr;
+  bool fortranOrder = false;
+  std::vector<int> shape;
+  size_t dataOffset = 0;
+};
+
+// Value of `key` in the header dict, up to the next top-level ',' or '}'.
+static std::string getNpyField(const std::string &dict,
+                               const std::string &key) {
+  size_t pos = dict.find("'" + key + "'");
+  if (pos == std::string::npos)
+    return "";
+  pos = dict.find(':', pos);
+  if (pos == std::string::npos)
+    return "";
+
+  size_t end = ++pos;
+  int depth = 0;
+  while (end < dict.size()) {
+    char c = dict[end];
+    if (c == '(')
+      ++depth;
+    else if (c == ')')
+      --depth;
+    else if ((c == ',' || c == '}') && depth == 0)
+      break;
+    ++end;
+  }
+
+  std::string value = dict.substr(pos, end - pos);
+  size_t first = value.find_first_not_of(" \t");
+  size_t last = value.find_last_not_of(" \t");
+  return first == std::string::npos ? ""
+                                    : value.substr(first, last - first + 1);
+}
+
+static bool parseNpyHeader(const uint8_t *data, size_t size,
+                           NpyHeader &header) {
+  static const char MAGIC[] = "\x93NUMPY";
+  if (size < 10 || std::memcmp(data, MAGIC, 6) != 0)
+    return false;
+
+  uint8_t major = data[6];
+  size_t headerLen;
+  size_t prefixLen;
+  if (major == 1) {
+    headerLen = data[8] | (data[9] << 8);
+    prefixLen = 10;
+  } else if (major == 2 || major == 3) {
+    if (size < 12)
+      return false;
+    headerLen = data[8] | (data[9] << 8) | (data[10] << 16) |
+                (static_cast<size_t>(data[11]) << 24);
+    prefixLen = 12;
+  } else {
+    return false;
+  }
+
+  if (prefixLen + headerLen > size)
+    return false;
+
+  std::string dict(reinterpret_cast<const char *>(data) + prefixLen,
+                   headerLen);
+
+  std::string descr = getNpyField(dict, "descr");
+  if (descr.size() < 2)
+    return false;
+  header.descr = descr.substr(1, descr.size() - 2);
+  header.fortranOrder = getNpyField(dict, "fortran_order") == "True";
+
+  std::string shape = getNpyField(dict, "shape");
+  if (shape.size() < 2 || shape.front() != '(' || shape.back() != ')')
+    return false;
+  header.shape.clear();
+  size_t pos = 1;
+  while (pos < shape.size() - 1) {
+    size_t next = shape.find(',', pos);
+    if (next == std::string::npos)
+      next = shape.size() - 1;
+    std::string item = shape.substr(pos, next - pos);
+    if (item.find_first_not_of(" ") != std::string::npos)
+      header.shape.push_back(std::stoi(item));
+    pos = next + 1;
+  }
+
+  header.dataOffset = prefixLen + headerLen;
+  return true;
+}
+
+void Simulator::registerMappedInputHandle(int handleId,
+                                          const std::string &path,
+                                          std::vector<int> dims) {
+  MappedFile file(path);
+  const uint8_t *data = file.getData();
+  size_t dataBytes = file.getSize();
+
+  NpyHeader header;
+  if (parseNpyHeader(data, dataBytes, header)) {
+    if (header.descr != "<f4" || header.fortranOrder)
+      throw std::runtime_error("Unsupported .npy layout in " + path +
+                               ": expected little-endian float32 in C order");
+    if (!dims.empty() && dims != header.shape)
+      throw std::runtime_error("Shape of " + path +
+                               " does not match the requested dims");
+    dims = header.shape;
+    data += header.dataOffset;
+    dataBytes -= header.dataOffset;
+  } else if (dims.empty()) {
+    throw std::runtime_error("Raw tensor file " + path + " needs dims");
+  }
+
+  if (dims.size() != 2)
+    throw std::runtime_error("Supports only 2d input/output type for now");
+
+  if (dataBytes < getTensorBytes(dims))
+    throw std::runtime_error("Tensor file " + path + " is too small");
+
+  checkHandleRegistration(handleId, HandleDirection::INPUT);
+  auto mapping = std::make_shared<const MappedFile>(std::move(file));
+  HandleEntry entry;
+  entry.direction = HandleDirection::INPUT;
+  entry.externalData = data;
+  entry.shape = dims;
+  entry.rowPitch = dims[1];
+  entry.numBytes = dataBytes;
+  installHandle(handleId, entry);
+  mappedInputFiles[handleId] = std::move(mapping);
 }
 
 void Simulator::registerOutputHandle(int handleId, size_t numBytes,
                                      std::vector<int> shape) {
-  if (nextFreeGlobalMemoryOffset + numBytes > globalMemorySize)
-    throw std::runtime_error("No space in global memory");
-
   assert(shape.size() == 2 && "Supports only 2d input/output type for now");
 
-  outputHandleToMemoryLocMap[handleId] = nextFreeGlobalMemoryOffset;
-  outputHandleToShapeMap[handleId] = shape;
-
-  nextFreeGlobalMemoryOffset += numBytes;
+  checkHandleRegistration(handleId, HandleDirection::OUTPUT);
+  HandleEntry entry;
+  entry.direction = HandleDirection::OUTPUT;
+  entry.offset = allocateGlobalMemory(numBytes);
+  entry.shape = shape;
+  entry.rowPitch = shape[1];
+  entry.numBytes = numBytes;
+  installHandle(handleId, entry);
 }
 
 void Simulator::retrieveLocalMemoryData(int coreNum, int offset,
                                         void *outputBuffer, size_t numBytes) {
+  if (coreNum < 0 || coreNum >= numberOfCores)
+    throw std::runtime_error("Invalid core ID: " + std::to_string(coreNum));
+  if (offset < 0 || offset > localMemoryPerCore ||
+      numBytes > static_cast<size_t>(localMemoryPerCore - offset))
+    throw std::runtime_error("Local memory read out of bounds on core " +
+                             std::to_string(coreNum));
 
-  int memOffset = (globalMemorySize + (coreNum * localMemoryPerCore)) + offset;
-
-  std::memcpy(outputBuffer, memory + memOffset, numBytes);
+  std::memcpy(outputBuffer, getLocalMemoryBaseAddress(coreNum) + offset,
+              numBytes);
 }
 
 void Simulator::retrieveInputData(int handleId, void *outputBuffer,
                                   size_t numBytes) {
-  if (inputHandleToMemoryLocMap.count(handleId) == 0) {
-    throw std::runtime_error("Unknown output handle ID");
+  const HandleEntry *entry = lookupHandle(handleId, HandleDirection::INPUT);
+  if (!entry) {
+    throw std::runtime_error("Unknown input handle ID");
   }
+  if (numBytes > entry->numBytes)
+    throw std::runtime_error("Read past the end of input handle " +
+                             std::to_string(handleId));
 
-  int memOffset = inputHandleToMemoryLocMap[handleId];
-  std::memcpy(outputBuffer, memory + memOffset, numBytes);
+  std::memcpy(outputBuffer, getHandleAddress(*entry), numBytes);
 }
 
 void Simulator::retrieveOutputData(int handleId, void *outputBuffer,
                                    size_t numBytes) {
-  if (outputHandleToMemoryLocMap.count(handleId) == 0) {
+  const HandleEntry *entry = lookupHandle(handleId, HandleDirection::OUTPUT);
+  if (!entry) {
     throw std::runtime_error("Unknown output handle ID");
   }
+  if (numBytes > entry->numBytes)
+    throw std::runtime_error("Read past the end of output handle " +
+                             std::to_string(handleId));
+
+  std::memcpy(outputBuffer, getHandleAddress(*entry), numBytes);
+}
+
+TensorView<float>
+Simulator::makeHandleView(int handleId, HandleDirection direction) const {
+  const HandleEntry *entry = lookupHandle(handleId, direction);
+  if (!entry)
+    throw std::runtime_error(
+        std::string(direction == HandleDirection::INPUT ? "Unknown input"
+                                                        : "Unknown output") +
+        " handle ID: " + std::to_string(handleId));
+
+  return TensorView<float>(
+      reinterpret_cast<const float *>(getHandleAddress(*entry)),
+      entry->shape[0], entry->shape[1], entry->rowPitch, &handleEpoch);
+}
 
-  int memOffset = outputHandleToMemoryLocMap[handleId];
-  std::memcpy(outputBuffer, memory + memOffset, numBytes);
-}
\ No newline at end of file
+TensorView<float> Simulator::getInputView(int handleId) const {
+  return makeHandleView(handleId, HandleDirection::INPUT);
+}
+
+TensorView<float> Simulator::getOutputView(int handleId) const {
+  return makeHandleView(handleId, HandleDirection::OUTPUT);
+}
+
+TensorView<float> Simulator::getLocalMemoryView(int coreNum, size_t offset,
+                                                int rows, int cols,
+                                                int rowPitch) const {
+  if (coreNum < 0 || coreNum >= numberOfCores)
+    throw std::runtime_error("Invalid core ID: " + std::to_string(coreNum));
+  if (rowPitch == 0)
+    rowPitch = cols;
+  if (rows < 0 || cols < 0 || rowPitch < cols)
+    throw std::runtime_error("Invalid local memory view shape");
+  if (offset % alignof(float) != 0)
+    throw std::runtime_error("Local memory view offset is not float aligned");
+
+  size_t numBytes = 0;
+  if (rows > 0)
+    numBytes = ((rows - 1) * static_cast<size_t>(rowPitch) + cols) *
+               sizeof(float);
+  if (offset > static_cast<size_t>(localMemoryPerCore) ||
+      numBytes > localMemoryPerCore - offset)
+    throw std::runtime_error("Local memory view out of bounds on core " +
+                             std::to_string(coreNum));
+
+  return TensorView<float>(reinterpret_cast<const float *>(
+                               getLocalMemoryBaseAddress(coreNum) + offset),
+                           rows, cols, rowPitch, &handleEpoch);
+}
@@ -0,0 +1,250 @@
+#include "Simulator/SimulatorProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+void SimulatorProfiler::AtomicStats::add(uint64_t opBytes, uint64_t opFlops,
+                                         uint64_t opWallNs,
+                                         uint64_t opPoolWaitNs) {
+  count.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(opBytes, std::memory_order_relaxed);
+  flops.fetch_add(opFlops, std::memory_order_relaxed);
+  wallNs.fetch_add(opWallNs, std::memory_order_relaxed);
+  poolWaitNs.fetch_add(opPoolWaitNs, std::memory_order_relaxed);
+}
+
+OpProfileStats SimulatorProfiler::AtomicStats::load() const {
+  OpProfileStats stats;
+  stats.count = count.load();
+  stats.bytes = bytes.load();
+  stats.flops = flops.load();
+  stats.wallNs = wallNs.load();
+  stats.poolWaitNs = poolWaitNs.load();
+  return stats;
+}
+
+void SimulatorProfiler::AtomicStats::clear() {
+  count.store(0);
+  bytes.store(0);
+  flops.store(0);
+  wallNs.store(0);
+  poolWaitNs.store(0);
+}
+
+SimulatorProfiler::SimulatorProfiler(int numCores)
+    : numCores(numCores), opTypeStats(new AtomicStats[MAX_OP_TYPES]),
+      coreStats(new AtomicStats[std::max(numCores, 1)]),
+      opTypeNames(MAX_OP_TYPES) {
+  epochNs = nowNs();
+}
+
+uint64_t SimulatorProfiler::nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void SimulatorProfiler::enable(bool recordTrace) {
+  tracing.store(recordTrace);
+  enabled.store(true);
+}
+
+void SimulatorProfiler::setOpTypeName(int opType, const std::string &name) {
+  if (opType >= 0 && opType < MAX_OP_TYPES)
+    opTypeNames[opType] = name;
+}
+
+void SimulatorProfiler::setLaneName(int lane, const std::string &name) {
+  if (lane < 0)
+    return;
+  if (static_cast<size_t>(lane) >= laneNames.size())
+    laneNames.resize(lane + 1);
+  laneNames[lane] = name;
+}
+
+// Small, stable per-thread number for trace args.
+static uint32_t getHostThreadIndex() {
+  static std::atomic<uint32_t> nextIndex{0};
+  thread_local uint32_t index = nextIndex.fetch_add(1);
+  return index;
+}
+
+void SimulatorProfiler::record(int opType, int core, int lane,
+                               uint64_t readyNs, uint64_t startNs,
+                               uint64_t endNs, uint64_t bytes,
+                               uint64_t flops) {
+  uint64_t wallNs = endNs - startNs;
+  uint64_t poolWaitNs =
+      (readyNs != 0 && readyNs < startNs) ? startNs - readyNs : 0;
+
+  if (opType >= 0 && opType < MAX_OP_TYPES)
+    opTypeStats[opType].add(bytes, flops, wallNs, poolWaitNs);
+  if (core >= 0 && core < numCores)
+    coreStats[core].add(bytes, flops, wallNs, poolWaitNs);
+
+  if (!tracing.load(std::memory_order_relaxed))
+    return;
+
+  Span span{opType, core,  lane,  getHostThreadIndex(), startNs,
+            endNs,  bytes, flops, poolWaitNs};
+  std::lock_guard<std::mutex> lock(spanMutex);
+  spans.push_back(span);
+}
+
+SimulatorProfile SimulatorProfiler::getProfile() const {
+  SimulatorProfile profile;
+  for (int opType = 0; opType < MAX_OP_TYPES; ++opType) {
+    profile.opTypeNames.push_back(opTypeNames[opType].empty()
+                                      ? "op" + std::to_string(opType)
+                                      : opTypeNames[opType]);
+    profile.byOpType.push_back(opTypeStats[opType].load());
+  }
+  for (int core = 0; core < numCores; ++core)
+    profile.byCore.push_back(coreStats[core].load());
+  return profile;
+}
+
+void SimulatorProfiler::reset() {
+  for (int opType = 0; opType < MAX_OP_TYPES; ++opType)
+    opTypeStats[opType].clear();
+  for (int core = 0; core < numCores; ++core)
+    coreStats[core].clear();
+
+  std::lock_guard<std::mutex> lock(spanMutex);
+  spans.clear();
+  epochNs = nowNs();
+}
+
+// Escapes `text` for use inside a JSON string.
+static std::string escapeJSON(const std::string &text) {
+  std::string escaped;
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      escaped += "\\\"";
+      break;
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    case '\t':
+      escaped += "\\t";
+      break;
+    default:
+      // JSON strings may not hold raw control characters.
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char code[8];
+        std::snprintf(code, sizeof(code), "\\u%04x",
+                      static_cast<unsigned char>(c));
+        escaped += code;
+      } else {
+        escaped += c;
+      }
+      break;
+    }
+  }
+  return escaped;
+}
+
+void SimulatorProfiler::writeChromeTrace(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out)
+    throw std::runtime_error("Cannot write trace file: " + path);
+
+  SimulatorProfile profile = getProfile();
+
+  std::lock_guard<std::mutex> lock(spanMutex);
+
+  // Trace timestamps are microseconds.
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+
+  bool first = true;
+  auto separator = [&]() -> std::ostream & {
+    out << (first ? "" : ",\n");
+    first = false;
+    return out;
+  };
+
+  // Name each core's process row and each lane's thread row.
+  int maxLane = static_cast<int>(laneNames.size()) - 1;
+  for (const Span &span : spans)
+    maxLane = std::max(maxLane, span.lane);
+
+  for (int core = 0; core < numCores; ++core) {
+    separator() << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": "
+                << core << ", \"args\": {\"name\": \"core " << core
+                << "\"}}";
+    separator() << "{\"name\": \"process_sort_index\", \"ph\": \"M\", "
+                   "\"pid\": "
+                << core << ", \"args\": {\"sort_index\": " << core << "}}";
+    for (int lane = 0; lane <= maxLane; ++lane) {
+      std::string laneName =
+          (static_cast<size_t>(lane) < laneNames.size() &&
+           !laneNames[lane].empty())
+              ? laneNames[lane]
+              : "lane " + std::to_string(lane);
+      separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": "
+                  << core << ", \"tid\": " << lane
+                  << ", \"args\": {\"name\": \"" << escapeJSON(laneName)
+                  << "\"}}";
+    }
+  }
+
+  for (const Span &span : spans) {
+    std::string name =
+        (span.opType >= 0 && span.opType < MAX_OP_TYPES)
+            ? profile.opTypeNames[span.opType]
+            : "op" + std::to_string(span.opType);
+    uint64_t start = span.startNs > epochNs ? span.startNs - epochNs : 0;
+
+    separator() << "{\"name\": \"" << escapeJSON(name)
+                << "\", \"cat\": \"op\", \"ph\": \"X\", \"pid\": " << span.core
+                << ", \"tid\": " << span.lane << ", \"ts\": " << start / 1e3
+                << ", \"dur\": " << (span.endNs - span.startNs) / 1e3
+                << ", \"args\": {\"bytes\": " << span.bytes
+                << ", \"flops\": " << span.flops
+                << ", \"pool_wait_us\": " << span.poolWaitNs / 1e3
+                << ", \"host_thread\": " << span.hostThread << "}}";
+  }
+
+  out << "\n]}\n";
+
+  if (!out)
+    throw std::runtime_error("Failed writing trace file: " + path);
+}
+
+void SimulatorProfile::print(std::ostream &os) const {
+  std::ios_base::fmtflags savedFlags = os.flags();
+  std::streamsize savedPrecision = os.precision();
+
+  auto printStats = [&os](const std::string &label,
+                          const OpProfileStats &stats) {
+    os << "  " << std::left << std::setw(20) << label << std::right
+       << " count " << stats.count << ", bytes " << stats.bytes << ", flops "
+       << stats.flops << ", wall " << std::fixed << std::setprecision(3)
+       << stats.wallNs / 1e6 << " ms, pool wait " << stats.poolWaitNs / 1e6
+       << " ms";
+    if (stats.wallNs > 0 && stats.flops > 0)
+      os << ", " << std::setprecision(2)
+         << static_cast<double>(stats.flops) / stats.wallNs << " GFLOP/s";
+    os << "\n";
+  };
+
+  os << "Simulator profile by op type:\n";
+  for (size_t opType = 0; opType < byOpType.size(); ++opType)
+    if (byOpType[opType].count > 0)
+      printStats(opTypeNames[opType], byOpType[opType]);
+
+  os << "Simulator profile by core:\n";
+  for (size_t core = 0; core < byCore.size(); ++core)
+    printStats("core " + std::to_string(core), byCore[core]);
+
+  os.flags(savedFlags);
+  os.precision(savedPrecision);
+}
@@ -0,0 +1,251 @@
+#include "Target/EPU/Asm/EPUProgram.h"
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+static_assert(sizeof(EPUProgram::Instr) == 12, "unexpected instr padding");
+
+size_t EPUProgram::DimHash::operator()(const Dim &dim) const {
+  size_t hash = std::hash<int>()(dim.getStart());
+  hash = hash * 31 + std::hash<int>()(dim.getEnd());
+  return hash * 31 + std::hash<int>()(dim.getStride());
+}
+
+size_t EPUProgram::getNumBytes() const {
+  return instrs.capacity() * sizeof(Instr) +
+         slices.capacity() * sizeof(PackedSlice) +
+         barrierCores.capacity() * sizeof(ID) +
+         dims.capacity() * sizeof(Dim) +
+         dimIndex.size() * (sizeof(Dim) + sizeof(uint32_t) + sizeof(void *)) +
+         dimIndex.bucket_count() * sizeof(void *);
+}
+
+void EPUProgram::reserve(size_t numOps) {
+  instrs.reserve(numOps);
+  // Most programs are dominated by copies and matmuls.
+  slices.reserve(2 * numOps);
+}
+
+// -----------------------------
+// Building
+// -----------------------------
+EPUProgram::Instr &EPUProgram::appendInstr(int opCode, ID core, int32_t imm,
+                                           uint32_t operands) {
+  if (core < MIN_CORE || core > MAX_CORE)
+    throw std::runtime_error("core " + std::to_string(core) +
+                             " is out of range");
+
+  Instr instr;
+  instr.opCode = static_cast<uint8_t>(opCode);
+  instr.flags = 0;
+  instr.core = static_cast<int16_t>(core);
+  instr.imm = imm;
+  instr.operands = operands;
+  instrs.push_back(instr);
+  return instrs.back();
+}
+
+uint32_t EPUProgram::internDim(const Dim &dim) {
+  auto it = dimIndex.find(dim);
+  if (it != dimIndex.end())
+    return it->second;
+
+  uint32_t index = static_cast<uint32_t>(dims.size());
+  dims.push_back(dim);
+  dimIndex.emplace(dim, index);
+  return index;
+}
+
+void EPUProgram::appendSlice(const SliceOperand &slice) {
+  PackedSlice packed;
+  packed.baseAddress = slice.getBaseAddress();
+  packed.dim1 = internDim(slice.getDim1());
+  packed.dim0 = internDim(slice.getDim0());
+  slices.push_back(packed);
+}
+
+void EPUProgram::appendCopy(int opCode, ID core, const SliceOperand &src,
+                            const SliceOperand &dst, int dmaToken) {
+  appendInstr(opCode, core, dmaToken, static_cast<uint32_t>(slices.size()));
+  appendSlice(src);
+  appendSlice(dst);
+}
+
+void EPUProgram::appendMatmul(ID core, ID mmUnit, const SliceOperand &sliceA,
+                              const SliceOperand &sliceB,
+                              const SliceOperand &sliceC, bool accumulate) {
+  Instr &instr = appendInstr(OpCode::MATMUL, core, mmUnit,
+                             static_cast<uint32_t>(slices.size()));
+  if (accumulate)
+    instr.flags |= ACCUMULATE;
+  appendSlice(sliceA);
+  appendSlice(sliceB);
+  appendSlice(sliceC);
+}
+
+void EPUProgram::appendMarker(int opCode) { appendInstr(opCode, 0, 0, 0); }
+
+void EPUProgram::appendSync(int opCode, ID core, int semaphore) {
+  appendInstr(opCode, core, semaphore, 0);
+}
+
+void EPUProgram::appendBarrier(const std::vector<ID> &cores) {
+  appendInstr(OpCode::BARRIER, cores.empty() ? 0 : cores.front(),
+              static_cast<int32_t>(cores.size()),
+              static_cast<uint32_t>(barrierCores.size()));
+  barrierCores.insert(barrierCores.end(), cores.begin(), cores.end());
+}
+
+void EPUProgram::appendDMAWait(ID core, int dmaToken) {
+  appendInstr(OpCode::DMA_WAIT, core, dmaToken, 0);
+}
+
+void EPUProgram::append(const Op &op) {
+  switch (op.getOpCode()) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY: {
+    auto &copy = static_cast<const GlobalToLocalMemCopyOp &>(op);
+    appendCopy(OpCode::GLOBAL_TO_LOCAL_MEM_COPY, copy.getCoreNum(),
+               copy.getSrcSlice(), copy.getDstSlice(), copy.getDMAToken());
+    return;
+  }
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY: {
+    auto &copy = static_cast<const LocalToGlobalMemCopyOp &>(op);
+    appendCopy(OpCode::LOCAL_TO_GLOBAL_MEM_COPY, copy.getCoreNum(),
+               copy.getSrcSlice(), copy.getDstSlice(), copy.getDMAToken());
+    return;
+  }
+  case OpCode::MATMUL: {
+    auto &matmul = static_cast<const MatmulOp &>(op);
+    appendMatmul(matmul.getCoreNum(), matmul.getMMUnitNum(),
+                 matmul.getSliceA(), matmul.getSliceB(), matmul.getSliceC(),
+                 matmul.getAccumulate());
+    return;
+  }
+  case OpCode::START_PARALLEL:
+  case OpCode::END_PARALLEL:
+    appendMarker(op.getOpCode());
+    return;
+  case OpCode::SIGNAL:
+    appendSync(OpCode::SIGNAL, op.getCoreNum(),
+               static_cast<const SignalOp &>(op).getSemaphore());
+    return;
+  case OpCode::WAIT:
+    appendSync(OpCode::WAIT, op.getCoreNum(),
+               static_cast<const WaitOp &>(op).getSemaphore());
+    return;
+  case OpCode::BARRIER:
+    appendBarrier(static_cast<const BarrierOp &>(op).getCores());
+    return;
+  case OpCode::DMA_WAIT:
+    appendDMAWait(op.getCoreNum(),
+                  static_cast<const DMAWaitOp &>(op).getDMAToken());
+    return;
+  default:
+    throw std::runtime_error("Unknown opcode " +
+                             std::to_string(op.getOpCode()));
+  }
+}
+
+void EPUProgram::append(const EPUProgram &other) {
+  std::vector<uint32_t> dimMap(other.dims.size());
+  for (size_t i = 0; i < other.dims.size(); ++i)
+    dimMap[i] = internDim(other.dims[i]);
+
+  uint32_t sliceOffset = static_cast<uint32_t>(slices.size());
+  uint32_t coreOffset = static_cast<uint32_t>(barrierCores.size());
+
+  instrs.reserve(instrs.size() + other.instrs.size());
+  for (Instr instr : other.instrs) {
+    switch (instr.opCode) {
+    case OpCode::GLOBAL_TO_LOCAL_MEM_COPY:
+    case OpCode::LOCAL_TO_GLOBAL_MEM_COPY:
+    case OpCode::MATMUL:
+      instr.operands += sliceOffset;
+      break;
+    case OpCode::BARRIER:
+      instr.operands += coreOffset;
+      break;
+    default:
+      break;
+    }
+    instrs.push_back(instr);
+  }
+
+  slices.reserve(slices.size() + other.slices.size());
+  for (PackedSlice slice : other.slices) {
+    slice.dim1 = dimMap[slice.dim1];
+    slice.dim0 = dimMap[slice.dim0];
+    slices.push_back(slice);
+  }
+
+  barrierCores.insert(barrierCores.end(), other.barrierCores.begin(),
+                      other.barrierCores.end());
+}
+
+EPUProgram
+EPUProgram::fromOps(const std::vector<std::unique_ptr<Op>> &ops) {
+  EPUProgram program;
+  program.reserve(ops.size());
+  for (const auto &op : ops)
+    program.append(*op);
+  return program;
+}
+
+// -----------------------------
+// Access
+// -----------------------------
+SliceOperand EPUProgram::getSlice(size_t i, int k) const {
+  const PackedSlice &slice = slices[instrs[i].operands + k];
+  return SliceOperand(slice.baseAddress, dims[slice.dim1], dims[slice.dim0]);
+}
+
+std::vector<ID> EPUProgram::getBarrierCores(size_t i) const {
+  const Instr &instr = instrs[i];
+  auto begin = barrierCores.begin() + instr.operands;
+  return std::vector<ID>(begin, begin + instr.imm);
+}
+
+std::unique_ptr<Op> EPUProgram::getOp(size_t i) const {
+  const Instr &instr = instrs[i];
+  switch (instr.opCode) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY:
+    return std::make_unique<GlobalToLocalMemCopyOp>(
+        instr.core, getSlice(i, 0), getSlice(i, 1), instr.imm);
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY:
+    return std::make_unique<LocalToGlobalMemCopyOp>(
+        instr.core, getSlice(i, 0), getSlice(i, 1), instr.imm);
+  case OpCode::MATMUL:
+    return std::make_unique<MatmulOp>(
+        instr.core, instr.imm, getSlice(i, 0), getSlice(i, 1), getSlice(i, 2),
+        BoolOperand((instr.flags & ACCUMULATE) != 0));
+  case OpCode::START_PARALLEL:
+    return std::make_unique<StartParallelOp>();
+  case OpCode::END_PARALLEL:
+    return std::make_unique<EndParallelOp>();
+  case OpCode::SIGNAL:
+    return std::make_unique<SignalOp>(instr.core, instr.imm);
+  case OpCode::WAIT:
+    return std::make_unique<WaitOp>(instr.core, instr.imm);
+  case OpCode::BARRIER:
+    return std::make_unique<BarrierOp>(getBarrierCores(i));
+  case OpCode::DMA_WAIT:
+    return std::make_unique<DMAWaitOp>(instr.core, instr.imm);
+  default:
+    throw std::runtime_error("Unknown opcode " +
+                             std::to_string(instr.opCode));
+  }
+}
+
+std::vector<std::unique_ptr<Op>> EPUProgram::toOps() const {
+  std::vector<std::unique_ptr<Op>> ops;
+  ops.reserve(instrs.size());
+  for (size_t i = 0; i < instrs.size(); ++i)
+    ops.push_back(getOp(i));
+  return ops;
+}
+
+void EPUProgram::dump() const {
+  for (size_t i = 0; i < instrs.size(); ++i)
+    dump(i);
+}
@@ -1,259 +1,571 @@
 #include "Target/EPU/Parser/EPUAsmParser.h"
 #include "ISA/Op.h"
-#include <fstream>
+#include "Target/EPU/Parser/EPUBinaryFormat.h"
+#include "Utils/MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <functional>
 #include <iostream>
-#include <sstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <vector>
-#include <cstring>
 
 using namespace std;
 
 enum ErrorCode { SUCCESS = 0, FILE_NOT_FOUND, PARSE_ERROR };
 
-// Parsers for each instruction using simple tokenization and regex where
-// helpful
-static bool starts_with(const string &s, const string &pref) {
-  return s.rfind(pref, 0) == 0;
-}
+namespace {
+// Inputs smaller than this are parsed on the calling thread.
+constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+// Chunks per thread, so that a slow chunk does not hold up the others.
+constexpr size_t CHUNKS_PER_THREAD = 4;
+
+// A malformed line. Line numbers are relative to the chunk being parsed until
+// parseBuffer formats the error.
+struct SyntaxError {
+  unsigned lineNo;
+  size_t column;
+  std::string message;
+};
+
+// Cursor over one line of assembly. Every read skips leading blanks and
+// fails with the line and column of the offending character.
+class LineLexer {
+private:
+  std::string_view line;
+  size_t pos = 0;
+  unsigned lineNo;
+
+public:
+  LineLexer(std::string_view line, unsigned lineNo)
+      : line(line), lineNo(lineNo) {}
+
+  [[noreturn]] void fail(const std::string &message) const {
+    throw SyntaxError{lineNo, pos + 1, message};
+  }
 
-// Utility: trim
-static inline string trim(const string &s) {
-  size_t a = s.find_first_not_of(" \t\r\n");
-  if (a == string::npos)
-    return "";
-  size_t b = s.find_last_not_of(" \t\r\n");
-  return s.substr(a, b - a + 1);
-}
+  size_t getColumn() const { return pos + 1; }
 
-// Parse an integer safely
-int EPUAsmParser::parseInt(const string &s) { return stoi(trim(s)); }
-
-// Parse a dimension of form start:end:stride
-Dim EPUAsmParser::parseDim(const string &text) {
-  string t = trim(text);
-  vector<string> parts;
-  string cur;
-  for (char c : t) {
-    if (c == ':') {
-      parts.push_back(cur);
-      cur.clear();
-    } else
-      cur.push_back(c);
-  }
-  parts.push_back(cur);
-  if (parts.size() != 3)
-    throw runtime_error("Invalid dim: " + t);
-
-  return Dim(parseInt(parts[0]), parseInt(parts[1]), parseInt(parts[2]));
-}
+  void skipBlanks() {
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t'))
+      ++pos;
+  }
 
-// Parse a slice of form base[s0:e0:st0, s1:e1:st1]
-SliceOperand EPUAsmParser::parseSlice(const string &text) {
-  // Format: <base_offset, dim1, dim0>
-  // Example: <1024, 0:32:1, 0:32:1>
+  bool atEnd() {
+    skipBlanks();
+    return pos == line.size();
+  }
 
-  string t = trim(text);
-  if (t.front() != '<' || t.back() != '>')
-    throw runtime_error("Slice must be enclosed in < > : " + t);
+  // Describes the next character for error messages.
+  std::string next() {
+    if (atEnd())
+      return "end of line";
+    return "'" + std::string(1, line[pos]) + "'";
+  }
 
-  string inside = t.substr(1, t.size() - 2);
-  vector<string> parts;
-  string cur;
-  int depth = 0;
+  bool tryConsume(char c) {
+    skipBlanks();
+    if (pos < line.size() && line[pos] == c) {
+      ++pos;
+      return true;
+    }
+    return false;
+  }
 
-  for (char c : inside) {
-    if (c == ',' && depth == 0) {
-      parts.push_back(trim(cur));
-      cur.clear();
-    } else
-      cur.push_back(c);
+  void expect(char c) {
+    if (!tryConsume(c))
+      fail(std::string("expected '") + c + "' but found " + next());
   }
-  if (!cur.empty())
-    parts.push_back(trim(cur));
 
-  if (parts.size() != 3)
-    throw runtime_error("Slice requires 3 fields <base, dim1, dim0>: " +
-                        inside);
+  // Letters, digits and underscores.
+  std::string_view readWord() {
+    skipBlanks();
+    size_t begin = pos;
+    while (pos < line.size() &&
+           (isalnum(static_cast<unsigned char>(line[pos])) || line[pos] == '_'))
+      ++pos;
+    if (pos == begin)
+      fail("expected a word but found " + next());
+    return line.substr(begin, pos - begin);
+  }
 
-  // base offset (string or int)
-  auto baseOffset = parseInt(parts[0]);
+  int readInt() {
+    skipBlanks();
+    int value = 0;
+    const char *begin = line.data() + pos;
+    auto [end, error] = from_chars(begin, line.data() + line.size(), value);
+    if (error == errc::result_out_of_range)
+      fail("integer out of range");
+    if (error != errc())
+      fail("expected an integer but found " + next());
+    pos += end - begin;
+    return value;
+  }
 
-  Dim d1 = parseDim(parts[1]);
-  Dim d0 = parseDim(parts[2]);
+  void expectEnd(std::string_view mnemonic) {
+    if (!atEnd())
+      fail("unexpected " + next() + " after " + std::string(mnemonic) +
+           " operands");
+  }
 
-  return SliceOperand(baseOffset, d1, d0);
-}
+  // start:end:stride
+  Dim readDim() {
+    int start = readInt();
+    expect(':');
+    int end = readInt();
+    expect(':');
+    int stride = readInt();
+    return Dim(start, end, stride);
+  }
+
+  // <base, dim1, dim0>
+  SliceOperand readSlice() {
+    expect('<');
+    int base = readInt();
+    expect(',');
+    Dim dim1 = readDim();
+    expect(',');
+    Dim dim0 = readDim();
+    expect('>');
+    return SliceOperand(base, dim1, dim0);
+  }
 
-GlobalToLocalMemCopyOp
-EPUAsmParser::parseGlobalToLocalMemCopy(const std::string &line) {
-  // remove prefix
-  string rest = trim(line.substr(strlen("cp_global_to_local")));
-  // we need three comma-separated top-level fields: <src>, <core>, <dst>
-  vector<string> parts;
-  string cur;
-  int depth = 0;
-  for (size_t i = 0; i < rest.size(); ++i) {
-    char c = rest[i];
-    if (c == '<')
-      depth++;
-    if (c == '>')
-      depth--;
-    if (c == ',' && depth == 0) {
-      parts.push_back(cur);
-      cur.clear();
-      continue;
+  int readDMAToken() {
+    skipBlanks();
+    size_t tokenPos = pos;
+    int token = readInt();
+    if (token < 0) {
+      pos = tokenPos;
+      fail("DMA token must not be negative");
     }
-    cur.push_back(c);
+    return token;
   }
 
-  if (!cur.empty())
-    parts.push_back(cur);
-  if (parts.size() != 3)
-    throw runtime_error("cp_global_to_local parse failed: " + rest);
+  // accumulator=True|False
+  bool readAccumulator() {
+    if (readWord() != "accumulator")
+      fail("expected accumulator=True or accumulator=False");
+    expect('=');
+    skipBlanks();
+    size_t valuePos = pos;
+    std::string_view value = readWord();
+    if (value == "True" || value == "true")
+      return true;
+    if (value == "False" || value == "false")
+      return false;
+    pos = valuePos;
+    fail("invalid accumulator value '" + std::string(value) + "'");
+  }
+};
+
+// Appends parsed ops to a std::vector<std::unique_ptr<Op>>. EPUProgram is
+// appended to directly through the same interface.
+struct OpListBuilder {
+  static constexpr ID MIN_CORE = std::numeric_limits<ID>::min();
+  static constexpr ID MAX_CORE = std::numeric_limits<ID>::max();
+
+  std::vector<std::unique_ptr<Op>> &ops;
+
+  void appendCopy(int opCode, ID core, const SliceOperand &src,
+                  const SliceOperand &dst, int dmaToken) {
+    if (opCode == OpCode::GLOBAL_TO_LOCAL_MEM_COPY)
+      ops.push_back(
+          std::make_unique<GlobalToLocalMemCopyOp>(core, src, dst, dmaToken));
+    else
+      ops.push_back(
+          std::make_unique<LocalToGlobalMemCopyOp>(core, src, dst, dmaToken));
+  }
+
+  void appendMatmul(ID core, ID mmUnit, const SliceOperand &sliceA,
+                    const SliceOperand &sliceB, const SliceOperand &sliceC,
+                    bool accumulate) {
+    ops.push_back(std::make_unique<MatmulOp>(core, mmUnit, sliceA, sliceB,
+                                             sliceC, BoolOperand(accumulate)));
+  }
+
+  void appendMarker(int opCode) {
+    if (opCode == OpCode::START_PARALLEL)
+      ops.push_back(std::make_unique<StartParallelOp>());
+    else
+      ops.push_back(std::make_unique<EndParallelOp>());
+  }
+
+  void appendSync(int opCode, ID core, int semaphore) {
+    if (opCode == OpCode::SIGNAL)
+      ops.push_back(std::make_unique<SignalOp>(core, semaphore));
+    else
+      ops.push_back(std::make_unique<WaitOp>(core, semaphore));
+  }
+
+  void appendBarrier(std::vector<ID> &cores) {
+    ops.push_back(std::make_unique<BarrierOp>(std::move(cores)));
+  }
 
-  auto src = parseSlice(parts[0]);
-  int core = parseInt(parts[1]);
-  auto dst = parseSlice(parts[2]);
+  void appendDMAWait(ID core, int dmaToken) {
+    ops.push_back(std::make_unique<DMAWaitOp>(core, dmaToken));
+  }
+};
 
-  return GlobalToLocalMemCopyOp(core, src, dst);
+OpListBuilder builderFor(std::vector<std::unique_ptr<Op>> &ops) {
+  return OpListBuilder{ops};
 }
 
-LocalToGlobalMemCopyOp
-EPUAsmParser::parseLocalToGlobalMemCopy(const std::string &line) {
-  // remove prefix
-  string rest = trim(line.substr(strlen("cp_local_to_global")));
-  // we need three comma-separated top-level fields: <core>, <src>, <dst>
-  vector<string> parts;
-  string cur;
-  int depth = 0;
-  for (size_t i = 0; i < rest.size(); ++i) {
-    char c = rest[i];
-    if (c == '<')
-      depth++;
-    if (c == '>')
-      depth--;
-    if (c == ',' && depth == 0) {
-      parts.push_back(cur);
-      cur.clear();
-      continue;
+EPUProgram &builderFor(EPUProgram &program) { return program; }
+
+// Parses one line into `out`. Returns the opcode of the op appended, or -1
+// for a blank line.
+template <typename Builder>
+int parseLine(std::string_view line, unsigned lineNo, Builder &&out) {
+  using Limits = std::decay_t<Builder>;
+  LineLexer lex(line, lineNo);
+  if (lex.atEnd())
+    return -1;
+
+  auto readCore = [&]() {
+    lex.skipBlanks();
+    size_t corePos = lex.getColumn();
+    int core = lex.readInt();
+    if (core < Limits::MIN_CORE || core > Limits::MAX_CORE)
+      throw SyntaxError{lineNo, corePos, "core out of range"};
+    return core;
+  };
+
+  std::string_view mnemonic = lex.readWord();
+
+  if (mnemonic == "cp_global_to_local" ||
+      mnemonic == "cp_global_to_local_async") {
+    // <src>, <core>, <dst>[, <token>]
+    SliceOperand src = lex.readSlice();
+    lex.expect(',');
+    int core = readCore();
+    lex.expect(',');
+    SliceOperand dst = lex.readSlice();
+    int token = -1;
+    if (mnemonic.size() > strlen("cp_global_to_local")) {
+      lex.expect(',');
+      token = lex.readDMAToken();
+    }
+    lex.expectEnd(mnemonic);
+    out.appendCopy(OpCode::GLOBAL_TO_LOCAL_MEM_COPY, core, src, dst, token);
+    return OpCode::GLOBAL_TO_LOCAL_MEM_COPY;
+  }
+  if (mnemonic == "cp_local_to_global" ||
+      mnemonic == "cp_local_to_global_async") {
+    // <core>, <src>, <dst>[, <token>]
+    int core = readCore();
+    lex.expect(',');
+    SliceOperand src = lex.readSlice();
+    lex.expect(',');
+    SliceOperand dst = lex.readSlice();
+    int token = -1;
+    if (mnemonic.size() > strlen("cp_local_to_global")) {
+      lex.expect(',');
+      token = lex.readDMAToken();
     }
-    cur.push_back(c);
+    lex.expectEnd(mnemonic);
+    out.appendCopy(OpCode::LOCAL_TO_GLOBAL_MEM_COPY, core, src, dst, token);
+    return OpCode::LOCAL_TO_GLOBAL_MEM_COPY;
+  }
+  if (mnemonic == "matmul") {
+    // <core>, <mm_unit>, <sliceA>, <sliceB>, <sliceC>, accumulator=<bool>
+    int core = readCore();
+    lex.expect(',');
+    int mmUnit = lex.readInt();
+    lex.expect(',');
+    SliceOperand sliceA = lex.readSlice();
+    lex.expect(',');
+    SliceOperand sliceB = lex.readSlice();
+    lex.expect(',');
+    SliceOperand sliceC = lex.readSlice();
+    lex.expect(',');
+    bool accumulate = lex.readAccumulator();
+    lex.expectEnd(mnemonic);
+    out.appendMatmul(core, mmUnit, sliceA, sliceB, sliceC, accumulate);
+    return OpCode::MATMUL;
+  }
+  if (mnemonic == "start_parallel" || mnemonic == "end_parallel") {
+    lex.expectEnd(mnemonic);
+    int opCode = mnemonic == "start_parallel" ? OpCode::START_PARALLEL
+                                              : OpCode::END_PARALLEL;
+    out.appendMarker(opCode);
+    return opCode;
+  }
+  if (mnemonic == "signal" || mnemonic == "wait") {
+    // <core>, <semaphore>
+    int core = readCore();
+    lex.expect(',');
+    int semaphore = lex.readInt();
+    lex.expectEnd(mnemonic);
+    int opCode = mnemonic == "signal" ? OpCode::SIGNAL : OpCode::WAIT;
+    out.appendSync(opCode, core, semaphore);
+    return opCode;
+  }
+  if (mnemonic == "dma_wait") {
+    // <core>, <token>
+    int core = readCore();
+    lex.expect(',');
+    int token = lex.readDMAToken();
+    lex.expectEnd(mnemonic);
+    out.appendDMAWait(core, token);
+    return OpCode::DMA_WAIT;
+  }
+  if (mnemonic == "barrier") {
+    // <core>, <core>, ...
+    std::vector<ID> cores;
+    do
+      cores.push_back(readCore());
+    while (lex.tryConsume(','));
+    lex.expectEnd(mnemonic);
+    out.appendBarrier(cores);
+    return OpCode::BARRIER;
   }
 
-  if (!cur.empty())
-    parts.push_back(cur);
-  if (parts.size() != 3)
-    throw runtime_error("cp_local_to_global parse failed: " + rest);
+  LineLexer at(line, lineNo);
+  at.skipBlanks();
+  at.fail("unknown instruction '" + std::string(mnemonic) + "'");
+}
 
-  auto core = parseInt(parts[0]);
-  auto src = parseSlice(parts[1]);
-  auto dst = parseSlice(parts[2]);
+// Removes the first line of `text` and returns it without its line ending.
+std::string_view takeLine(std::string_view &text) {
+  size_t newline = text.find('\n');
+  std::string_view line = text.substr(0, newline);
+  text.remove_prefix(newline == std::string_view::npos ? text.size()
+                                                       : newline + 1);
+  if (!line.empty() && line.back() == '\r')
+    line.remove_suffix(1);
+  return line;
+}
 
-  return LocalToGlobalMemCopyOp(core, src, dst);
+// Column of the first non-blank character of `line`.
+size_t firstColumn(std::string_view line) {
+  LineLexer lex(line, 0);
+  lex.skipBlanks();
+  return lex.getColumn();
 }
 
-MatmulOp EPUAsmParser::parseMatmul(const std::string &line) {
-  // remove prefix
-  string rest = trim(line.substr(strlen("matmul")));
-  // we need five comma-separated top-level fields:
-  // <core>, <mm_unit>, <sliceA>, <sliceB>, <sliceC>, <accumulate = True/False>
-  vector<string> parts;
-  string cur;
-  int depth = 0;
-  for (size_t i = 0; i < rest.size(); ++i) {
-    char c = rest[i];
-    if (c == '<')
-      depth++;
-    if (c == '>')
-      depth--;
-    if (c == ',' && depth == 0) {
-      parts.push_back(cur);
-      cur.clear();
-      continue;
-    }
-    cur.push_back(c);
-  }
-
-  if (!cur.empty())
-    parts.push_back(cur);
-  if (parts.size() != 6)
-    throw runtime_error("matmul parse failed: " + rest);
-
-  auto core = parseInt(parts[0]);
-  auto mmUnit = parseInt(parts[1]);
-  auto sliceA = parseSlice(parts[2]);
-  auto sliceB = parseSlice(parts[3]);
-  auto sliceC = parseSlice(parts[4]);
-
-  auto acc_pos = parts[5].find("accumulator=");
-  if (acc_pos == string::npos)
-    throw runtime_error("matmul missing accumulator spec");
-  string head = trim(parts[5].substr(0, acc_pos));
-  string acc_str = trim(parts[5].substr(acc_pos + 12)); // after "accumulator="
-  bool acc = false;
-  if (acc_str == "True" || acc_str == "true")
-    acc = true;
-  else if (acc_str == "False" || acc_str == "false")
-    acc = false;
-  else
-    throw runtime_error("Invalid accumulator: " + acc_str);
-
-  return MatmulOp(core, mmUnit, sliceA, sliceB, sliceC, BoolOperand(acc));
+// Checks that parallel regions are closed and do not nest, given their
+// markers in program order.
+class RegionChecker {
+private:
+  unsigned openLine = 0;
+  size_t openColumn = 0;
+
+public:
+  void mark(unsigned lineNo, size_t column, bool isStart) {
+    if (isStart && openLine)
+      throw SyntaxError{lineNo, column,
+                        "start_parallel inside the parallel region opened "
+                        "on line " +
+                            to_string(openLine)};
+    if (!isStart && !openLine)
+      throw SyntaxError{lineNo, column, "end_parallel without start_parallel"};
+    openLine = isStart ? lineNo : 0;
+    openColumn = column;
+  }
+
+  void finish() const {
+    if (openLine)
+      throw SyntaxError{openLine, openColumn,
+                        "start_parallel without end_parallel"};
+  }
+};
+
+runtime_error formatError(const std::string &sourceName,
+                          const SyntaxError &error) {
+  return runtime_error(sourceName + ":" + to_string(error.lineNo) + ":" +
+                       to_string(error.column) + ": " + error.message);
 }
 
-StartParallelOp EPUAsmParser::parseStartParallel(const std::string &line) {
-  string rest = trim(line.substr(strlen("start_parallel")));
-  if (!rest.empty())
-    throw runtime_error("start_parallel takes no arguments");
+bool isParallelMarker(int opCode) {
+  return opCode == OpCode::START_PARALLEL || opCode == OpCode::END_PARALLEL;
+}
 
-  return StartParallelOp();
+// Ops of a run of whole lines, and where its parallel markers are.
+template <typename Program> struct ParsedChunk {
+  Program ops;
+  unsigned numLines = 0;
+  // Line, column and kind (true for start_parallel) of each marker.
+  std::vector<std::tuple<unsigned, size_t, bool>> markers;
+  std::optional<SyntaxError> error;
+};
+
+template <typename Program>
+void parseChunk(std::string_view text, ParsedChunk<Program> &chunk) {
+  try {
+    while (!text.empty()) {
+      std::string_view line = takeLine(text);
+      int opCode = parseLine(line, ++chunk.numLines, builderFor(chunk.ops));
+      if (isParallelMarker(opCode))
+        chunk.markers.emplace_back(chunk.numLines, firstColumn(line),
+                                   opCode == OpCode::START_PARALLEL);
+    }
+  } catch (const SyntaxError &error) {
+    chunk.error = error;
+  }
 }
 
-EndParallelOp EPUAsmParser::parseEndParallel(const std::string &line) {
-  string rest = trim(line.substr(strlen("end_parallel")));
-  if (!rest.empty())
-    throw runtime_error("end_parallel takes no arguments");
+// Parses `text` in chunks of whole lines on up to `numThreads` threads, the
+// extra ones from `pool`, and checks the chunks in order. The ops of each
+// chunk are left for the caller to concatenate.
+template <typename Program>
+std::vector<ParsedChunk<Program>>
+parseChunks(std::string_view text, const std::string &sourceName,
+            unsigned numThreads, std::unique_ptr<EPUThreadPool> &pool) {
+  // Cut the text into chunks of whole lines.
+  size_t numChunks = std::min<size_t>(text.size() / MIN_CHUNK_BYTES,
+                                      numThreads * CHUNKS_PER_THREAD);
+  std::vector<std::string_view> pieces;
+  while (pieces.size() + 1 < numChunks) {
+    size_t target = text.size() / (numChunks - pieces.size());
+    size_t newline = text.find('\n', target);
+    if (newline == std::string_view::npos)
+      break;
+    pieces.push_back(text.substr(0, newline + 1));
+    text.remove_prefix(newline + 1);
+  }
+  pieces.push_back(text);
+
+  std::vector<ParsedChunk<Program>> chunks(pieces.size());
+  if (pieces.size() == 1) {
+    parseChunk(pieces[0], chunks[0]);
+  } else {
+    // The calling thread parses chunks too while it waits.
+    if (!pool)
+      pool = std::make_unique<EPUThreadPool>(numThreads - 1);
+    EPUTaskGroup group;
+    for (size_t i = 0; i < pieces.size(); ++i)
+      pool->submit(group, [&, i]() { parseChunk(pieces[i], chunks[i]); });
+    pool->wait(group);
+  }
 
-  return EndParallelOp();
+  // Parallel regions may span chunks, so their nesting is only checked here.
+  try {
+    RegionChecker regions;
+    unsigned firstLine = 0;
+    for (ParsedChunk<Program> &chunk : chunks) {
+      for (auto [lineNo, column, isStart] : chunk.markers)
+        regions.mark(firstLine + lineNo, column, isStart);
+
+      // Markers always precede the line that stopped a chunk.
+      if (chunk.error) {
+        chunk.error->lineNo += firstLine;
+        throw *chunk.error;
+      }
+
+      firstLine += chunk.numLines;
+    }
+    regions.finish();
+  } catch (const SyntaxError &error) {
+    throw formatError(sourceName, error);
+  }
+  return chunks;
+}
+} // namespace
+
+void EPUAsmParser::setNumThreads(unsigned threads) {
+  numThreads = std::max(threads, 1u);
+  pool.reset();
 }
 
 std::vector<std::unique_ptr<Op>>
-EPUAsmParser::parseFile(const std::string &filename) {
+EPUAsmParser::parseBuffer(std::string_view text,
+                          const std::string &sourceName) {
+  auto chunks = parseChunks<std::vector<std::unique_ptr<Op>>>(
+      text, sourceName, numThreads, pool);
+  if (chunks.size() == 1)
+    return std::move(chunks[0].ops);
+
+  size_t numOps = 0;
+  for (auto &chunk : chunks)
+    numOps += chunk.ops.size();
+
   std::vector<std::unique_ptr<Op>> parsedOps;
+  parsedOps.reserve(numOps);
+  for (auto &chunk : chunks)
+    std::move(chunk.ops.begin(), chunk.ops.end(),
+              std::back_inserter(parsedOps));
+  return parsedOps;
+}
+
+EPUProgram EPUAsmParser::parseProgram(std::string_view text,
+                                      const std::string &sourceName) {
+  auto chunks = parseChunks<EPUProgram>(text, sourceName, numThreads, pool);
+  if (chunks.size() == 1)
+    return std::move(chunks[0].ops);
+
+  size_t numOps = 0;
+  for (auto &chunk : chunks)
+    numOps += chunk.ops.size();
+
+  EPUProgram program;
+  program.reserve(numOps);
+  for (auto &chunk : chunks)
+    program.append(chunk.ops);
+  return program;
+}
+
+void EPUAsmParser::parseStream(
+    std::string_view text, const std::string &sourceName,
+    const std::function<void(std::unique_ptr<Op>)> &consume) {
+  std::vector<std::unique_ptr<Op>> lineOps;
+  try {
+    RegionChecker regions;
+    unsigned lineNo = 0;
+    while (!text.empty()) {
+      std::string_view line = takeLine(text);
+      int opCode = parseLine(line, ++lineNo, OpListBuilder{lineOps});
+      if (lineOps.empty())
+        continue;
+
+      if (isParallelMarker(opCode))
+        regions.mark(lineNo, firstColumn(line),
+                     opCode == OpCode::START_PARALLEL);
+      consume(std::move(lineOps.back()));
+      lineOps.clear();
+    }
+    regions.finish();
+  } catch (const SyntaxError &error) {
+    throw formatError(sourceName, error);
+  }
+}
 
-  std::ifstream fin(filename);
-  if (!fin.is_open()) {
+std::vector<std::unique_ptr<Op>>
+EPUAsmParser::parseFile(const std::string &filename) {
+  MappedFile file;
+  try {
+    file = MappedFile(filename);
+  } catch (const std::runtime_error &) {
     exit(ErrorCode::FILE_NOT_FOUND);
   }
 
-  std::string line;
-  while (true) {
-    if (!std::getline(fin, line))
-      break;
-    std::string s = trim(line);
-    if (s.empty())
-      continue;
-
-    if (starts_with(s, "cp_global_to_local")) {
-      auto instr = parseGlobalToLocalMemCopy(s);
-      parsedOps.push_back(std::make_unique<GlobalToLocalMemCopyOp>(instr));
-    } else if (starts_with(s, "cp_local_to_global")) {
-      auto instr = parseLocalToGlobalMemCopy(s);
-      parsedOps.push_back(std::make_unique<LocalToGlobalMemCopyOp>(instr));
-    } else if (starts_with(s, "matmul")) {
-      auto instr = parseMatmul(s);
-      parsedOps.push_back(std::make_unique<MatmulOp>(instr));
-    } else if (starts_with(s, "start_parallel")) {
-      auto instr = parseStartParallel(s);
-      parsedOps.push_back(std::make_unique<StartParallelOp>(instr));
-    } else if (starts_with(s, "end_parallel")) {
-      auto instr = parseEndParallel(s);
-      parsedOps.push_back(std::make_unique<EndParallelOp>(instr));
-    } else {
-      exit(ErrorCode::PARSE_ERROR);
-    }
+  // Programs converted with epu_convert are loaded without lexing.
+  if (isEPUBinary(file.getData(), file.getSize()))
+    return loadEPUBinary(file.getData(), file.getSize(), filename);
+
+  std::string_view text(reinterpret_cast<const char *>(file.getData()),
+                        file.getSize());
+  return parseBuffer(text, filename);
+}
+
+EPUProgram EPUAsmParser::parseProgramFile(const std::string &filename) {
+  MappedFile file(filename);
+  const uint8_t *data = file.getData();
+  size_t size = file.getSize();
+
+  if (isEPUBinary(data, size)) {
+    EPUProgram program;
+    streamEPUBinary(data, size, filename,
+                    [&](std::unique_ptr<Op> op) { program.append(*op); });
+    return program;
   }
 
-  return parsedOps;
+  return parseProgram(
+      std::string_view(reinterpret_cast<const char *>(data), size), filename);
 }
@@ -0,0 +1,323 @@
+#include "Target/EPU/Parser/EPUBinaryFormat.h"
+#include "Utils/MappedFile.h"
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+void storeSlice(const SliceOperand &slice, int32_t *words) {
+  const Dim &dim1 = slice.getDim1();
+  const Dim &dim0 = slice.getDim0();
+  words[0] = slice.getBaseAddress();
+  words[1] = dim1.getStart();
+  words[2] = dim1.getEnd();
+  words[3] = dim1.getStride();
+  words[4] = dim0.getStart();
+  words[5] = dim0.getEnd();
+  words[6] = dim0.getStride();
+}
+
+SliceOperand loadSlice(const int32_t *words) {
+  return SliceOperand(words[0], Dim(words[1], words[2], words[3]),
+                      Dim(words[4], words[5], words[6]));
+}
+
+EPUBinaryRecord encodeOp(const Op &op, size_t index) {
+  EPUBinaryRecord record;
+  std::memset(&record, 0, sizeof(record));
+  record.opCode = static_cast<uint16_t>(op.getOpCode());
+  record.core = op.getCoreNum();
+  record.dmaToken = -1;
+
+  int32_t *operands = record.operands;
+  switch (op.getOpCode()) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY: {
+    auto &copy = static_cast<const GlobalToLocalMemCopyOp &>(op);
+    storeSlice(copy.getSrcSlice(), operands);
+    storeSlice(copy.getDstSlice(), operands + EPUBinaryRecord::SLICE_WORDS);
+    record.dmaToken = copy.getDMAToken();
+    break;
+  }
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY: {
+    auto &copy = static_cast<const LocalToGlobalMemCopyOp &>(op);
+    storeSlice(copy.getSrcSlice(), operands);
+    storeSlice(copy.getDstSlice(), operands + EPUBinaryRecord::SLICE_WORDS);
+    record.dmaToken = copy.getDMAToken();
+    break;
+  }
+  case OpCode::MATMUL: {
+    auto &mm = static_cast<const MatmulOp &>(op);
+    record.imm = mm.getMMUnitNum();
+    if (mm.getAccumulate())
+      record.flags |= EPUBinaryRecord::ACCUMULATE;
+    storeSlice(mm.getSliceA(), operands);
+    storeSlice(mm.getSliceB(), operands + EPUBinaryRecord::SLICE_WORDS);
+    storeSlice(mm.getSliceC(), operands + 2 * EPUBinaryRecord::SLICE_WORDS);
+    break;
+  }
+  case OpCode::START_PARALLEL:
+  case OpCode::END_PARALLEL:
+    break;
+  case OpCode::SIGNAL:
+    record.imm = static_cast<const SignalOp &>(op).getSemaphore();
+    break;
+  case OpCode::WAIT:
+    record.imm = static_cast<const WaitOp &>(op).getSemaphore();
+    break;
+  case OpCode::BARRIER: {
+    auto &cores = static_cast<const BarrierOp &>(op).getCores();
+    if (cores.size() > EPUBinaryRecord::OPERAND_WORDS)
+      throw std::runtime_error("Op " + std::to_string(index) +
+                               ": barrier has more than " +
+                               std::to_string(EPUBinaryRecord::OPERAND_WORDS) +
+                               " cores");
+    record.imm = static_cast<int32_t>(cores.size());
+    for (size_t i = 0; i < cores.size(); ++i)
+      operands[i] = cores[i];
+    break;
+  }
+  case OpCode::DMA_WAIT:
+    record.dmaToken = static_cast<const DMAWaitOp &>(op).getDMAToken();
+    break;
+  default:
+    throw std::runtime_error("Op " + std::to_string(index) +
+                             ": no binary encoding for opcode " +
+                             std::to_string(op.getOpCode()));
+  }
+  return record;
+}
+
+std::unique_ptr<Op> decodeRecord(const EPUBinaryRecord &record,
+                                 const std::string &sourceName,
+                                 uint64_t index) {
+  auto fail = [&](const std::string &message) {
+    throw std::runtime_error(sourceName + ": record " + std::to_string(index) +
+                             ": " + message);
+  };
+
+  if (record.flags & ~EPUBinaryRecord::ACCUMULATE)
+    fail("unknown flags " + std::to_string(record.flags));
+  if ((record.flags & EPUBinaryRecord::ACCUMULATE) &&
+      record.opCode != OpCode::MATMUL)
+    fail("accumulate flag on a non-matmul op");
+
+  const int32_t *operands = record.operands;
+  const int32_t *second = operands + EPUBinaryRecord::SLICE_WORDS;
+  switch (record.opCode) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY:
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY:
+    if (record.dmaToken < -1)
+      fail("DMA token must not be negative");
+    if (record.opCode == OpCode::GLOBAL_TO_LOCAL_MEM_COPY)
+      return std::make_unique<GlobalToLocalMemCopyOp>(
+          record.core, loadSlice(operands), loadSlice(second),
+          record.dmaToken);
+    return std::make_unique<LocalToGlobalMemCopyOp>(
+        record.core, loadSlice(operands), loadSlice(second), record.dmaToken);
+  case OpCode::MATMUL:
+    return std::make_unique<MatmulOp>(
+        record.core, record.imm, loadSlice(operands), loadSlice(second),
+        loadSlice(second + EPUBinaryRecord::SLICE_WORDS),
+        BoolOperand(record.flags & EPUBinaryRecord::ACCUMULATE));
+  case OpCode::START_PARALLEL:
+    return std::make_unique<StartParallelOp>();
+  case OpCode::END_PARALLEL:
+    return std::make_unique<EndParallelOp>();
+  case OpCode::SIGNAL:
+    return std::make_unique<SignalOp>(record.core, record.imm);
+  case OpCode::WAIT:
+    return std::make_unique<WaitOp>(record.core, record.imm);
+  case OpCode::BARRIER:
+    if (record.imm < 1 || record.imm > EPUBinaryRecord::OPERAND_WORDS)
+      fail("invalid barrier core count " + std::to_string(record.imm));
+    return std::make_unique<BarrierOp>(
+        std::vector<ID>(operands, operands + record.imm));
+  case OpCode::DMA_WAIT:
+    if (record.dmaToken < 0)
+      fail("DMA token must not be negative");
+    return std::make_unique<DMAWaitOp>(record.core, record.dmaToken);
+  default:
+    fail("unknown opcode " + std::to_string(record.opCode));
+  }
+  return nullptr;
+}
+
+void printSlice(std::ostream &os, const SliceOperand &slice) {
+  const Dim &dim1 = slice.getDim1();
+  const Dim &dim0 = slice.getDim0();
+  os << "<" << slice.getBaseAddress() << ", " << dim1.getStart() << ":"
+     << dim1.getEnd() << ":" << dim1.getStride() << ", " << dim0.getStart()
+     << ":" << dim0.getEnd() << ":" << dim0.getStride() << ">";
+}
+} // namespace
+
+// -----------------------------
+// Loading
+// -----------------------------
+
+bool isEPUBinary(const uint8_t *data, size_t size) {
+  return size >= sizeof(EPU_BINARY_MAGIC) &&
+         std::memcmp(data, EPU_BINARY_MAGIC, sizeof(EPU_BINARY_MAGIC)) == 0;
+}
+
+// Validates the header of a binary program and returns its record count.
+static uint64_t checkHeader(const uint8_t *data, size_t size,
+                            const std::string &sourceName) {
+  if (!isEPUBinary(data, size) || size < sizeof(EPUBinaryHeader))
+    throw std::runtime_error(sourceName + ": not an EPU binary program");
+
+  EPUBinaryHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.version != EPU_BINARY_VERSION)
+    throw std::runtime_error(sourceName + ": unsupported version " +
+                             std::to_string(header.version));
+  if (header.recordSize != sizeof(EPUBinaryRecord))
+    throw std::runtime_error(sourceName + ": unexpected record size " +
+                             std::to_string(header.recordSize));
+
+  size_t payload = size - sizeof(header);
+  if (payload % sizeof(EPUBinaryRecord) != 0 ||
+      payload / sizeof(EPUBinaryRecord) != header.numRecords)
+    throw std::runtime_error(sourceName + ": size does not match " +
+                             std::to_string(header.numRecords) + " records");
+  return header.numRecords;
+}
+
+// The mapping need not be aligned for the record.
+static EPUBinaryRecord readRecord(const uint8_t *data, uint64_t index) {
+  EPUBinaryRecord record;
+  std::memcpy(&record,
+              data + sizeof(EPUBinaryHeader) + index * sizeof(record),
+              sizeof(record));
+  return record;
+}
+
+std::vector<std::unique_ptr<Op>> loadEPUBinary(const uint8_t *data,
+                                               size_t size,
+                                               const std::string &sourceName) {
+  uint64_t numRecords = checkHeader(data, size, sourceName);
+
+  std::vector<std::unique_ptr<Op>> ops;
+  ops.reserve(numRecords);
+  for (uint64_t i = 0; i < numRecords; ++i)
+    ops.push_back(decodeRecord(readRecord(data, i), sourceName, i));
+  return ops;
+}
+
+void streamEPUBinary(const uint8_t *data, size_t size,
+                     const std::string &sourceName,
+                     const std::function<void(std::unique_ptr<Op>)> &consume) {
+  uint64_t numRecords = checkHeader(data, size, sourceName);
+  for (uint64_t i = 0; i < numRecords; ++i)
+    consume(decodeRecord(readRecord(data, i), sourceName, i));
+}
+
+std::vector<std::unique_ptr<Op>>
+loadEPUBinaryFile(const std::string &filename) {
+  MappedFile file(filename);
+  return loadEPUBinary(file.getData(), file.getSize(), filename);
+}
+
+// -----------------------------
+// Writing
+// -----------------------------
+
+void writeEPUBinary(const std::vector<std::unique_ptr<Op>> &ops,
+                    std::ostream &os) {
+  EPUBinaryHeader header;
+  std::memcpy(header.magic, EPU_BINARY_MAGIC, sizeof(header.magic));
+  header.version = EPU_BINARY_VERSION;
+  header.recordSize = sizeof(EPUBinaryRecord);
+  header.numRecords = ops.size();
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  for (size_t i = 0; i < ops.size(); ++i) {
+    EPUBinaryRecord record = encodeOp(*ops[i], i);
+    os.write(reinterpret_cast<const char *>(&record), sizeof(record));
+  }
+}
+
+void writeEPUBinaryFile(const std::vector<std::unique_ptr<Op>> &ops,
+                        const std::string &filename) {
+  std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+  if (!ofs.is_open())
+    throw std::runtime_error("Cannot open file: " + filename);
+  writeEPUBinary(ops, ofs);
+  if (!ofs.flush())
+    throw std::runtime_error("Cannot write file: " + filename);
+}
+
+void writeEPUAsm(const std::vector<std::unique_ptr<Op>> &ops,
+                 std::ostream &os) {
+  for (const auto &op : ops) {
+    switch (op->getOpCode()) {
+    case OpCode::GLOBAL_TO_LOCAL_MEM_COPY: {
+      auto &copy = static_cast<const GlobalToLocalMemCopyOp &>(*op);
+      os << (copy.isAsync() ? "cp_global_to_local_async "
+                            : "cp_global_to_local ");
+      printSlice(os, copy.getSrcSlice());
+      os << ", " << copy.getCoreNum() << ", ";
+      printSlice(os, copy.getDstSlice());
+      if (copy.isAsync())
+        os << ", " << copy.getDMAToken();
+      break;
+    }
+    case OpCode::LOCAL_TO_GLOBAL_MEM_COPY: {
+      auto &copy = static_cast<const LocalToGlobalMemCopyOp &>(*op);
+      os << (copy.isAsync() ? "cp_local_to_global_async "
+                            : "cp_local_to_global ")
+         << copy.getCoreNum() << ", ";
+      printSlice(os, copy.getSrcSlice());
+      os << ", ";
+      printSlice(os, copy.getDstSlice());
+      if (copy.isAsync())
+        os << ", " << copy.getDMAToken();
+      break;
+    }
+    case OpCode::MATMUL: {
+      auto &mm = static_cast<const MatmulOp &>(*op);
+      os << "matmul " << mm.getCoreNum() << ", " << mm.getMMUnitNum() << ", ";
+      printSlice(os, mm.getSliceA());
+      os << ", ";
+      printSlice(os, mm.getSliceB());
+      os << ", ";
+      printSlice(os, mm.getSliceC());
+      os << ", accumulator=" << (mm.getAccumulate() ? "True" : "False");
+      break;
+    }
+    case OpCode::START_PARALLEL:
+      os << "start_parallel";
+      break;
+    case OpCode::END_PARALLEL:
+      os << "end_parallel";
+      break;
+    case OpCode::SIGNAL:
+      os << "signal " << op->getCoreNum() << ", "
+         << static_cast<const SignalOp &>(*op).getSemaphore();
+      break;
+    case OpCode::WAIT:
+      os << "wait " << op->getCoreNum() << ", "
+         << static_cast<const WaitOp &>(*op).getSemaphore();
+      break;
+    case OpCode::BARRIER: {
+      const char *separator = "barrier ";
+      for (ID core : static_cast<const BarrierOp &>(*op).getCores()) {
+        os << separator << core;
+        separator = ", ";
+      }
+      break;
+    }
+    case OpCode::DMA_WAIT:
+      os << "dma_wait " << op->getCoreNum() << ", "
+         << static_cast<const DMAWaitOp &>(*op).getDMAToken();
+      break;
+    default:
+      throw std::runtime_error("No assembly for opcode " +
+                               std::to_string(op->getOpCode()));
+    }
+    os << "\n";
+  }
+}
@@ -0,0 +1,212 @@
+#include "Target/EPU/Simulator/EPUBatch.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+
+EPULocalMemoryView::EPULocalMemoryView(size_t size) : size(size) {
+  if (size == 0)
+    return;
+
+  void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapping == MAP_FAILED)
+    throw std::runtime_error("Failed to reserve local memory view");
+  base = static_cast<uint8_t *>(mapping);
+}
+
+EPULocalMemoryView::~EPULocalMemoryView() {
+  if (base)
+    munmap(base, size);
+}
+
+void EPULocalMemoryView::clear() {
+  // Dropped anonymous pages read back as zero.
+  if (base)
+    madvise(base, size, MADV_DONTNEED);
+}
+
+template <typename Binding>
+static const Binding *findBinding(const std::vector<Binding> &bindings,
+                                  int handleId) {
+  for (const Binding &binding : bindings)
+    if (binding.handleId == handleId)
+      return &binding;
+  return nullptr;
+}
+
+EPULocalMemoryView *EPUSimulator::acquireBatchView() {
+  std::lock_guard<std::mutex> lock(batchViewMutex);
+  if (!freeBatchViews.empty()) {
+    EPULocalMemoryView *view = freeBatchViews.back();
+    freeBatchViews.pop_back();
+    return view;
+  }
+
+  batchViews.push_back(std::make_unique<EPULocalMemoryView>(
+      numberOfCores * localRegionStride));
+  return batchViews.back().get();
+}
+
+void EPUSimulator::releaseBatchView(EPULocalMemoryView *view) {
+  view->clear();
+  std::lock_guard<std::mutex> lock(batchViewMutex);
+  freeBatchViews.push_back(view);
+}
+
+void EPUSimulator::validateBatch(
+    const EPUDecodedProgram &program,
+    const std::vector<EPUBatchBinding> &batch) const {
+  std::set<int> storedHandles;
+  for (const DecodedOp &op : program.ops)
+    if (op.opCode == OpCode::LOCAL_TO_GLOBAL_MEM_COPY &&
+        op.error == DecodedOp::NONE)
+      storedHandles.insert(op.handleId);
+
+  for (size_t member = 0; member < batch.size(); ++member) {
+    const EPUBatchBinding &binding = batch[member];
+    std::string where = "batch member " + std::to_string(member);
+
+    for (const EPUBatchInput &input : binding.inputs) {
+      const HandleEntry *handle =
+          lookupHandle(input.handleId, HandleDirection::INPUT);
+      if (!handle)
+        throw std::runtime_error(where + " binds unknown input handle " +
+                                 std::to_string(input.handleId));
+      if (input.numBytes < handle->numBytes)
+        throw std::runtime_error(where + ": buffer for input handle " +
+                                 std::to_string(input.handleId) +
+                                 " is smaller than the handle");
+    }
+
+    for (const EPUBatchOutput &output : binding.outputs) {
+      const HandleEntry *handle =
+          lookupHandle(output.handleId, HandleDirection::OUTPUT);
+      if (!handle)
+        throw std::runtime_error(where + " binds unknown output handle " +
+                                 std::to_string(output.handleId));
+      if (output.numBytes < handle->numBytes)
+        throw std::runtime_error(where + ": buffer for output handle " +
+                                 std::to_string(output.handleId) +
+                                 " is smaller than the handle");
+    }
+
+    // Stores to a shared output would race between members.
+    for (int handleId : storedHandles)
+      if (!findBinding(binding.outputs, handleId))
+        throw std::runtime_error(where + " does not bind output handle " +
+                                 std::to_string(handleId));
+  }
+}
+
+void EPUSimulator::relocateForBatch(DecodedOp &op,
+                                    const EPUBatchBinding &binding,
+                                    uint8_t *localView) const {
+  uint8_t *localBegin = getLocalMemoryBaseAddress(0);
+  uint8_t *localEnd = localBegin + numberOfCores * localRegionStride;
+
+  auto toView = [&](auto *pointer) {
+    auto *bytes = reinterpret_cast<uint8_t *>(const_cast<float *>(pointer));
+    if (bytes < localBegin || bytes >= localEnd)
+      return pointer;
+    return reinterpret_cast<decltype(pointer)>(localView +
+                                               (bytes - localBegin));
+  };
+
+  // Moves a pointer into the handle's storage over to the bound buffer.
+  auto toBinding = [&](auto *pointer, HandleDirection direction,
+                       const void *bound) {
+    const HandleEntry *handle = lookupHandle(op.handleId, direction);
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(pointer);
+    ptrdiff_t offset = bytes - getHandleAddress(*handle);
+    const uint8_t *target = static_cast<const uint8_t *>(bound) + offset;
+    return reinterpret_cast<decltype(pointer)>(const_cast<uint8_t *>(target));
+  };
+
+  if (op.error != DecodedOp::NONE)
+    return;
+
+  switch (op.opCode) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY: {
+    op.copy.dst = toView(op.copy.dst);
+    if (const EPUBatchInput *input = findBinding(binding.inputs, op.handleId))
+      op.copy.src = toBinding(op.copy.src, HandleDirection::INPUT, input->data);
+    break;
+  }
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY: {
+    op.copy.src = toView(op.copy.src);
+    const EPUBatchOutput *output = findBinding(binding.outputs, op.handleId);
+    op.copy.dst = toBinding(op.copy.dst, HandleDirection::OUTPUT, output->data);
+    break;
+  }
+  case OpCode::MATMUL:
+    op.matmul.A = toView(op.matmul.A);
+    op.matmul.B = toView(op.matmul.B);
+    op.matmul.C = toView(op.matmul.C);
+    break;
+  default:
+    break;
+  }
+}
+
+void EPUSimulator::runBatchMember(const EPUDecodedProgram &program,
+                                  const EPUBatchBinding &binding,
+                                  EPULocalMemoryView &view) {
+  // Ops of a parallel region are independent, so running the member
+  // serially gives the same result; the batch itself is the parallelism.
+  for (const DecodedOp &op : program.ops) {
+    if (op.opCode == OpCode::START_PARALLEL ||
+        op.opCode == OpCode::END_PARALLEL)
+      continue;
+
+    DecodedOp relocated = op;
+    relocateForBatch(relocated, binding, view.getBase());
+    executeDecoded(relocated);
+  }
+}
+
+EPUBatchReport
+EPUSimulator::simulateBatch(const EPUDecodedProgram &program,
+                            const std::vector<EPUBatchBinding> &batch) {
+  if (program.owner != this || program.handleEpoch != handleEpoch)
+    throw std::runtime_error(
+        "Decoded program is stale or belongs to another simulator");
+
+  FrozenHandleScope frozen(*this);
+  validateBatch(program, batch);
+
+  EPUBatchReport report;
+  report.numMembers = batch.size();
+  report.memberWallNs.resize(batch.size());
+
+  uint64_t startNs = SimulatorProfiler::nowNs();
+
+  EPUTaskGroup group;
+  for (size_t member = 0; member < batch.size(); ++member) {
+    threadPool.submit(group, [&, member]() {
+      uint64_t memberStartNs = SimulatorProfiler::nowNs();
+      EPULocalMemoryView *view = acquireBatchView();
+      try {
+        runBatchMember(program, batch[member], *view);
+      } catch (...) {
+        releaseBatchView(view);
+        throw;
+      }
+      releaseBatchView(view);
+      report.memberWallNs[member] = SimulatorProfiler::nowNs() - memberStartNs;
+    });
+  }
+  threadPool.wait(group);
+
+  report.wallNs = SimulatorProfiler::nowNs() - startNs;
+  {
+    std::lock_guard<std::mutex> lock(batchViewMutex);
+    report.numViews = batchViews.size();
+  }
+  if (report.wallNs > 0)
+    report.membersPerSecond = batch.size() * 1e9 / report.wallNs;
+  return report;
+}
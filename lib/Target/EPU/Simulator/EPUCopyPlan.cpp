@@ -0,0 +1,105 @@
+#include "Target/EPU/Simulator/EPUCopyPlan.h"
+#include "Target/EPU/Simulator/EPUKernels.h"
+#include <cstdint>
+#include <cstring>
+
+CopyPlan makeCopyPlan(const float *srcBase, int srcFullCols,
+                      const SliceOperand &src, float *dstBase,
+                      int dstFullCols, const SliceOperand &dst) {
+  CopyPlan plan;
+
+  const Dim &s1 = src.getDim1(); // src row dimension
+  const Dim &s0 = src.getDim0(); // src col dimension
+  const Dim &d1 = dst.getDim1(); // dst row dimension
+  const Dim &d0 = dst.getDim0(); // dst col dimension
+
+  int rows = s1.getSize();
+  int cols = s0.getSize();
+
+  if (rows != d1.getSize() || cols != d0.getSize())
+    return plan;
+
+  plan.rows = rows;
+  plan.cols = cols;
+
+  plan.src = srcBase + static_cast<ptrdiff_t>(s1.getStart()) * srcFullCols +
+             s0.getStart();
+  plan.dst = dstBase + static_cast<ptrdiff_t>(d1.getStart()) * dstFullCols +
+             d0.getStart();
+
+  plan.srcRowPitch = static_cast<ptrdiff_t>(s1.getStride()) * srcFullCols;
+  plan.srcColStride = s0.getStride();
+  plan.dstRowPitch = static_cast<ptrdiff_t>(d1.getStride()) * dstFullCols;
+  plan.dstColStride = d0.getStride();
+
+  if (rows == 0 || cols == 0) {
+    plan.kind = CopyPlan::EMPTY;
+  } else if (plan.srcColStride != 1 || plan.dstColStride != 1) {
+    plan.kind = CopyPlan::STRIDED;
+  } else if (rows == 1 ||
+             (plan.srcRowPitch == cols && plan.dstRowPitch == cols)) {
+    plan.kind = CopyPlan::BULK;
+  } else {
+    plan.kind = CopyPlan::ROWS;
+  }
+
+  return plan;
+}
+
+void runCopyPlan(const CopyPlan &plan) {
+  switch (plan.kind) {
+  case CopyPlan::BULK:
+    std::memcpy(plan.dst, plan.src, plan.getNumBytes());
+    return;
+
+  case CopyPlan::ROWS: {
+    const size_t rowBytes = static_cast<size_t>(plan.cols) * sizeof(float);
+    const float *src = plan.src;
+    float *dst = plan.dst;
+    for (int r = 0; r < plan.rows; ++r) {
+      std::memcpy(dst, src, rowBytes);
+      src += plan.srcRowPitch;
+      dst += plan.dstRowPitch;
+    }
+    return;
+  }
+
+  case CopyPlan::STRIDED:
+    stridedCopy2D(plan.src, plan.srcRowPitch, plan.srcColStride, plan.dst,
+                  plan.dstRowPitch, plan.dstColStride, plan.rows, plan.cols);
+    return;
+
+  case CopyPlan::EMPTY:
+  case CopyPlan::INVALID:
+    return;
+  }
+}
+
+CopyPlan splitCopyPlan(const CopyPlan &plan, int part, int numParts) {
+  CopyPlan piece = plan;
+
+  if (plan.rows >= numParts) {
+    int begin = static_cast<int>(static_cast<int64_t>(plan.rows) * part /
+                                 numParts);
+    int end = static_cast<int>(static_cast<int64_t>(plan.rows) * (part + 1) /
+                               numParts);
+    piece.rows = end - begin;
+    piece.src += begin * plan.srcRowPitch;
+    piece.dst += begin * plan.dstRowPitch;
+  } else {
+    int begin = static_cast<int>(static_cast<int64_t>(plan.cols) * part /
+                                 numParts);
+    int end = static_cast<int>(static_cast<int64_t>(plan.cols) * (part + 1) /
+                               numParts);
+    piece.cols = end - begin;
+    piece.src += begin * plan.srcColStride;
+    piece.dst += begin * plan.dstColStride;
+    // A column range of several contiguous rows is no longer contiguous.
+    if (plan.kind == CopyPlan::BULK && plan.rows > 1)
+      piece.kind = CopyPlan::ROWS;
+  }
+
+  if (piece.rows == 0 || piece.cols == 0)
+    piece.kind = CopyPlan::EMPTY;
+  return piece;
+}
@@ -0,0 +1,97 @@
+#include "Target/EPU/Simulator/EPUCoreThreads.h"
+#include <pthread.h>
+#include <sched.h>
+
+EPUCoreThreads::EPUCoreThreads(unsigned numThreads, bool pin) {
+  threads.reserve(numThreads);
+  for (unsigned i = 0; i < numThreads; ++i) {
+    threads.emplace_back([this, i]() { threadLoop(i); });
+    if (pin)
+      pinToHostCPU(threads.back(), i);
+  }
+}
+
+EPUCoreThreads::~EPUCoreThreads() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  startWork.notify_all();
+
+  for (auto &thread : threads)
+    thread.join();
+}
+
+void EPUCoreThreads::pinToHostCPU(std::thread &thread, unsigned index) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    return;
+
+  int numAllowed = CPU_COUNT(&allowed);
+  if (numAllowed == 0)
+    return;
+
+  // The index-th allowed CPU, wrapping around.
+  int wanted = index % numAllowed;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &allowed) || wanted-- > 0)
+      continue;
+
+    cpu_set_t target;
+    CPU_ZERO(&target);
+    CPU_SET(cpu, &target);
+    // Pinning is only a locality hint; carry on unpinned if it fails.
+    pthread_setaffinity_np(thread.native_handle(), sizeof(target), &target);
+    return;
+  }
+}
+
+void EPUCoreThreads::threadLoop(unsigned index) {
+  unsigned seenGeneration = 0;
+
+  while (true) {
+    std::function<void(unsigned)> fn;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      startWork.wait(lock, [&]() {
+        return stopping || generation != seenGeneration;
+      });
+      if (stopping)
+        return;
+      seenGeneration = generation;
+      fn = work;
+    }
+
+    std::exception_ptr threadError;
+    try {
+      fn(index);
+    } catch (...) {
+      threadError = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (threadError && !error)
+      error = threadError;
+    if (--running == 0)
+      workDone.notify_all();
+  }
+}
+
+void EPUCoreThreads::run(const std::function<void(unsigned)> &fn) {
+  std::exception_ptr runError;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    work = fn;
+    running = threads.size();
+    ++generation;
+    startWork.notify_all();
+
+    workDone.wait(lock, [this]() { return running == 0; });
+    work = nullptr;
+    std::swap(runError, error);
+  }
+
+  if (runError)
+    std::rethrow_exception(runError);
+}
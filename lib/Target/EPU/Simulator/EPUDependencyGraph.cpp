@@ -0,0 +1,80 @@
+#include "Target/EPU/Simulator/EPUDependencyGraph.h"
+#include <algorithm>
+
+void EPUDependencyGraph::addEdge(uint32_t from, uint32_t to) {
+  nodes[from].successors.push_back(to);
+  ++nodes[to].numPredecessors;
+  ++numEdges;
+}
+
+void EPUDependencyGraph::addDependency(uint32_t from, uint32_t to) {
+  // Edges into the newest op are appended last, so a duplicate is at the
+  // back.
+  const std::vector<uint32_t> &successors = nodes[from].successors;
+  if (!successors.empty() && successors.back() == to)
+    return;
+  addEdge(from, to);
+}
+
+uint32_t EPUDependencyGraph::addOp(const OpFootprint &footprint) {
+  uint32_t op = nodes.size();
+  nodes.emplace_back();
+
+  if (footprint.isBarrier) {
+    for (uint32_t prev : opsSinceBarrier)
+      addEdge(prev, op);
+    if (lastBarrier >= 0 && opsSinceBarrier.empty())
+      addEdge(lastBarrier, op);
+
+    opsSinceBarrier.clear();
+    liveAccesses.clear();
+    lastBarrier = op;
+    return op;
+  }
+
+  std::vector<uint32_t> deps;
+  if (lastBarrier >= 0)
+    deps.push_back(lastBarrier);
+
+  // RAW: reads wait for earlier overlapping writes.
+  for (const MemoryRange &read : footprint.reads) {
+    auto it = liveAccesses.find(read.getSpaceKey());
+    if (it == liveAccesses.end())
+      continue;
+    for (const Access &access : it->second)
+      if (access.isWrite && access.range.overlaps(read))
+        deps.push_back(access.op);
+  }
+
+  // WAR and WAW: writes wait for every earlier overlapping access.
+  for (const MemoryRange &write : footprint.writes) {
+    auto it = liveAccesses.find(write.getSpaceKey());
+    if (it == liveAccesses.end())
+      continue;
+    for (const Access &access : it->second)
+      if (access.range.overlaps(write))
+        deps.push_back(access.op);
+  }
+
+  std::sort(deps.begin(), deps.end());
+  deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+  for (uint32_t dep : deps)
+    addEdge(dep, op);
+
+  // Record this op's accesses, dropping the ones its writes supersede.
+  for (const MemoryRange &write : footprint.writes) {
+    auto &accesses = liveAccesses[write.getSpaceKey()];
+    accesses.erase(std::remove_if(accesses.begin(), accesses.end(),
+                                  [&write](const Access &access) {
+                                    return write.covers(access.range);
+                                  }),
+                   accesses.end());
+  }
+  for (const MemoryRange &read : footprint.reads)
+    liveAccesses[read.getSpaceKey()].push_back({read, op, false});
+  for (const MemoryRange &write : footprint.writes)
+    liveAccesses[write.getSpaceKey()].push_back({write, op, true});
+
+  opsSinceBarrier.push_back(op);
+  return op;
+}
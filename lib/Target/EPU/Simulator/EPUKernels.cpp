@@ -0,0 +1,313 @@
+#include "Target/EPU/Simulator/EPUKernels.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__GNUC__) || defined(__clang__))
+#define EPU_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define EPU_KERNELS_X86 0
+#endif
+
+// -----------------------------
+// Host ISA detection
+// -----------------------------
+static HostVectorISA detectHostVectorISA() {
+  HostVectorISA isa = HostVectorISA::SCALAR;
+
+#if EPU_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    isa = HostVectorISA::AVX2;
+  if (__builtin_cpu_supports("avx512f"))
+    isa = HostVectorISA::AVX512;
+#endif
+
+  // Allow capping the ISA, mostly to exercise the fallbacks on big machines.
+  if (const char *env = std::getenv("EPU_HOST_ISA")) {
+    std::string cap(env);
+    HostVectorISA capIsa = isa;
+    if (cap == "scalar")
+      capIsa = HostVectorISA::SCALAR;
+    else if (cap == "avx2")
+      capIsa = HostVectorISA::AVX2;
+    else if (cap == "avx512")
+      capIsa = HostVectorISA::AVX512;
+
+    if (capIsa < isa)
+      isa = capIsa;
+  }
+
+  return isa;
+}
+
+HostVectorISA getHostVectorISA() {
+  static const HostVectorISA isa = detectHostVectorISA();
+  return isa;
+}
+
+const char *getHostVectorISAName(HostVectorISA isa) {
+  switch (isa) {
+  case HostVectorISA::SCALAR:
+    return "scalar";
+  case HostVectorISA::AVX2:
+    return "avx2";
+  case HostVectorISA::AVX512:
+    return "avx512";
+  }
+  return "unknown";
+}
+
+// -----------------------------
+// 32x32x32 matmul kernels
+// -----------------------------
+// B is packed into a contiguous, 64-byte aligned 32x32 block first so the
+// inner loops see unit-stride, aligned rows regardless of the local memory
+// row pitch. The packing buffer is per thread since parallel regions run
+// several matmuls at once.
+namespace {
+
+constexpr int T = EPU_MM_TILE;
+
+struct alignas(64) PackedTile {
+  float data[T * T];
+};
+
+const float *packB(const float *B, int ldb) {
+  static thread_local PackedTile packed;
+  for (int k = 0; k < T; ++k)
+    std::memcpy(packed.data + k * T, B + static_cast<size_t>(k) * ldb,
+                T * sizeof(float));
+  return packed.data;
+}
+
+// Portable fallback. Register tile of 4 rows x 32 cols; the n loop is left to
+// the auto-vectorizer.
+void matmulTile32Scalar(const float *A, int lda, const float *Bp, float *C,
+                        int ldc, bool accumulate) {
+  constexpr int MR = 4;
+  for (int m = 0; m < T; m += MR) {
+    float acc[MR][T];
+    for (int i = 0; i < MR; ++i)
+      for (int n = 0; n < T; ++n)
+        acc[i][n] = accumulate ? C[(m + i) * ldc + n] : 0.0f;
+
+    for (int k = 0; k < T; ++k) {
+      const float *bRow = Bp + k * T;
+      for (int i = 0; i < MR; ++i) {
+        float a = A[(m + i) * lda + k];
+        for (int n = 0; n < T; ++n)
+          acc[i][n] += a * bRow[n];
+      }
+    }
+
+    for (int i = 0; i < MR; ++i)
+      for (int n = 0; n < T; ++n)
+        C[(m + i) * ldc + n] = acc[i][n];
+  }
+}
+
+#if EPU_KERNELS_X86
+// AVX2: 4 rows x 16 cols register tile (8 ymm accumulators).
+__attribute__((target("avx2"))) void
+matmulTile32AVX2(const float *A, int lda, const float *Bp, float *C, int ldc,
+                 bool accumulate) {
+  constexpr int MR = 4;
+  constexpr int NR = 16;
+  for (int m = 0; m < T; m += MR) {
+    for (int n = 0; n < T; n += NR) {
+      __m256 c[MR][2];
+      for (int i = 0; i < MR; ++i) {
+        float *cRow = C + (m + i) * ldc + n;
+        c[i][0] = accumulate ? _mm256_loadu_ps(cRow) : _mm256_setzero_ps();
+        c[i][1] = accumulate ? _mm256_loadu_ps(cRow + 8) : _mm256_setzero_ps();
+      }
+
+      for (int k = 0; k < T; ++k) {
+        __m256 b0 = _mm256_load_ps(Bp + k * T + n);
+        __m256 b1 = _mm256_load_ps(Bp + k * T + n + 8);
+        for (int i = 0; i < MR; ++i) {
+          __m256 a = _mm256_broadcast_ss(A + (m + i) * lda + k);
+          c[i][0] = _mm256_add_ps(c[i][0], _mm256_mul_ps(a, b0));
+          c[i][1] = _mm256_add_ps(c[i][1], _mm256_mul_ps(a, b1));
+        }
+      }
+
+      for (int i = 0; i < MR; ++i) {
+        float *cRow = C + (m + i) * ldc + n;
+        _mm256_storeu_ps(cRow, c[i][0]);
+        _mm256_storeu_ps(cRow + 8, c[i][1]);
+      }
+    }
+  }
+}
+
+// AVX-512: 8 rows x 32 cols register tile (16 zmm accumulators).
+__attribute__((target("avx512f"))) void
+matmulTile32AVX512(const float *A, int lda, const float *Bp, float *C, int ldc,
+                   bool accumulate) {
+  constexpr int MR = 8;
+  for (int m = 0; m < T; m += MR) {
+    __m512 c[MR][2];
+    for (int i = 0; i < MR; ++i) {
+      float *cRow = C + (m + i) * ldc;
+      c[i][0] = accumulate ? _mm512_loadu_ps(cRow) : _mm512_setzero_ps();
+      c[i][1] = accumulate ? _mm512_loadu_ps(cRow + 16) : _mm512_setzero_ps();
+    }
+
+    for (int k = 0; k < T; ++k) {
+      __m512 b0 = _mm512_load_ps(Bp + k * T);
+      __m512 b1 = _mm512_load_ps(Bp + k * T + 16);
+      for (int i = 0; i < MR; ++i) {
+        __m512 a = _mm512_set1_ps(A[(m + i) * lda + k]);
+        c[i][0] = _mm512_add_ps(c[i][0], _mm512_mul_ps(a, b0));
+        c[i][1] = _mm512_add_ps(c[i][1], _mm512_mul_ps(a, b1));
+      }
+    }
+
+    for (int i = 0; i < MR; ++i) {
+      float *cRow = C + (m + i) * ldc;
+      _mm512_storeu_ps(cRow, c[i][0]);
+      _mm512_storeu_ps(cRow + 16, c[i][1]);
+    }
+  }
+}
+#endif // EPU_KERNELS_X86
+
+// -----------------------------
+// Strided 2D copy kernels
+// -----------------------------
+void stridedCopy2DScalar(const float *src, ptrdiff_t srcRowPitch,
+                         ptrdiff_t srcColStride, float *dst,
+                         ptrdiff_t dstRowPitch, ptrdiff_t dstColStride,
+                         int rows, int cols) {
+  for (int r = 0; r < rows; ++r) {
+    const float *s = src + r * srcRowPitch;
+    float *d = dst + r * dstRowPitch;
+    for (int c = 0; c < cols; ++c)
+      d[c * dstColStride] = s[c * srcColStride];
+  }
+}
+
+#if EPU_KERNELS_X86
+// AVX2 has gather but no scatter: strided destinations are written lane by
+// lane from a spilled vector.
+__attribute__((target("avx2"))) void
+stridedCopy2DAVX2(const float *src, ptrdiff_t srcRowPitch,
+                  ptrdiff_t srcColStride, float *dst, ptrdiff_t dstRowPitch,
+                  ptrdiff_t dstColStride, int rows, int cols) {
+  const __m256i idx =
+      _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                         _mm256_set1_epi32(static_cast<int>(srcColStride)));
+
+  for (int r = 0; r < rows; ++r) {
+    const float *s = src + r * srcRowPitch;
+    float *d = dst + r * dstRowPitch;
+    int c = 0;
+    for (; c + 8 <= cols; c += 8) {
+      __m256 v = srcColStride == 1
+                     ? _mm256_loadu_ps(s + c)
+                     : _mm256_i32gather_ps(s + c * srcColStride, idx, 4);
+      if (dstColStride == 1) {
+        _mm256_storeu_ps(d + c, v);
+      } else {
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, v);
+        for (int j = 0; j < 8; ++j)
+          d[(c + j) * dstColStride] = lanes[j];
+      }
+    }
+    for (; c < cols; ++c)
+      d[c * dstColStride] = s[c * srcColStride];
+  }
+}
+
+__attribute__((target("avx512f"))) void
+stridedCopy2DAVX512(const float *src, ptrdiff_t srcRowPitch,
+                    ptrdiff_t srcColStride, float *dst, ptrdiff_t dstRowPitch,
+                    ptrdiff_t dstColStride, int rows, int cols) {
+  const __m512i lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                         12, 13, 14, 15);
+  const __m512i srcIdx = _mm512_mullo_epi32(
+      lane, _mm512_set1_epi32(static_cast<int>(srcColStride)));
+  const __m512i dstIdx = _mm512_mullo_epi32(
+      lane, _mm512_set1_epi32(static_cast<int>(dstColStride)));
+
+  for (int r = 0; r < rows; ++r) {
+    const float *s = src + r * srcRowPitch;
+    float *d = dst + r * dstRowPitch;
+    int c = 0;
+    for (; c + 16 <= cols; c += 16) {
+      // The masked gather with a zero source keeps GCC from reporting the
+      // plain gather's unset pass-through register as maybe-uninitialized.
+      __m512 v = srcColStride == 1
+                     ? _mm512_loadu_ps(s + c)
+                     : _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF,
+                                                srcIdx, s + c * srcColStride,
+                                                4);
+      if (dstColStride == 1)
+        _mm512_storeu_ps(d + c, v);
+      else
+        _mm512_i32scatter_ps(d + c * dstColStride, dstIdx, v, 4);
+    }
+    for (; c < cols; ++c)
+      d[c * dstColStride] = s[c * srcColStride];
+  }
+}
+#endif // EPU_KERNELS_X86
+
+} // namespace
+
+void matmulTile32(HostVectorISA isa, const float *A, int lda, const float *B,
+                  int ldb, float *C, int ldc, bool accumulate) {
+  if (isa > getHostVectorISA())
+    isa = getHostVectorISA();
+
+  const float *Bp = packB(B, ldb);
+
+  switch (isa) {
+#if EPU_KERNELS_X86
+  case HostVectorISA::AVX512:
+    matmulTile32AVX512(A, lda, Bp, C, ldc, accumulate);
+    return;
+  case HostVectorISA::AVX2:
+    matmulTile32AVX2(A, lda, Bp, C, ldc, accumulate);
+    return;
+#endif
+  default:
+    matmulTile32Scalar(A, lda, Bp, C, ldc, accumulate);
+    return;
+  }
+}
+
+void matmulTile32(const float *A, int lda, const float *B, int ldb, float *C,
+                  int ldc, bool accumulate) {
+  matmulTile32(getHostVectorISA(), A, lda, B, ldb, C, ldc, accumulate);
+}
+
+void stridedCopy2D(const float *src, ptrdiff_t srcRowPitch,
+                   ptrdiff_t srcColStride, float *dst, ptrdiff_t dstRowPitch,
+                   ptrdiff_t dstColStride, int rows, int cols) {
+#if EPU_KERNELS_X86
+  // Gather/scatter lane offsets are 32-bit.
+  constexpr ptrdiff_t maxLaneStride = INT32_MAX / 16;
+  bool fitsLanes = srcColStride > 0 && srcColStride <= maxLaneStride &&
+                   dstColStride > 0 && dstColStride <= maxLaneStride;
+
+  if (fitsLanes && getHostVectorISA() == HostVectorISA::AVX512) {
+    stridedCopy2DAVX512(src, srcRowPitch, srcColStride, dst, dstRowPitch,
+                        dstColStride, rows, cols);
+    return;
+  }
+  if (fitsLanes && getHostVectorISA() == HostVectorISA::AVX2) {
+    stridedCopy2DAVX2(src, srcRowPitch, srcColStride, dst, dstRowPitch,
+                      dstColStride, rows, cols);
+    return;
+  }
+#endif
+  stridedCopy2DScalar(src, srcRowPitch, srcColStride, dst, dstRowPitch,
+                      dstColStride, rows, cols);
+}
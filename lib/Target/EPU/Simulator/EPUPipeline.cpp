@@ -0,0 +1,151 @@
+#include "Target/EPU/Simulator/EPUPipeline.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include <cstring>
+#include <stdexcept>
+
+void EPUPipeline::SlotQueue::push(Slot *slot) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    slots.push_back(slot);
+  }
+  nonEmpty.notify_one();
+}
+
+EPUPipeline::Slot *EPUPipeline::SlotQueue::pop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  nonEmpty.wait(lock, [this]() { return !slots.empty(); });
+  Slot *slot = slots.front();
+  slots.pop_front();
+  return slot;
+}
+
+EPUPipeline::EPUPipeline(EPUSimulator &simulator,
+                         const EPUDecodedProgram &program, unsigned depth)
+    : simulator(simulator), program(program) {
+  if (depth == 0)
+    throw std::runtime_error("Pipeline depth must be at least 1");
+
+  // Staged jobs run the program as decoded now; a stale program fails each
+  // job through its future.
+  simulator.freezeHandles();
+
+  for (unsigned i = 0; i < depth; ++i) {
+    slots.push_back(std::make_unique<Slot>());
+    freeSlots.push(slots.back().get());
+  }
+
+  simulateThread = std::thread([this]() { simulateLoop(); });
+  drainThread = std::thread([this]() { drainLoop(); });
+}
+
+EPUPipeline::~EPUPipeline() {
+  simulateQueue.push(nullptr);
+  simulateThread.join();
+  drainThread.join();
+  simulator.unfreezeHandles();
+}
+
+std::future<void> EPUPipeline::submit(const EPUPipelineJob &job) {
+  uint64_t waitStartNs = SimulatorProfiler::nowNs();
+  Slot *slot = freeSlots.pop();
+  uint64_t stageStartNs = SimulatorProfiler::nowNs();
+  submitWaitNs.fetch_add(stageStartNs - waitStartNs,
+                         std::memory_order_relaxed);
+
+  // Buffers keep their capacity across jobs, so steady-state staging is a
+  // plain copy.
+  slot->inputBuffers.resize(job.inputs.size());
+  slot->binding.inputs.clear();
+  for (size_t i = 0; i < job.inputs.size(); ++i) {
+    const EPUBatchInput &input = job.inputs[i];
+    std::vector<uint8_t> &buffer = slot->inputBuffers[i];
+    buffer.resize(input.numBytes);
+    std::memcpy(buffer.data(), input.data, input.numBytes);
+    slot->binding.inputs.push_back(
+        {input.handleId, buffer.data(), input.numBytes});
+  }
+
+  slot->outputBuffers.resize(job.outputs.size());
+  slot->binding.outputs.clear();
+  for (size_t i = 0; i < job.outputs.size(); ++i) {
+    const EPUBatchOutput &output = job.outputs[i];
+    std::vector<uint8_t> &buffer = slot->outputBuffers[i];
+    buffer.resize(output.numBytes);
+    slot->binding.outputs.push_back(
+        {output.handleId, buffer.data(), output.numBytes});
+  }
+  slot->destinations = job.outputs;
+
+  slot->done = std::promise<void>();
+  slot->error = nullptr;
+  std::future<void> result = slot->done.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock(idleMutex);
+    ++jobsInFlight;
+  }
+  stageNs.fetch_add(SimulatorProfiler::nowNs() - stageStartNs,
+                    std::memory_order_relaxed);
+
+  simulateQueue.push(slot);
+  return result;
+}
+
+void EPUPipeline::simulateLoop() {
+  while (Slot *slot = simulateQueue.pop()) {
+    uint64_t startNs = SimulatorProfiler::nowNs();
+    try {
+      simulator.simulateBatch(program, {slot->binding});
+    } catch (...) {
+      slot->error = std::current_exception();
+    }
+    simulateNs.fetch_add(SimulatorProfiler::nowNs() - startNs,
+                         std::memory_order_relaxed);
+    drainQueue.push(slot);
+  }
+  drainQueue.push(nullptr);
+}
+
+void EPUPipeline::drainLoop() {
+  while (Slot *slot = drainQueue.pop()) {
+    uint64_t startNs = SimulatorProfiler::nowNs();
+    if (!slot->error)
+      for (size_t i = 0; i < slot->destinations.size(); ++i)
+        std::memcpy(slot->destinations[i].data, slot->outputBuffers[i].data(),
+                    slot->destinations[i].numBytes);
+    drainNs.fetch_add(SimulatorProfiler::nowNs() - startNs,
+                      std::memory_order_relaxed);
+    jobsCompleted.fetch_add(1, std::memory_order_relaxed);
+
+    // Take everything out of the slot before handing it back for reuse.
+    std::promise<void> done = std::move(slot->done);
+    std::exception_ptr error = slot->error;
+    freeSlots.push(slot);
+
+    if (error)
+      done.set_exception(error);
+    else
+      done.set_value();
+
+    {
+      std::lock_guard<std::mutex> lock(idleMutex);
+      --jobsInFlight;
+    }
+    idle.notify_all();
+  }
+}
+
+void EPUPipeline::waitIdle() {
+  std::unique_lock<std::mutex> lock(idleMutex);
+  idle.wait(lock, [this]() { return jobsInFlight == 0; });
+}
+
+EPUPipelineStats EPUPipeline::getStats() const {
+  EPUPipelineStats stats;
+  stats.jobsCompleted = jobsCompleted.load();
+  stats.stageNs = stageNs.load();
+  stats.simulateNs = simulateNs.load();
+  stats.drainNs = drainNs.load();
+  stats.submitWaitNs = submitWaitNs.load();
+  return stats;
+}
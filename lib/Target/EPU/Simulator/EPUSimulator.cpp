@@ -2,96 +2,72 @@
 #include "ISA/Op.h"
 #include "Simulator/Simulator.h"
 #include "Target/EPU/Asm/EPUOps.h"
+#include "Target/EPU/Simulator/EPUKernels.h"
+#include "Target/EPU/Simulator/EPUSyncOrdering.h"
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <deque>
 #include <exception>
-#include <future>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <stdexcept>
 #include <memory>
-#include <thread>
 
-void EPUSimulator::executeGlobalToLocalMemCopy(GlobalToLocalMemCopyOp *op) {
-  auto src = op->getSrcSlice();
-  auto dst = op->getDstSlice();
-  int coreId = op->getCoreNum();
+// ============================================================
+// Decoding
+// ============================================================
 
-  // -----------------------------
-  // Resolve base addresses
-  // -----------------------------
-  int handleId = src.getBaseAddress();
-  if (this->inputHandleToMemoryLocMap.count(handleId) == 0) {
-    std::cerr << "ERROR: Unknown global handle " << handleId << "\n";
+void EPUSimulator::decodeGlobalToLocalMemCopy(const SliceOperand &src,
+                                              const SliceOperand &dst,
+                                              DecodedOp &decoded) const {
+  // src is GLOBAL memory, dst is LOCAL memory
+  int coreId = decoded.core;
+  if (coreId < 0 || coreId >= numberOfCores) {
+    decoded.error = DecodedOp::INVALID_CORE;
     return;
   }
 
-  uint8_t *handleBase =
-      getGlobalMemoryBaseAddress() + inputHandleToMemoryLocMap[handleId];
-
-  uint8_t *localBase = getLocalMemoryBaseAddress(coreId) + dst.getBaseAddress();
-
-  // -----------------------------
-  // Extract dims
-  // -----------------------------
-  const Dim &s1 = src.getDim1(); // src row dimension
-  const Dim &s0 = src.getDim0(); // src col dimension
-
-  const Dim &d1 = dst.getDim1(); // dst row dimension
-  const Dim &d0 = dst.getDim0(); // dst col dimension
-
-  assert(s1.getStride() == s0.getStride() == d1.getStride() == d0.getStride() ==
-             1 &&
-         "Non unit strides are yet to be supported\n");
-
   // -----------------------------
-  // Validate shapes match
+  // Resolve base addresses
   // -----------------------------
-  int rows_src = (s1.getEnd() - s1.getStart());
-  int cols_src = (s0.getEnd() - s0.getStart());
-
-  int rows_dst = (d1.getEnd() - d1.getStart());
-  int cols_dst = (d0.getEnd() - d0.getStart());
+  int handleId = src.getBaseAddress();
+  decoded.handleId = handleId;
 
-  if (rows_src != rows_dst || cols_src != cols_dst) {
-    std::cerr << "ERROR: mismatched source/destination slice shapes!\n";
+  // The handle may live in global memory, a caller buffer or a mapped file;
+  // either way the copy reads it in place.
+  const HandleEntry *handle = lookupHandle(handleId, HandleDirection::INPUT);
+  if (!handle) {
+    decoded.error = DecodedOp::UNKNOWN_INPUT_HANDLE;
     return;
   }
 
-  int rows = rows_src;
-  int cols = cols_src;
+  const uint8_t *handleBase = getHandleAddress(*handle);
+
+  uint8_t *localBase = getLocalMemoryBaseAddress(coreId) + dst.getBaseAddress();
 
-  // -----------------------------
-  // *** REAL COPY WITH STRIDES ***
-  // -----------------------------
   // Assumption that element type is always float , but this
   // needs to be enhanced to accept any dtype.
-  const size_t elemSize = sizeof(float);
-
-  auto handleTensorShape = inputHandleToShapeMap[handleId];
-
-  for (int r = 0; r < rows; ++r) {
-    int srcRowIndex = s1.getStart() + r;
-    int dstRowIndex = d1.getStart() + r;
-
-    for (int c = 0; c < cols; ++c) {
-      int srcColIndex = s0.getStart() + c;
-      int dstColIndex = d0.getStart() + c;
+  // Source rows are as wide as the handle tensor, destination rows as wide as
+  // the end of the local slice's column dim.
+  decoded.copy = makeCopyPlan(
+      reinterpret_cast<const float *>(handleBase), handle->rowPitch, src,
+      reinterpret_cast<float *>(localBase), dst.getDim0().getEnd(), dst);
 
-      size_t srcOffset = (srcRowIndex * (handleTensorShape[1])) + srcColIndex;
-      size_t dstOffset = (dstRowIndex * (d0.getEnd())) + dstColIndex;
-
-      // convert to bytes
-      float *srcElement = reinterpret_cast<float *>(handleBase) + srcOffset;
-      float *dstElement = reinterpret_cast<float *>(localBase) + dstOffset;
-
-      *dstElement = *srcElement; // actual scalar copy
-    }
-  }
+  if (decoded.copy.kind == CopyPlan::INVALID)
+    decoded.error = DecodedOp::GLOBAL_TO_LOCAL_SHAPE_MISMATCH;
 }
 
-void EPUSimulator::executeLocalToGlobalMemCopy(LocalToGlobalMemCopyOp *op) {
-  auto &src = op->getSrcSlice(); // source is LOCAL memory
-  auto &dst = op->getDstSlice(); // destination is GLOBAL memory
-  int coreId = op->getCoreNum();
+void EPUSimulator::decodeLocalToGlobalMemCopy(const SliceOperand &src,
+                                              const SliceOperand &dst,
+                                              DecodedOp &decoded) const {
+  // src is LOCAL memory, dst is GLOBAL memory
+  int coreId = decoded.core;
+  if (coreId < 0 || coreId >= numberOfCores) {
+    decoded.error = DecodedOp::INVALID_CORE;
+    return;
+  }
 
   // ------------------------------------------------------------
   // Resolve local memory base
@@ -102,87 +78,46 @@ void EPUSimulator::executeLocalToGlobalMemCopy(LocalToGlobalMemCopyOp *op) {
   // Resolve destination global handle
   // ------------------------------------------------------------
   int handleId = dst.getBaseAddress();
-  if (outputHandleToMemoryLocMap.count(handleId) == 0) {
-    std::cerr << "ERROR: Unknown global output handle " << handleId << "\n";
-    return;
-  }
-
-  uint8_t *globalBase =
-      getGlobalMemoryBaseAddress() + outputHandleToMemoryLocMap[handleId];
-
-  // ------------------------------------------------------------
-  // Dim extraction
-  // ------------------------------------------------------------
-  const Dim &s1 = src.getDim1(); // rows
-  const Dim &s0 = src.getDim0(); // cols
-
-  const Dim &d1 = dst.getDim1();
-  const Dim &d0 = dst.getDim0();
-
-  assert(s1.getStride() == s0.getStride() == d1.getStride() == d0.getStride() ==
-             1 &&
-         "Non unit strides are yet to be supported\n");
+  decoded.handleId = handleId;
 
-  // Slice sizes (number of elements)
-  int rows_src = (s1.getEnd() - s1.getStart());
-  int cols_src = (s0.getEnd() - s0.getStart());
-
-  int rows_dst = (d1.getEnd() - d1.getStart());
-  int cols_dst = (d0.getEnd() - d0.getStart());
-
-  if (rows_src != rows_dst || cols_src != cols_dst) {
-    std::cerr << "ERROR: Local→Global slice shape mismatch!\n";
+  const HandleEntry *handle = lookupHandle(handleId, HandleDirection::OUTPUT);
+  if (!handle) {
+    decoded.error = DecodedOp::UNKNOWN_OUTPUT_HANDLE;
     return;
   }
 
-  int rows = rows_src;
-  int cols = cols_src;
+  uint8_t *globalBase = getHandleAddress(*handle);
 
   // ------------------------------------------------------------
   // Assume element type = float
   // TODO: attach dtype information to SliceOperand
   // ------------------------------------------------------------
-  const size_t elemSize = sizeof(float);
-
-  // Full row lengths for correct offset calculation
-  int srcFullCols = s0.getEnd(); // local memory slice full width
-
-  auto handleTensorShape = outputHandleToShapeMap[handleId];
-
-  // ------------------------------------------------------------
-  // PER-ELEMENT STRIDED COPY (correct stride semantics)
-  // ------------------------------------------------------------
-  for (int r = 0; r < rows; ++r) {
-    int srcRowIndex = s1.getStart() + r;
-    int dstRowIndex = d1.getStart() + r;
+  decoded.copy = makeCopyPlan(
+      reinterpret_cast<const float *>(localBase), src.getDim0().getEnd(), src,
+      reinterpret_cast<float *>(globalBase), handle->rowPitch, dst);
 
-    for (int c = 0; c < cols; ++c) {
-      int srcColIndex = s0.getStart() + c;
-      int dstColIndex = d0.getStart() + c;
-
-      // Logical offsets
-      size_t srcOffset = srcRowIndex * srcFullCols + srcColIndex;
-      size_t dstOffset = dstRowIndex * handleTensorShape[1] + dstColIndex;
-
-      float *srcElement = reinterpret_cast<float *>(localBase) + srcOffset;
-      float *dstElement = reinterpret_cast<float *>(globalBase) + dstOffset;
-
-      *dstElement = *srcElement;
-    }
-  }
+  if (decoded.copy.kind == CopyPlan::INVALID)
+    decoded.error = DecodedOp::LOCAL_TO_GLOBAL_SHAPE_MISMATCH;
 }
 
-void EPUSimulator::executeMatmul(MatmulOp *op) {
-  int coreId = op->getCoreNum();
-  int mmUnit = op->getMMUnitNum();
-  bool accumulate = op->getAccumulate(); // however you represent this
+void EPUSimulator::decodeMatmul(int mmUnit, bool accumulate,
+                                const SliceOperand &A, const SliceOperand &B,
+                                const SliceOperand &C,
+                                DecodedOp &decoded) const {
+  int coreId = decoded.core;
+  if (coreId < 0 || coreId >= numberOfCores) {
+    decoded.error = DecodedOp::INVALID_CORE;
+    return;
+  }
 
-  // -----------------------------
-  // Resolve slices
-  // -----------------------------
-  auto &A = op->getSliceA();
-  auto &B = op->getSliceB();
-  auto &C = op->getSliceC();
+  // Unit queues, matmul groups and profiler lanes are indexed by the unit.
+  if (mmUnit < 0 || mmUnit >= processor.getMMUnitsPerCore()) {
+    decoded.error = DecodedOp::INVALID_MATMUL_UNIT;
+    return;
+  }
+  decoded.mmUnit = static_cast<uint8_t>(mmUnit);
+  if (accumulate)
+    decoded.flags |= DecodedOp::ACCUMULATE;
 
   // -----------------------------
   // Resolve local memory bases
@@ -211,7 +146,7 @@ void EPUSimulator::executeMatmul(MatmulOp *op) {
 
   // Sanity check
   if (K != K2) {
-    std::cerr << "ERROR: Matmul dimension mismatch: A.cols != B.rows\n";
+    decoded.error = DecodedOp::MATMUL_DIM_MISMATCH;
     return;
   }
 
@@ -219,7 +154,7 @@ void EPUSimulator::executeMatmul(MatmulOp *op) {
   int N2 = (C_c.getEnd() - C_c.getStart()) / C_c.getStride();
 
   if (M != M2 || N != N2) {
-    std::cerr << "ERROR: Matmul output slice shape mismatch\n";
+    decoded.error = DecodedOp::MATMUL_OUTPUT_SHAPE_MISMATCH;
     return;
   }
 
@@ -228,74 +163,1194 @@ void EPUSimulator::executeMatmul(MatmulOp *op) {
   int B_fullCols = B_c.getEnd();
   int C_fullCols = C_c.getEnd();
 
+  // Fold slice starts into the operand pointers and strides into per-dim
+  // element steps.
+  DecodedMatmul &mm = decoded.matmul;
+  mm.A = A_base + A_r.getStart() * A_fullCols + A_c.getStart();
+  mm.B = B_base + B_r.getStart() * B_fullCols + B_c.getStart();
+  mm.C = C_base + C_r.getStart() * C_fullCols + C_c.getStart();
+  mm.aRowStride = A_r.getStride() * A_fullCols;
+  mm.aColStride = A_c.getStride();
+  mm.bRowStride = B_r.getStride() * B_fullCols;
+  mm.bColStride = B_c.getStride();
+  mm.cRowStride = C_r.getStride() * C_fullCols;
+  mm.cColStride = C_c.getStride();
+  mm.M = M;
+  mm.N = N;
+  mm.K = K;
+
   // -----------------------------
-  // Perform Matmul: C = A * B
+  // Aliasing
   // -----------------------------
-  for (int m = 0; m < M; ++m) {
-    for (int n = 0; n < N; ++n) {
-      // compute C(m,n) initial value
-      float sum = accumulate ? 0.0f : 0.0f;
+  // When C overlaps A or B, the loop reads operands after earlier C elements
+  // were written back, so the op must neither be reordered by the SIMD
+  // kernels nor split into concurrent pieces.
+  auto end = [](const float *x, int rows, int cols, int32_t rowStride,
+                int32_t colStride) {
+    return x + static_cast<ptrdiff_t>(rows - 1) * rowStride +
+           static_cast<ptrdiff_t>(cols - 1) * colStride + 1;
+  };
+  auto overlaps = [](const float *x, const float *xEnd, const float *y,
+                     const float *yEnd) { return x < yEnd && y < xEnd; };
 
-      if (!accumulate) {
-        sum = 0.0f;
-      } else {
-        int Cm = C_r.getStart() + m * C_r.getStride();
-        int Cn = C_c.getStart() + n * C_c.getStride();
-        size_t C_offset = Cm * C_fullCols + Cn;
-        sum = C_base[C_offset]; // accumulate existing value
-      }
+  if (M > 0 && N > 0 && K > 0) {
+    const float *aEnd = end(mm.A, M, K, mm.aRowStride, mm.aColStride);
+    const float *bEnd = end(mm.B, K, N, mm.bRowStride, mm.bColStride);
+    const float *cEnd = end(mm.C, M, N, mm.cRowStride, mm.cColStride);
+    if (overlaps(mm.C, cEnd, mm.A, aEnd) || overlaps(mm.C, cEnd, mm.B, bEnd))
+      decoded.flags |= DecodedOp::ALIASED;
+  }
 
-      // compute dot product for this element
-      for (int k = 0; k < K; ++k) {
-        int Ar = A_r.getStart() + m * A_r.getStride();
-        int Ac = A_c.getStart() + k * A_c.getStride();
-        int Br = B_r.getStart() + k * B_r.getStride();
-        int Bc = B_c.getStart() + n * B_c.getStride();
+  // -----------------------------
+  // Fast path: unit-stride 32x32x32 tile
+  // -----------------------------
+  // The register-blocked SIMD kernels are bit-for-bit identical to the
+  // generic loop on operands that do not alias.
+  bool unitStride = mm.aColStride == 1 && mm.bColStride == 1 &&
+                    mm.cColStride == 1 && A_r.getStride() == 1 &&
+                    B_r.getStride() == 1 && C_r.getStride() == 1;
+
+  if (unitStride && M == EPU_MM_TILE && N == EPU_MM_TILE &&
+      K == EPU_MM_TILE && !decoded.hasFlag(DecodedOp::ALIASED))
+    decoded.flags |= DecodedOp::TILE32;
+}
+
+void EPUSimulator::decodeSync(int semaphore, DecodedOp &decoded) const {
+  DecodedSync &sync = decoded.sync;
+  sync.semaphore = semaphore;
+  sync.coreMask = 0;
+  sync.signalOp = -1;
+
+  if (sync.semaphore < 0 || decoded.core < 0 || decoded.core >= numberOfCores)
+    decoded.error = DecodedOp::INVALID_SYNC_OPERAND;
+}
+
+void EPUSimulator::decodeBarrier(const std::vector<ID> &cores,
+                                 DecodedOp &decoded) const {
+  DecodedSync &sync = decoded.sync;
+  sync.semaphore = -1;
+  sync.coreMask = 0;
+  sync.signalOp = -1;
+
+  for (ID core : cores) {
+    if (core < 0 || core >= numberOfCores || core >= 32) {
+      decoded.error = DecodedOp::INVALID_SYNC_OPERAND;
+      return;
+    }
+    sync.coreMask |= 1u << core;
+  }
+}
+
+void EPUSimulator::decodeAsync(int dmaToken, DecodedOp &decoded) const {
+  if (dmaToken >= 0) {
+    decoded.flags |= DecodedOp::ASYNC;
+    decoded.dmaToken = dmaToken;
+  }
+}
+
+void EPUSimulator::decodeDMAWait(int dmaToken, DecodedOp &decoded) const {
+  decoded.dmaToken = dmaToken;
+  if (decoded.dmaToken < 0 || decoded.core < 0 ||
+      decoded.core >= numberOfCores)
+    decoded.error = DecodedOp::INVALID_DMA_OPERAND;
+}
+
+DecodedOp EPUSimulator::decodeOp(Op *op) const {
+  DecodedOp decoded;
+  decoded.opCode = op->getOpCode();
+  decoded.core = op->getCoreNum();
+
+  switch (op->getOpCode()) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY: {
+    auto *copy = static_cast<GlobalToLocalMemCopyOp *>(op);
+    decodeGlobalToLocalMemCopy(copy->getSrcSlice(), copy->getDstSlice(),
+                               decoded);
+    decodeAsync(copy->getDMAToken(), decoded);
+    break;
+  }
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY: {
+    auto *copy = static_cast<LocalToGlobalMemCopyOp *>(op);
+    decodeLocalToGlobalMemCopy(copy->getSrcSlice(), copy->getDstSlice(),
+                               decoded);
+    decodeAsync(copy->getDMAToken(), decoded);
+    break;
+  }
+  case OpCode::MATMUL: {
+    auto *matmul = static_cast<MatmulOp *>(op);
+    decodeMatmul(matmul->getMMUnitNum(), matmul->getAccumulate(),
+                 matmul->getSliceA(), matmul->getSliceB(), matmul->getSliceC(),
+                 decoded);
+    break;
+  }
+  case OpCode::START_PARALLEL:
+  case OpCode::END_PARALLEL:
+    break;
+  case OpCode::SIGNAL:
+    decodeSync(static_cast<SignalOp *>(op)->getSemaphore(), decoded);
+    break;
+  case OpCode::WAIT:
+    decodeSync(static_cast<WaitOp *>(op)->getSemaphore(), decoded);
+    break;
+  case OpCode::BARRIER:
+    decodeBarrier(static_cast<BarrierOp *>(op)->getCores(), decoded);
+    break;
+  case OpCode::DMA_WAIT:
+    decodeDMAWait(static_cast<DMAWaitOp *>(op)->getDMAToken(), decoded);
+    break;
+  default:
+    throw std::runtime_error("Unhandled op");
+  }
+
+  return decoded;
+}
+
+DecodedOp EPUSimulator::decodeOp(const EPUProgram &program, size_t i) const {
+  const EPUProgram::Instr &instr = program.getInstr(i);
+  DecodedOp decoded;
+  decoded.opCode = instr.opCode;
+  decoded.core = instr.core;
+
+  switch (instr.opCode) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY:
+    decodeGlobalToLocalMemCopy(program.getSlice(i, 0), program.getSlice(i, 1),
+                               decoded);
+    decodeAsync(instr.imm, decoded);
+    break;
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY:
+    decodeLocalToGlobalMemCopy(program.getSlice(i, 0), program.getSlice(i, 1),
+                               decoded);
+    decodeAsync(instr.imm, decoded);
+    break;
+  case OpCode::MATMUL:
+    decodeMatmul(instr.imm, (instr.flags & EPUProgram::ACCUMULATE) != 0,
+                 program.getSlice(i, 0), program.getSlice(i, 1),
+                 program.getSlice(i, 2), decoded);
+    break;
+  case OpCode::START_PARALLEL:
+  case OpCode::END_PARALLEL:
+    break;
+  case OpCode::SIGNAL:
+  case OpCode::WAIT:
+    decodeSync(instr.imm, decoded);
+    break;
+  case OpCode::BARRIER:
+    decodeBarrier(program.getBarrierCores(i), decoded);
+    break;
+  case OpCode::DMA_WAIT:
+    decodeDMAWait(instr.imm, decoded);
+    break;
+  default:
+    throw std::runtime_error("Unhandled op");
+  }
+
+  return decoded;
+}
+
+void EPUSimulator::finishDecode(EPUDecodedProgram &program) const {
+  // The n-th wait on a semaphore consumes its n-th signal, which must come
+  // earlier in the program so every execution mode can honor it.
+  std::map<int32_t, std::deque<int32_t>> pendingSignals;
+  for (size_t i = 0; i < program.ops.size(); ++i) {
+    DecodedOp &op = program.ops[i];
+    if (op.error != DecodedOp::NONE)
+      continue;
+
+    if (op.opCode == OpCode::SIGNAL) {
+      pendingSignals[op.sync.semaphore].push_back(i);
+    } else if (op.opCode == OpCode::WAIT) {
+      std::deque<int32_t> &signals = pendingSignals[op.sync.semaphore];
+      if (signals.empty())
+        throw std::runtime_error(
+            "wait on semaphore " + std::to_string(op.sync.semaphore) +
+            " (instruction " + std::to_string(i) +
+            ") has no earlier signal to consume");
+      op.sync.signalOp = signals.front();
+      signals.pop_front();
+    }
+  }
 
-        size_t A_offset = Ar * A_fullCols + Ac;
-        size_t B_offset = Br * B_fullCols + Bc;
+  if (options.concurrentMatmulUnits)
+    findMatmulGroups(program.ops.data(), program.ops.size(),
+                     program.matmulGroups);
+}
+
+EPUDecodedProgram EPUSimulator::decode(
+    const std::vector<std::unique_ptr<Op>> &instructions) const {
+  EPUDecodedProgram program;
+  program.owner = this;
+  program.handleEpoch = handleEpoch;
+
+  program.ops.reserve(instructions.size());
+  for (auto &inst : instructions)
+    program.ops.push_back(decodeOp(inst.get()));
+
+  finishDecode(program);
+  return program;
+}
+
+EPUDecodedProgram EPUSimulator::decode(const EPUProgram &instructions) const {
+  EPUDecodedProgram program;
+  program.owner = this;
+  program.handleEpoch = handleEpoch;
+
+  program.ops.reserve(instructions.size());
+  for (size_t i = 0; i < instructions.size(); ++i)
+    program.ops.push_back(decodeOp(instructions, i));
+
+  finishDecode(program);
+  return program;
+}
+
+static bool footprintsConflict(const OpFootprint &a, const OpFootprint &b) {
+  auto overlapsAny = [](const MemoryRange &range,
+                        const std::vector<MemoryRange> &ranges) {
+    for (const MemoryRange &other : ranges)
+      if (range.getSpaceKey() == other.getSpaceKey() && range.overlaps(other))
+        return true;
+    return false;
+  };
+
+  for (const MemoryRange &write : a.writes)
+    if (overlapsAny(write, b.reads) || overlapsAny(write, b.writes))
+      return true;
+  for (const MemoryRange &read : a.reads)
+    if (overlapsAny(read, b.writes))
+      return true;
+  return false;
+}
 
-        sum += A_base[A_offset] * B_base[B_offset];
+void EPUSimulator::findMatmulGroups(
+    const DecodedOp *ops, uint32_t numOps,
+    std::vector<EPUDecodedProgram::MatmulGroup> &groups) const {
+
+  // Ops of the group being grown, with their footprints.
+  std::vector<uint32_t> members;
+  std::vector<OpFootprint> footprints;
+  uint32_t groupBegin = 0;
+
+  auto closeGroup = [&](uint32_t end) {
+    bool multipleUnits = false;
+    for (uint32_t op : members)
+      multipleUnits |= ops[op].core != ops[members.front()].core ||
+                       ops[op].mmUnit != ops[members.front()].mmUnit;
+    if (multipleUnits)
+      groups.push_back({groupBegin, end});
+    members.clear();
+    footprints.clear();
+    groupBegin = end;
+  };
+
+  bool inRegion = false;
+  for (uint32_t i = 0; i < numOps; ++i) {
+    const DecodedOp &op = ops[i];
+    if (op.opCode == OpCode::START_PARALLEL)
+      inRegion = true;
+    else if (op.opCode == OpCode::END_PARALLEL)
+      inRegion = false;
+
+    if (inRegion || op.opCode != OpCode::MATMUL ||
+        op.error != DecodedOp::NONE) {
+      closeGroup(i);
+      groupBegin = i + 1;
+      continue;
+    }
+
+    // A unit's queue keeps its own ops in order; an op touching memory of
+    // another unit's op has to wait for the next group.
+    OpFootprint footprint = computeFootprint(op);
+    for (size_t m = 0; m < members.size(); ++m) {
+      const DecodedOp &member = ops[members[m]];
+      if ((member.core != op.core || member.mmUnit != op.mmUnit) &&
+          footprintsConflict(footprint, footprints[m])) {
+        closeGroup(i);
+        break;
       }
+    }
+
+    members.push_back(i);
+    footprints.push_back(std::move(footprint));
+  }
+  closeGroup(numOps);
+}
+
+// ============================================================
+// Execution
+// ============================================================
+
+void EPUSimulator::reportDecodeError(const DecodedOp &op) const {
+  switch (op.error) {
+  case DecodedOp::UNKNOWN_INPUT_HANDLE:
+    std::cerr << "ERROR: Unknown global handle " << op.handleId << "\n";
+    break;
+  case DecodedOp::UNKNOWN_OUTPUT_HANDLE:
+    std::cerr << "ERROR: Unknown global output handle " << op.handleId << "\n";
+    break;
+  case DecodedOp::GLOBAL_TO_LOCAL_SHAPE_MISMATCH:
+    std::cerr << "ERROR: mismatched source/destination slice shapes!\n";
+    break;
+  case DecodedOp::LOCAL_TO_GLOBAL_SHAPE_MISMATCH:
+    std::cerr << "ERROR: Local→Global slice shape mismatch!\n";
+    break;
+  case DecodedOp::MATMUL_DIM_MISMATCH:
+    std::cerr << "ERROR: Matmul dimension mismatch: A.cols != B.rows\n";
+    break;
+  case DecodedOp::MATMUL_OUTPUT_SHAPE_MISMATCH:
+    std::cerr << "ERROR: Matmul output slice shape mismatch\n";
+    break;
+  case DecodedOp::INVALID_SYNC_OPERAND:
+    std::cerr << "ERROR: Invalid core or semaphore in synchronization op\n";
+    break;
+  case DecodedOp::INVALID_DMA_OPERAND:
+    std::cerr << "ERROR: Invalid core or token in dma_wait\n";
+    break;
+  case DecodedOp::INVALID_MATMUL_UNIT:
+    std::cerr << "ERROR: Invalid matmul unit\n";
+    break;
+  case DecodedOp::INVALID_CORE:
+    std::cerr << "ERROR: Invalid core " << op.core << "\n";
+    break;
+  default:
+    break;
+  }
+}
+
+void EPUSimulator::executeMatmul(const DecodedOp &op) {
+  const DecodedMatmul &mm = op.matmul;
+  bool accumulate = op.hasFlag(DecodedOp::ACCUMULATE);
+
+  if (op.hasFlag(DecodedOp::TILE32)) {
+    matmulTile32(mm.A, mm.aRowStride, mm.B, mm.bRowStride, mm.C, mm.cRowStride,
+                 accumulate);
+    return;
+  }
+
+  // -----------------------------
+  // Perform Matmul: C = A * B
+  // -----------------------------
+  for (int m = 0; m < mm.M; ++m) {
+    for (int n = 0; n < mm.N; ++n) {
+      // compute C(m,n) initial value, accumulating the existing value
+      float *c = mm.C + m * mm.cRowStride + n * mm.cColStride;
+      float sum = accumulate ? *c : 0.0f;
+
+      // compute dot product for this element
+      const float *a = mm.A + m * mm.aRowStride;
+      const float *b = mm.B + n * mm.bColStride;
+      for (int k = 0; k < mm.K; ++k)
+        sum += a[k * mm.aColStride] * b[k * mm.bRowStride];
 
       // write back C(m,n)
-      int Cm = C_r.getStart() + m * C_r.getStride();
-      int Cn = C_c.getStart() + n * C_c.getStride();
-      size_t C_offset = Cm * C_fullCols + Cn;
-      C_base[C_offset] = sum;
+      *c = sum;
     }
   }
 }
 
-void EPUSimulator::execute(Op *inst) {
-  if (auto *mm = dynamic_cast<MatmulOp *>(inst)) {
-    executeMatmul(mm);
-  } else if (auto *gtl = dynamic_cast<GlobalToLocalMemCopyOp *>(inst)) {
-    executeGlobalToLocalMemCopy(gtl);
-  } else if (auto *ltg = dynamic_cast<LocalToGlobalMemCopyOp *>(inst)) {
-    executeLocalToGlobalMemCopy(ltg);
+void EPUSimulator::nameProfilerEvents() {
+  profiler.setOpTypeName(OpCode::GLOBAL_TO_LOCAL_MEM_COPY,
+                         "cp_global_to_local");
+  profiler.setOpTypeName(OpCode::LOCAL_TO_GLOBAL_MEM_COPY,
+                         "cp_local_to_global");
+  profiler.setOpTypeName(OpCode::MATMUL, "matmul");
+  profiler.setOpTypeName(OpCode::SIGNAL, "signal");
+  profiler.setOpTypeName(OpCode::WAIT, "wait");
+  profiler.setOpTypeName(OpCode::BARRIER, "barrier");
+  profiler.setOpTypeName(OpCode::DMA_WAIT, "dma_wait");
+
+  // Lane 0 is the core's DMA engine, lane 1 + u its matmul unit u.
+  profiler.setLaneName(0, "dma");
+  for (int unit = 0; unit < processor.getMMUnitsPerCore(); ++unit)
+    profiler.setLaneName(1 + unit, "mm unit " + std::to_string(unit));
+}
+
+void EPUSimulator::executeProfiled(const DecodedOp &op, uint64_t readyNs) {
+  uint64_t startNs = SimulatorProfiler::nowNs();
+  runDecoded(op);
+  uint64_t endNs = SimulatorProfiler::nowNs();
+
+  if (op.error != DecodedOp::NONE) {
+    profiler.record(op.opCode, op.core, 0, readyNs, startNs, endNs, 0, 0);
+    return;
+  }
+
+  uint64_t bytes = 0;
+  uint64_t flops = 0;
+  int lane = 0;
+  if (op.opCode == OpCode::MATMUL) {
+    const DecodedMatmul &mm = op.matmul;
+    flops = 2ull * mm.M * mm.N * mm.K;
+    lane = 1 + op.mmUnit;
+  } else if (op.opCode == OpCode::GLOBAL_TO_LOCAL_MEM_COPY ||
+             op.opCode == OpCode::LOCAL_TO_GLOBAL_MEM_COPY) {
+    bytes = op.copy.getNumBytes();
+  }
+
+  profiler.record(op.opCode, op.core, lane, readyNs, startNs, endNs, bytes,
+                  flops);
+}
+
+void EPUSimulator::executeDecoded(const DecodedOp &op, uint64_t readyNs) {
+  if (profiler.isEnabled()) {
+    executeProfiled(op, readyNs);
+    return;
+  }
+
+  runDecoded(op);
+}
+
+int EPUSimulator::getIntraOpSplit(const DecodedOp &op) const {
+  unsigned maxPieces = threadPool.getNumThreads() + 1;
+  // Queued work already keeps the workers busy.
+  if (maxPieces < 2 || threadPool.getNumQueuedTasks() > 0)
+    return 1;
+
+  uint64_t pieces = 1;
+  switch (op.opCode) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY:
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY: {
+    const CopyPlan &plan = op.copy;
+    if (options.intraOpMinBytes == 0 || plan.kind == CopyPlan::EMPTY ||
+        plan.kind == CopyPlan::INVALID)
+      return 1;
+    pieces = plan.getNumBytes() / options.intraOpMinBytes;
+    pieces = std::min<uint64_t>(pieces, std::max(plan.rows, plan.cols));
+    break;
+  }
+  case OpCode::MATMUL: {
+    const DecodedMatmul &mm = op.matmul;
+    // Pieces of an aliased matmul would read rows others are writing.
+    if (options.intraOpMinFlops == 0 || op.hasFlag(DecodedOp::ALIASED))
+      return 1;
+    pieces = 2ull * mm.M * mm.N * mm.K / options.intraOpMinFlops;
+    pieces = std::min<uint64_t>(pieces, mm.M);
+    break;
+  }
+  default:
+    return 1;
+  }
+
+  return static_cast<int>(std::max<uint64_t>(
+      1, std::min<uint64_t>(pieces, maxPieces)));
+}
+
+DecodedOp EPUSimulator::splitDecoded(const DecodedOp &op, int part,
+                                     int numParts) const {
+  DecodedOp piece = op;
+
+  if (op.opCode == OpCode::MATMUL) {
+    // Without aliasing, output rows are independent and each element is
+    // reduced exactly as in the whole op, so pieces are bit-identical to
+    // running it unsplit.
+    const DecodedMatmul &mm = op.matmul;
+    int begin = static_cast<int>(static_cast<int64_t>(mm.M) * part / numParts);
+    int end =
+        static_cast<int>(static_cast<int64_t>(mm.M) * (part + 1) / numParts);
+    piece.matmul.M = end - begin;
+    piece.matmul.A += static_cast<ptrdiff_t>(begin) * mm.aRowStride;
+    piece.matmul.C += static_cast<ptrdiff_t>(begin) * mm.cRowStride;
+    // The 32x32 kernel needs a whole tile.
+    piece.flags &= ~DecodedOp::TILE32;
   } else {
+    piece.copy = splitCopyPlan(op.copy, part, numParts);
+  }
+
+  return piece;
+}
+
+void EPUSimulator::runDecoded(const DecodedOp &op) {
+  if (op.error != DecodedOp::NONE) {
+    reportDecodeError(op);
+    return;
+  }
+
+  int numPieces = getIntraOpSplit(op);
+  if (numPieces > 1) {
+    // Runs on a worker too when the op itself is a pool task; waiting
+    // helps with the pieces, so nesting cannot deadlock.
+    EPUTaskGroup pieces;
+    for (int part = 1; part < numPieces; ++part)
+      threadPool.submit(pieces, [this, &op, part, numPieces]() {
+        runDecodedPiece(splitDecoded(op, part, numPieces));
+      });
+    try {
+      runDecodedPiece(splitDecoded(op, 0, numPieces));
+    } catch (...) {
+      threadPool.wait(pieces);
+      throw;
+    }
+    threadPool.wait(pieces);
+    return;
+  }
+
+  runDecodedPiece(op);
+}
+
+void EPUSimulator::runDecodedPiece(const DecodedOp &op) {
+
+  switch (op.opCode) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY:
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY:
+    runCopyPlan(op.copy);
+    return;
+  case OpCode::MATMUL:
+    executeMatmul(op);
+    return;
+  case OpCode::SIGNAL:
+  case OpCode::WAIT:
+  case OpCode::BARRIER:
+  case OpCode::DMA_WAIT:
+    // The ordering they impose is enforced by the scheduler of each
+    // execution mode; there is nothing left to do when they run.
+    return;
+  default:
     throw std::runtime_error("Unhandled op");
   }
 }
 
+void EPUSimulator::execute(Op *inst) { executeDecoded(decodeOp(inst)); }
+
+void EPUSimulator::dispatchParallelRegion(const DecodedOp *begin,
+                                          const DecodedOp *end) {
+  // Hand every op of the region to the persistent worker pool, and async
+  // copies to the DMA pool; waiting for both is the end_parallel join.
+  // Synchronization ops order only the cores they name, through a
+  // dependency graph of the region.
+  uint64_t readyNs = profiler.isEnabled() ? SimulatorProfiler::nowNs() : 0;
+
+  try {
+    if (std::any_of(begin, end,
+                    [](const DecodedOp &op) { return op.isSync(); })) {
+      dispatchSyncRegion(begin, end);
+    } else {
+      EPUTaskGroup region;
+      for (const DecodedOp *op = begin; op != end; ++op) {
+        if (op->hasFlag(DecodedOp::ASYNC) && op->error == DecodedOp::NONE) {
+          issueDMA(*op, readyNs);
+          continue;
+        }
+        threadPool.submit(region, [this, op, readyNs]() {
+          this->executeDecoded(*op, readyNs);
+        });
+      }
+
+      threadPool.wait(region);
+    }
+  } catch (...) {
+    // Copies still in flight may point into the region's records.
+    try {
+      waitDMA(ALL_DMA, ALL_DMA);
+    } catch (...) {
+    }
+    throw;
+  }
+
+  waitDMA(ALL_DMA, ALL_DMA);
+}
+
+void EPUSimulator::dispatchMatmulGroup(const DecodedOp *begin,
+                                       const DecodedOp *end) {
+  // One task per unit, running that unit's matmuls in program order.
+  std::vector<std::vector<const DecodedOp *>> queues;
+  std::vector<std::pair<int32_t, uint8_t>> units;
+  for (const DecodedOp *op = begin; op != end; ++op) {
+    std::pair<int32_t, uint8_t> unit(op->core, op->mmUnit);
+    size_t queue = std::find(units.begin(), units.end(), unit) - units.begin();
+    if (queue == units.size()) {
+      units.push_back(unit);
+      queues.emplace_back();
+    }
+    queues[queue].push_back(op);
+  }
+
+  uint64_t readyNs = profiler.isEnabled() ? SimulatorProfiler::nowNs() : 0;
+  EPUTaskGroup group;
+  for (const auto &queue : queues)
+    threadPool.submit(group, [this, &queue, readyNs]() {
+      for (const DecodedOp *op : queue)
+        this->executeDecoded(*op, readyNs);
+    });
+  threadPool.wait(group);
+}
+
+void EPUSimulator::issueDMA(const DecodedOp &op, uint64_t readyNs) {
+  EPUTaskGroup *group;
+  {
+    std::lock_guard<std::mutex> lock(dmaMutex);
+    std::unique_ptr<EPUTaskGroup> &slot = dmaInFlight[{op.core, op.dmaToken}];
+    if (!slot)
+      slot = std::make_unique<EPUTaskGroup>();
+    group = slot.get();
+  }
+
+  if (profiler.isEnabled() && readyNs == 0)
+    readyNs = SimulatorProfiler::nowNs();
+  // The record is copied: a streamed op is gone once it has been issued.
+  dmaPool.submit(*group, [this, op, readyNs]() {
+    this->executeDecoded(op, readyNs);
+  });
+}
+
+void EPUSimulator::waitDMA(int32_t core, int32_t token) {
+  std::vector<std::unique_ptr<EPUTaskGroup>> groups;
+  {
+    std::lock_guard<std::mutex> lock(dmaMutex);
+    for (auto it = dmaInFlight.begin(); it != dmaInFlight.end();) {
+      if ((core == ALL_DMA || it->first.first == core) &&
+          (token == ALL_DMA || it->first.second == token)) {
+        groups.push_back(std::move(it->second));
+        it = dmaInFlight.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Wait for every group before rethrowing, as the copies reference
+  // records owned by the caller.
+  std::exception_ptr error;
+  for (auto &group : groups) {
+    try {
+      dmaPool.wait(*group);
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void EPUSimulator::executeInOrder(const DecodedOp &op, uint64_t readyNs) {
+  if (op.error != DecodedOp::NONE) {
+    executeDecoded(op, readyNs);
+    return;
+  }
+
+  if (op.hasFlag(DecodedOp::ASYNC)) {
+    issueDMA(op, readyNs);
+    return;
+  }
+
+  switch (op.opCode) {
+  case OpCode::DMA_WAIT:
+    waitDMA(op.core, op.dmaToken);
+    break;
+  case OpCode::SIGNAL:
+    // A signal covers every earlier op of its core, copies in flight too.
+    waitDMA(op.core, ALL_DMA);
+    break;
+  case OpCode::BARRIER:
+    for (int32_t core = 0; core < numberOfCores && core < 32; ++core)
+      if (op.sync.coreMask & (1u << core))
+        waitDMA(core, ALL_DMA);
+    break;
+  default:
+    break;
+  }
+
+  executeDecoded(op, readyNs);
+}
+
 void EPUSimulator::dispatchParallelInstructions(
     const std::vector<Op *> &insts) {
+  FrozenHandleScope frozen(*this);
 
-  // Example implementation:
-  // Each Op goes to a different thread or different core simulation.
-  std::vector<std::thread> workers;
+  std::vector<DecodedOp> decoded;
+  decoded.reserve(insts.size());
+  for (Op *op : insts)
+    decoded.push_back(decodeOp(op));
 
-  for (Op *op : insts) {
-    workers.emplace_back([this, op]() {
-      std::cout << "Thread ID: " << std::this_thread::get_id()
-                << " executing op: " << op << std::endl;
-      this->execute(op);
-    });
+  dispatchParallelRegion(decoded.data(), decoded.data() + decoded.size());
+}
+
+// ============================================================
+// Dataflow execution
+// ============================================================
+
+// Bounding host address range of a 2D strided operand.
+static void appendRange(MemoryRange::SpaceKind kind, int spaceId,
+                        const float *first, int rows, int cols,
+                        ptrdiff_t rowStride, ptrdiff_t colStride,
+                        std::vector<MemoryRange> &ranges) {
+  if (rows <= 0 || cols <= 0)
+    return;
+
+  const float *last = first + (rows - 1) * rowStride + (cols - 1) * colStride;
+  ranges.push_back({kind, spaceId, reinterpret_cast<uintptr_t>(first),
+                    reinterpret_cast<uintptr_t>(last + 1)});
+}
+
+OpFootprint EPUSimulator::computeFootprint(const DecodedOp &op) const {
+  OpFootprint footprint;
+
+  if (op.error != DecodedOp::NONE) {
+    footprint.isBarrier = true;
+    return footprint;
+  }
+
+  switch (op.opCode) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY: {
+    const CopyPlan &plan = op.copy;
+    appendRange(MemoryRange::GLOBAL, op.handleId, plan.src, plan.rows,
+                plan.cols, plan.srcRowPitch, plan.srcColStride,
+                footprint.reads);
+    appendRange(MemoryRange::LOCAL, op.core, plan.dst, plan.rows, plan.cols,
+                plan.dstRowPitch, plan.dstColStride, footprint.writes);
+    break;
+  }
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY: {
+    const CopyPlan &plan = op.copy;
+    appendRange(MemoryRange::LOCAL, op.core, plan.src, plan.rows, plan.cols,
+                plan.srcRowPitch, plan.srcColStride, footprint.reads);
+    appendRange(MemoryRange::GLOBAL, op.handleId, plan.dst, plan.rows,
+                plan.cols, plan.dstRowPitch, plan.dstColStride,
+                footprint.writes);
+    break;
+  }
+  case OpCode::MATMUL: {
+    const DecodedMatmul &mm = op.matmul;
+    appendRange(MemoryRange::LOCAL, op.core, mm.A, mm.M, mm.K, mm.aRowStride,
+                mm.aColStride, footprint.reads);
+    appendRange(MemoryRange::LOCAL, op.core, mm.B, mm.K, mm.N, mm.bRowStride,
+                mm.bColStride, footprint.reads);
+    appendRange(MemoryRange::LOCAL, op.core, mm.C, mm.M, mm.N, mm.cRowStride,
+                mm.cColStride, footprint.writes);
+    if (op.hasFlag(DecodedOp::ACCUMULATE))
+      footprint.reads.insert(footprint.reads.end(), footprint.writes.begin(),
+                             footprint.writes.end());
+    break;
+  }
+  case OpCode::SIGNAL:
+  case OpCode::WAIT:
+  case OpCode::BARRIER:
+  case OpCode::DMA_WAIT:
+    // No memory access; their ordering is added separately.
+    break;
+  default:
+    // Anything we cannot reason about is ordered against everything else.
+    footprint.isBarrier = true;
+    break;
+  }
+
+  return footprint;
+}
+
+void EPUSimulator::buildDependencyGraph(const EPUDecodedProgram &program,
+                                        std::vector<const DecodedOp *> &ops,
+                                        EPUDependencyGraph &graph) const {
+  EPUSyncOrdering sync(graph, numberOfCores, program.ops.size());
+
+  for (size_t i = 0; i < program.ops.size(); ++i) {
+    const DecodedOp &op = program.ops[i];
+    if (op.opCode == OpCode::START_PARALLEL ||
+        op.opCode == OpCode::END_PARALLEL)
+      continue;
+
+    ops.push_back(&op);
+    sync.addOp(i, op, graph.addOp(computeFootprint(op)));
+  }
+}
+
+void EPUSimulator::simulateDataflow(const EPUDecodedProgram &program) {
+  // -----------------------------
+  // Build the dependency DAG
+  // -----------------------------
+  std::vector<const DecodedOp *> ops;
+  EPUDependencyGraph graph;
+  buildDependencyGraph(program, ops, graph);
+
+  runGraph(ops, graph, &EPUSimulator::executeDecoded);
+}
+
+void EPUSimulator::dispatchSyncRegion(const DecodedOp *begin,
+                                      const DecodedOp *end) {
+  // Region ops are not ordered by memory, only by the sync ops: cores a
+  // sync op does not name keep running past it.
+  std::vector<const DecodedOp *> ops;
+  EPUDependencyGraph graph;
+  EPUSyncOrdering sync(graph, numberOfCores);
+  for (const DecodedOp *op = begin; op != end; ++op) {
+    ops.push_back(op);
+    sync.addOp(ops.size() - 1, *op, graph.addOp(OpFootprint()));
+  }
+
+  runGraph(ops, graph, &EPUSimulator::executeInOrder);
+}
+
+void EPUSimulator::runGraph(const std::vector<const DecodedOp *> &ops,
+                            const EPUDependencyGraph &graph,
+                            void (EPUSimulator::*execute)(const DecodedOp &,
+                                                          uint64_t)) {
+  std::unique_ptr<std::atomic<uint32_t>[]> remaining(
+      new std::atomic<uint32_t>[ops.size()]);
+  for (uint32_t i = 0; i < ops.size(); ++i)
+    remaining[i].store(graph.getNumPredecessors(i), std::memory_order_relaxed);
+
+  EPUTaskGroup group;
+  std::function<void(uint32_t, uint64_t)> runOp;
+
+  auto submitOp = [&](uint32_t op) {
+    uint64_t readyNs = profiler.isEnabled() ? SimulatorProfiler::nowNs() : 0;
+    threadPool.submit(group, [&runOp, op, readyNs]() { runOp(op, readyNs); });
+  };
+
+  // Runs an op, then releases its successors. The first successor that
+  // becomes ready is run right away on the same thread; the rest go back to
+  // the pool. `readyNs` is when the op was queued, for the profiler.
+  runOp = [&](uint32_t op, uint64_t readyNs) {
+    while (true) {
+      (this->*execute)(*ops[op], readyNs);
+      readyNs = 0;
+
+      int64_t next = -1;
+      for (uint32_t succ : graph.getSuccessors(op)) {
+        if (remaining[succ].fetch_sub(1, std::memory_order_acq_rel) != 1)
+          continue;
+        if (next < 0)
+          next = succ;
+        else
+          submitOp(succ);
+      }
+
+      if (next < 0)
+        return;
+      op = next;
+    }
+  };
+
+  for (uint32_t i = 0; i < ops.size(); ++i) {
+    if (graph.getNumPredecessors(i) == 0)
+      submitOp(i);
+  }
+
+  threadPool.wait(group);
+}
+
+// ============================================================
+// Per-core execution
+// ============================================================
+
+void EPUSimulator::buildCoreStreams(const EPUDecodedProgram &program,
+                                    std::vector<CoreStream> &streams) const {
+  // Stream c runs core c's ops, and stream numCores + c the async copies
+  // of core c, so they overlap with the core's other ops.
+  const uint32_t numCores = numberOfCores;
+  const uint32_t numStreams = 2 * numCores;
+  streams.assign(numStreams, CoreStream());
+
+  // Stream and stream position of every graph node, and the progress each
+  // node needs from every stream before it may start.
+  std::vector<uint32_t> nodeCore;
+  std::vector<uint32_t> nodePosition;
+  std::vector<uint32_t> needs;
+
+  // Stream lengths at the last end_parallel, which every core's next op
+  // joins on.
+  std::vector<uint32_t> join(numStreams, 0);
+  std::vector<bool> joinPending(numStreams, false);
+
+  EPUDependencyGraph graph;
+  EPUSyncOrdering sync(graph, numCores, program.ops.size());
+  for (size_t i = 0; i < program.ops.size(); ++i) {
+    const DecodedOp &op = program.ops[i];
+    if (op.opCode == OpCode::START_PARALLEL)
+      continue;
+    if (op.opCode == OpCode::END_PARALLEL) {
+      for (uint32_t core = 0; core < numStreams; ++core) {
+        join[core] = streams[core].ops.size();
+        joinPending[core] = true;
+      }
+      continue;
+    }
+
+    // Ops with an invalid core only report their decode error.
+    uint32_t core = op.core >= 0 && static_cast<uint32_t>(op.core) < numCores
+                        ? op.core
+                        : 0;
+    if (op.hasFlag(DecodedOp::ASYNC) && op.error == DecodedOp::NONE)
+      core += numCores;
+    nodeCore.push_back(core);
+    nodePosition.push_back(streams[core].ops.size());
+    needs.resize(needs.size() + numStreams, 0);
+    if (joinPending[core]) {
+      std::copy(join.begin(), join.end(), needs.end() - numStreams);
+      joinPending[core] = false;
+    }
+
+    streams[core].ops.push_back(&op);
+    sync.addOp(i, op, graph.addOp(computeFootprint(op)));
   }
 
-  for (auto &t : workers)
-    t.join();
+  // Dependencies within a stream hold by construction; the rest become
+  // waits on the producing core's progress.
+  for (uint32_t node = 0; node < graph.size(); ++node)
+    for (uint32_t succ : graph.getSuccessors(node)) {
+      if (nodeCore[succ] == nodeCore[node])
+        continue;
+      uint32_t &need = needs[succ * numStreams + nodeCore[node]];
+      need = std::max(need, nodePosition[node] + 1);
+    }
+
+  // Emit each op's waits, skipping any an earlier op of the same stream
+  // already waited for.
+  std::vector<uint32_t> waited(numStreams * numStreams, 0);
+  for (uint32_t node = 0; node < graph.size(); ++node) {
+    uint32_t core = nodeCore[node];
+    CoreStream &stream = streams[core];
+    stream.waitBegin.push_back(stream.waits.size());
+
+    for (uint32_t other = 0; other < numStreams; ++other) {
+      uint32_t need = needs[node * numStreams + other];
+      uint32_t &done = waited[core * numStreams + other];
+      if (other == core || need <= done)
+        continue;
+      stream.waits.push_back({other, need});
+      done = need;
+    }
+  }
+
+  for (CoreStream &stream : streams)
+    stream.waitBegin.push_back(stream.waits.size());
+}
+
+void EPUSimulator::simulatePerCore(const EPUDecodedProgram &program) {
+  std::vector<CoreStream> streams;
+  buildCoreStreams(program, streams);
+
+  const unsigned numStreams = streams.size();
+  if (!coreThreads)
+    coreThreads = std::make_unique<EPUCoreThreads>(numStreams,
+                                                   options.pinCoreThreads);
+
+  // Ops each stream has completed, on separate cache lines.
+  struct alignas(64) CoreProgress {
+    std::atomic<uint32_t> completed{0};
+  };
+  std::unique_ptr<CoreProgress[]> progress(new CoreProgress[numStreams]);
+  std::atomic<bool> aborted{false};
+
+  // Per stream; folded into the core's stats afterwards.
+  EPUCoreStreamStats streamStats;
+  streamStats.opsExecuted.assign(numStreams, 0);
+  streamStats.crossCoreWaits.assign(numStreams, 0);
+  streamStats.stalls.assign(numStreams, 0);
+  streamStats.stallNs.assign(numStreams, 0);
+
+  coreStreamStats = EPUCoreStreamStats();
+  coreThreads->run([&](unsigned core) {
+    const CoreStream &stream = streams[core];
+    uint64_t stalls = 0;
+    uint64_t stallNs = 0;
+
+    try {
+      for (size_t i = 0; i < stream.ops.size(); ++i) {
+        for (uint32_t w = stream.waitBegin[i]; w < stream.waitBegin[i + 1];
+             ++w) {
+          const StreamWait &wait = stream.waits[w];
+          std::atomic<uint32_t> &completed = progress[wait.core].completed;
+          if (completed.load(std::memory_order_acquire) >= wait.progress)
+            continue;
+
+          ++stalls;
+          uint64_t stallStartNs = SimulatorProfiler::nowNs();
+          while (completed.load(std::memory_order_acquire) < wait.progress) {
+            if (aborted.load(std::memory_order_relaxed))
+              return;
+            std::this_thread::yield();
+          }
+          stallNs += SimulatorProfiler::nowNs() - stallStartNs;
+        }
+
+        executeDecoded(*stream.ops[i]);
+        progress[core].completed.store(i + 1, std::memory_order_release);
+      }
+    } catch (...) {
+      // Release cores waiting for this one.
+      aborted.store(true);
+      throw;
+    }
+
+    streamStats.opsExecuted[core] = stream.ops.size();
+    streamStats.crossCoreWaits[core] = stream.waits.size();
+    streamStats.stalls[core] = stalls;
+    streamStats.stallNs[core] = stallNs;
+  });
+
+  coreStreamStats.opsExecuted.assign(numberOfCores, 0);
+  coreStreamStats.crossCoreWaits.assign(numberOfCores, 0);
+  coreStreamStats.stalls.assign(numberOfCores, 0);
+  coreStreamStats.stallNs.assign(numberOfCores, 0);
+  for (unsigned stream = 0; stream < numStreams; ++stream) {
+    unsigned core = stream % numberOfCores;
+    coreStreamStats.opsExecuted[core] += streamStats.opsExecuted[stream];
+    coreStreamStats.crossCoreWaits[core] +=
+        streamStats.crossCoreWaits[stream];
+    coreStreamStats.stalls[core] += streamStats.stalls[stream];
+    coreStreamStats.stallNs[core] += streamStats.stallNs[stream];
+  }
+}
+
+// ============================================================
+// Simulation entry points
+// ============================================================
+
+void EPUSimulator::simulateDecoded(const EPUDecodedProgram &program) {
+  if (program.owner != this || program.handleEpoch != handleEpoch)
+    throw std::runtime_error(
+        "Decoded program is stale or belongs to another simulator");
+
+  // Nothing may re-register a handle while decoded records point into it.
+  FrozenHandleScope frozen(*this);
+  std::lock_guard<std::mutex> running(simulationMutex);
+
+  if (options.enableTimingModel)
+    timingReport = estimateTiming(program);
+
+  if (options.executionMode == EPUExecutionMode::DATAFLOW) {
+    simulateDataflow(program);
+    return;
+  }
+
+  if (options.executionMode == EPUExecutionMode::PER_CORE) {
+    simulatePerCore(program);
+    return;
+  }
+
+  try {
+    runInOrder(program.ops.data(), program.ops.size(), program.matmulGroups);
+  } catch (...) {
+    try {
+      waitDMA(ALL_DMA, ALL_DMA);
+    } catch (...) {
+    }
+    throw;
+  }
+
+  // Copies nobody waited for complete with the program.
+  waitDMA(ALL_DMA, ALL_DMA);
+}
+
+void EPUSimulator::runInOrder(
+    const DecodedOp *ops, size_t numOps,
+    const std::vector<EPUDecodedProgram::MatmulGroup> &groups) {
+  auto nextGroup = groups.begin();
+
+  size_t i = 0;
+  while (i < numOps) {
+    const DecodedOp &op = ops[i];
+
+    if (nextGroup != groups.end() && nextGroup->begin == i) {
+      dispatchMatmulGroup(ops + nextGroup->begin, ops + nextGroup->end);
+      i = nextGroup->end;
+      ++nextGroup;
+    } else if (op.opCode == OpCode::START_PARALLEL) {
+      // Everything up to the matching end_parallel runs concurrently. A
+      // region left open at the end of the program is joined there.
+      size_t end = i + 1;
+      while (end < numOps && ops[end].opCode != OpCode::END_PARALLEL)
+        ++end;
+
+      dispatchParallelRegion(ops + i + 1, ops + end);
+      i = end + 1;
+    } else if (op.opCode == OpCode::END_PARALLEL) {
+      ++i;
+    } else {
+      executeInOrder(op);
+      ++i;
+    }
+  }
+}
+
+EPUSimulator::~EPUSimulator() {
+  // Runs already launched still complete.
+  {
+    std::lock_guard<std::mutex> lock(asyncMutex);
+    asyncStopping = true;
+  }
+  asyncWakeUp.notify_all();
+  if (asyncWorker.joinable())
+    asyncWorker.join();
+}
+
+void EPUSimulator::asyncWorkerLoop() {
+  while (true) {
+    AsyncRun job;
+    {
+      std::unique_lock<std::mutex> lock(asyncMutex);
+      asyncWakeUp.wait(
+          lock, [this]() { return !asyncRuns.empty() || asyncStopping; });
+      if (asyncRuns.empty())
+        return;
+      job = std::move(asyncRuns.front());
+      asyncRuns.pop_front();
+    }
+
+    std::exception_ptr error;
+    try {
+      job.run();
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    // Release what the run captured, such as its decoded program, before
+    // the caller learns it is done.
+    job.run = nullptr;
+    unfreezeHandles();
+    if (error)
+      job.done.set_exception(error);
+    else
+      job.done.set_value();
+  }
+}
+
+std::future<void> EPUSimulator::launchAsync(std::function<void()> run) {
+  // Freeze now rather than when the worker gets to the run, so
+  // registrations made after this call cannot slip in before it.
+  freezeHandles();
+
+  AsyncRun job;
+  job.run = std::move(run);
+  std::future<void> result = job.done.get_future();
+  {
+    std::lock_guard<std::mutex> lock(asyncMutex);
+    asyncRuns.push_back(std::move(job));
+    if (!asyncWorker.joinable())
+      asyncWorker = std::thread(&EPUSimulator::asyncWorkerLoop, this);
+  }
+  asyncWakeUp.notify_one();
+
+  return result;
+}
+
+std::future<void>
+EPUSimulator::simulateDecodedAsync(const EPUDecodedProgram &program) {
+  return launchAsync([this, &program]() { simulateDecoded(program); });
+}
+
+std::future<void> EPUSimulator::simulateDecodedAsync(
+    std::shared_ptr<const EPUDecodedProgram> program) {
+  return launchAsync([this, program]() { simulateDecoded(*program); });
+}
+
+std::future<void> EPUSimulator::simulateInstructionsAsync(
+    const std::vector<std::unique_ptr<Op>> &instructions) {
+  return simulateDecodedAsync(
+      std::make_shared<const EPUDecodedProgram>(decode(instructions)));
+}
+
+EPUTimingReport
+EPUSimulator::estimateTiming(const EPUDecodedProgram &program) const {
+  EPUTimingModel model(processor);
+
+  // Core streams are scheduled like dataflow ops; the per-core program
+  // order they add is not modeled.
+  if (options.executionMode != EPUExecutionMode::IN_ORDER) {
+    std::vector<const DecodedOp *> ops;
+    EPUDependencyGraph graph;
+    buildDependencyGraph(program, ops, graph);
+    return model.estimateDataflow(ops, graph);
+  }
+
+  return model.estimateInOrder(program);
 }
 
 void EPUSimulator::simulateInstructions(
@@ -305,25 +1360,20 @@ void EPUSimulator::simulateInstructions(
 
   std::cout << "\nTarget Info:\n" << processor.get_device_info() << "\n";
 
-  std::vector<Op *> parallelInstsToDispatch;
-  bool fillToParallelDispatcher = false;
-  for (auto &inst : instructions) {
-    if (auto startParallel = dynamic_cast<StartParallelOp *>(inst.get())) {
-      fillToParallelDispatcher = true;
-    } else if (auto endParallel = dynamic_cast<EndParallelOp *>(inst.get())) {
-      fillToParallelDispatcher = false;
+  simulateDecoded(decode(instructions));
+
+  if (options.enableTimingModel)
+    timingReport.print(std::cout);
+}
 
-      if (!parallelInstsToDispatch.empty()) {
-        // ---- Dispatch all collected instructions in parallel ----
-        dispatchParallelInstructions(parallelInstsToDispatch);
+void EPUSimulator::simulateProgram(const EPUProgram &program) {
+  std::cout << "Starting simulation for target = " << processor.getDeviceName()
+            << "\n";
 
-        parallelInstsToDispatch.clear();
-      }
-    } else {
-      if (fillToParallelDispatcher)
-        parallelInstsToDispatch.push_back(inst.get());
-      else
-        execute(inst.get());
-    }
-  }
-}
\ No newline at end of file
+  std::cout << "\nTarget Info:\n" << processor.get_device_info() << "\n";
+
+  simulateDecoded(decode(program));
+
+  if (options.enableTimingModel)
+    timingReport.print(std::cout);
+}
@@ -0,0 +1,177 @@
+#include "Target/EPU/Parser/EPUAsmParser.h"
+#include "Target/EPU/Parser/EPUBinaryFormat.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/BoundedMPMCQueue.h"
+#include "Utils/MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+// Consecutive matmuls buffered to be grouped across matmul units.
+constexpr size_t MAX_MATMUL_RUN = 64;
+constexpr int SPIN_ITERATIONS = 64;
+
+// Thrown into the parser to stop it once execution has failed.
+struct StreamCancelled {};
+
+void backOff(int &spins) {
+  if (++spins > SPIN_ITERATIONS)
+    std::this_thread::yield();
+}
+} // namespace
+
+void EPUSimulator::simulateStream(
+    const std::function<void(const OpConsumer &)> &produce) {
+  if (options.executionMode != EPUExecutionMode::IN_ORDER)
+    throw std::runtime_error(
+        "Streaming simulation requires the IN_ORDER execution mode");
+
+  // Nothing may re-register a handle while decoded records point into it.
+  FrozenHandleScope frozen(*this);
+  std::lock_guard<std::mutex> running(simulationMutex);
+
+  timingReport = EPUTimingReport();
+  streamStats = EPUStreamStats();
+
+  BoundedMPMCQueue<DecodedOp> queue(options.streamQueueCapacity);
+  std::atomic<bool> parsed{false};
+  std::atomic<bool> cancelled{false};
+  std::atomic<uint64_t> parserStalls{0};
+  std::exception_ptr parseError;
+
+  std::thread parser([&]() {
+    // The n-th wait on a semaphore needs an earlier n-th signal, as in
+    // decode(); in-order execution only has to count them.
+    std::map<int32_t, uint64_t> unconsumedSignals;
+    uint64_t index = 0;
+
+    try {
+      produce([&](std::unique_ptr<Op> op) {
+        if (cancelled.load(std::memory_order_relaxed))
+          throw StreamCancelled();
+
+        DecodedOp decoded = decodeOp(op.get());
+        op.reset();
+
+        if (decoded.error == DecodedOp::NONE &&
+            decoded.opCode == OpCode::SIGNAL) {
+          ++unconsumedSignals[decoded.sync.semaphore];
+        } else if (decoded.error == DecodedOp::NONE &&
+                   decoded.opCode == OpCode::WAIT) {
+          uint64_t &signals = unconsumedSignals[decoded.sync.semaphore];
+          if (signals == 0)
+            throw std::runtime_error(
+                "wait on semaphore " +
+                std::to_string(decoded.sync.semaphore) + " (instruction " +
+                std::to_string(index) + ") has no earlier signal to consume");
+          --signals;
+        }
+        ++index;
+
+        if (queue.tryPush(std::move(decoded)))
+          return;
+        parserStalls.fetch_add(1, std::memory_order_relaxed);
+        for (int spins = 0; !queue.tryPush(std::move(decoded));
+             backOff(spins))
+          if (cancelled.load(std::memory_order_relaxed))
+            throw StreamCancelled();
+      });
+    } catch (const StreamCancelled &) {
+    } catch (...) {
+      parseError = std::current_exception();
+    }
+    parsed.store(true, std::memory_order_release);
+  });
+
+  auto pop = [&](DecodedOp &op) {
+    if (queue.tryPop(op))
+      return true;
+    ++streamStats.executorStalls;
+    for (int spins = 0;; backOff(spins)) {
+      // Read the flag first so ops pushed just before it are not missed.
+      bool done = parsed.load(std::memory_order_acquire);
+      if (queue.tryPop(op))
+        return true;
+      if (done)
+        return false;
+    }
+  };
+
+  // Parallel regions are held up to their end_parallel and matmuls until a
+  // run of them can be grouped; anything else runs as soon as it arrives.
+  std::vector<DecodedOp> window;
+  std::vector<EPUDecodedProgram::MatmulGroup> groups;
+  auto flush = [&]() {
+    streamStats.maxBufferedOps =
+        std::max(streamStats.maxBufferedOps, window.size());
+    groups.clear();
+    if (options.concurrentMatmulUnits)
+      findMatmulGroups(window.data(), window.size(), groups);
+    runInOrder(window.data(), window.size(), groups);
+    window.clear();
+  };
+
+  try {
+    bool inRegion = false;
+    DecodedOp op;
+    while (pop(op)) {
+      ++streamStats.opsStreamed;
+      window.push_back(op);
+      if (op.opCode == OpCode::START_PARALLEL)
+        inRegion = true;
+      else if (op.opCode == OpCode::END_PARALLEL)
+        inRegion = false;
+
+      bool extendsMatmulRun = op.opCode == OpCode::MATMUL &&
+                              op.error == DecodedOp::NONE &&
+                              window.size() < MAX_MATMUL_RUN;
+      if (!inRegion && !extendsMatmulRun)
+        flush();
+    }
+    flush();
+  } catch (...) {
+    cancelled.store(true, std::memory_order_relaxed);
+    parser.join();
+    try {
+      waitDMA(ALL_DMA, ALL_DMA);
+    } catch (...) {
+    }
+    throw;
+  }
+
+  parser.join();
+  streamStats.parserStalls = parserStalls.load();
+
+  // Copies nobody waited for complete with the program.
+  waitDMA(ALL_DMA, ALL_DMA);
+
+  if (parseError)
+    std::rethrow_exception(parseError);
+}
+
+void EPUSimulator::simulateStreaming(const std::string &filename) {
+  MappedFile file(filename);
+  const uint8_t *data = file.getData();
+  size_t size = file.getSize();
+
+  if (isEPUBinary(data, size)) {
+    simulateStream([&](const OpConsumer &consume) {
+      streamEPUBinary(data, size, filename, consume);
+    });
+    return;
+  }
+
+  simulateStreamingText(
+      std::string_view(reinterpret_cast<const char *>(data), size), filename);
+}
+
+void EPUSimulator::simulateStreamingText(std::string_view text,
+                                         const std::string &sourceName) {
+  simulateStream([&](const OpConsumer &consume) {
+    EPUAsmParser parser(processor);
+    parser.parseStream(text, sourceName, consume);
+  });
+}
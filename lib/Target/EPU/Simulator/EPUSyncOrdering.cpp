@@ -0,0 +1,69 @@
+#include "Target/EPU/Simulator/EPUSyncOrdering.h"
+
+void EPUSyncOrdering::joinCore(int core, uint32_t node) {
+  for (uint32_t prev : opsSinceSync[core])
+    graph.addDependency(prev, node);
+  opsSinceSync[core].clear();
+  if (lastSync[core] >= 0)
+    graph.addDependency(lastSync[core], node);
+}
+
+void EPUSyncOrdering::addOp(size_t opIndex, const DecodedOp &op,
+                            uint32_t node) {
+  if (!nodeOfOp.empty())
+    nodeOfOp[opIndex] = node;
+  // Ops with errors are full barriers in the graph already.
+  if (op.error != DecodedOp::NONE || op.core < 0 ||
+      op.core >= static_cast<int>(lastSync.size()))
+    return;
+
+  switch (op.opCode) {
+  case OpCode::SIGNAL:
+    joinCore(op.core, node);
+    lastSync[op.core] = node;
+    if (nodeOfOp.empty())
+      signalsOf[op.sync.semaphore].push_back(node);
+    break;
+  case OpCode::WAIT:
+    if (!nodeOfOp.empty())
+      graph.addDependency(nodeOfOp[op.sync.signalOp], node);
+    else
+      for (uint32_t signal : signalsOf[op.sync.semaphore])
+        graph.addDependency(signal, node);
+    if (nodeOfOp.empty())
+      joinCore(op.core, node);
+    else if (lastSync[op.core] >= 0)
+      graph.addDependency(lastSync[op.core], node);
+    lastSync[op.core] = node;
+    break;
+  case OpCode::BARRIER:
+    for (int core = 0; core < static_cast<int>(lastSync.size()); ++core)
+      if (op.sync.coreMask & (1u << core))
+        joinCore(core, node);
+    for (int core = 0; core < static_cast<int>(lastSync.size()); ++core)
+      if (op.sync.coreMask & (1u << core))
+        lastSync[core] = node;
+    break;
+  case OpCode::DMA_WAIT: {
+    auto copies = dmaInFlight.find({op.core, op.dmaToken});
+    if (copies != dmaInFlight.end()) {
+      for (uint32_t copy : copies->second)
+        graph.addDependency(copy, node);
+      dmaInFlight.erase(copies);
+    }
+    if (nodeOfOp.empty())
+      joinCore(op.core, node);
+    else if (lastSync[op.core] >= 0)
+      graph.addDependency(lastSync[op.core], node);
+    lastSync[op.core] = node;
+    break;
+  }
+  default:
+    if (lastSync[op.core] >= 0)
+      graph.addDependency(lastSync[op.core], node);
+    opsSinceSync[op.core].push_back(node);
+    if (op.hasFlag(DecodedOp::ASYNC))
+      dmaInFlight[{op.core, op.dmaToken}].push_back(node);
+    break;
+  }
+}
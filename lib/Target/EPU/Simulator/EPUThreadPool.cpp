@@ -0,0 +1,155 @@
+#include "Target/EPU/Simulator/EPUThreadPool.h"
+#include <chrono>
+
+uint64_t EPUThreadPool::nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+EPUThreadPool::EPUThreadPool(unsigned numThreads) : queue(QUEUE_CAPACITY) {
+  workers.reserve(numThreads);
+  for (unsigned i = 0; i < numThreads; ++i)
+    workers.emplace_back([this]() { workerLoop(); });
+}
+
+EPUThreadPool::~EPUThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping.store(true);
+  }
+  wakeUp.notify_all();
+
+  for (auto &worker : workers)
+    worker.join();
+}
+
+void EPUThreadPool::runTask(PoolTask &task) {
+  std::exception_ptr taskError;
+  try {
+    task.fn();
+  } catch (...) {
+    taskError = std::current_exception();
+  }
+  task.fn = nullptr;
+  task.group->finishOne(taskError);
+}
+
+bool EPUThreadPool::tryRunOne(bool byCaller) {
+  PoolTask task;
+  if (!queue.tryPop(task))
+    return false;
+  queued.fetch_sub(1);
+
+  uint64_t start = nowNs();
+  queueWaitNs.fetch_add(start - task.enqueueNs, std::memory_order_relaxed);
+
+  runTask(task);
+
+  tasksExecuted.fetch_add(1, std::memory_order_relaxed);
+  if (byCaller)
+    tasksExecutedByCaller.fetch_add(1, std::memory_order_relaxed);
+  else
+    busyNs.fetch_add(nowNs() - start, std::memory_order_relaxed);
+  return true;
+}
+
+void EPUThreadPool::workerLoop() {
+  uint64_t idleStart = nowNs();
+
+  while (true) {
+    if (queued.load() > 0) {
+      uint64_t now = nowNs();
+      if (tryRunOne(/*byCaller=*/false)) {
+        idleNs.fetch_add(now - idleStart, std::memory_order_relaxed);
+        idleStart = nowNs();
+        continue;
+      }
+    }
+
+    if (stopping.load())
+      break;
+
+    // Spin a little before going to sleep; regions are often submitted back
+    // to back.
+    bool sawWork = false;
+    for (int i = 0; i < SPIN_ITERATIONS && !sawWork; ++i) {
+      std::this_thread::yield();
+      sawWork = queued.load() > 0;
+    }
+    if (sawWork)
+      continue;
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    sleepers.fetch_add(1);
+    wakeUp.wait(lock, [this]() { return queued.load() > 0 || stopping.load(); });
+    sleepers.fetch_sub(1);
+  }
+
+  idleNs.fetch_add(nowNs() - idleStart, std::memory_order_relaxed);
+}
+
+void EPUThreadPool::submit(EPUTaskGroup &group, std::function<void()> fn) {
+  group.add();
+  tasksSubmitted.fetch_add(1, std::memory_order_relaxed);
+
+  PoolTask task;
+  task.fn = std::move(fn);
+  task.group = &group;
+  task.enqueueNs = nowNs();
+
+  if (!queue.tryPush(std::move(task))) {
+    // Queue full: run inline rather than block the producer.
+    runTask(task);
+    tasksExecuted.fetch_add(1, std::memory_order_relaxed);
+    tasksExecutedByCaller.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  queued.fetch_add(1);
+  if (sleepers.load() > 0) {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    wakeUp.notify_one();
+  }
+}
+
+void EPUThreadPool::wait(EPUTaskGroup &group) {
+  while (!group.isDone()) {
+    if (tryRunOne(/*byCaller=*/true))
+      continue;
+
+    // Nothing left to help with; everything outstanding is running on a
+    // worker, so block until the group drains.
+    std::unique_lock<std::mutex> lock(group.mutex);
+    group.done.wait(lock, [&group]() { return group.pending == 0; });
+  }
+
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(group.mutex);
+    std::swap(error, group.error);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+EPUThreadPoolStats EPUThreadPool::getStats() const {
+  EPUThreadPoolStats stats;
+  stats.numThreads = workers.size();
+  stats.tasksSubmitted = tasksSubmitted.load();
+  stats.tasksExecuted = tasksExecuted.load();
+  stats.tasksExecutedByCaller = tasksExecutedByCaller.load();
+  stats.queueWaitNs = queueWaitNs.load();
+  stats.busyNs = busyNs.load();
+  stats.idleNs = idleNs.load();
+  return stats;
+}
+
+void EPUThreadPool::resetStats() {
+  tasksSubmitted.store(0);
+  tasksExecuted.store(0);
+  tasksExecutedByCaller.store(0);
+  queueWaitNs.store(0);
+  busyNs.store(0);
+  idleNs.store(0);
+}
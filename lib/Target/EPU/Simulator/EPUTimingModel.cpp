@@ -0,0 +1,270 @@
+#include "Target/EPU/Simulator/EPUTimingModel.h"
+#include "Target/EPU/Simulator/EPUSyncOrdering.h"
+#include <algorithm>
+#include <iomanip>
+
+static uint64_t divideRoundingUp(uint64_t value, uint64_t divisor) {
+  if (divisor == 0)
+    divisor = 1;
+  return (value + divisor - 1) / divisor;
+}
+
+uint64_t EPUTimingModel::getOpCycles(const DecodedOp &op) const {
+  if (op.error != DecodedOp::NONE || op.core < 0 ||
+      op.core >= processor.getNumberOfCores())
+    return 0;
+
+  const ComputeCore &core = processor.compute_cores[op.core];
+
+  switch (op.opCode) {
+  case OpCode::GLOBAL_TO_LOCAL_MEM_COPY:
+  case OpCode::LOCAL_TO_GLOBAL_MEM_COPY:
+    if (op.copy.kind == CopyPlan::EMPTY)
+      return 0;
+    return core.getDMALatencyCycles() +
+           divideRoundingUp(op.copy.getNumBytes(), core.getDMABytesPerCycle());
+  case OpCode::MATMUL: {
+    const auto &units = core.getMatmulUnits();
+    if (op.mmUnit >= units.size())
+      return 0;
+    const DecodedMatmul &mm = op.matmul;
+    uint64_t macs = static_cast<uint64_t>(mm.M) * mm.N * mm.K;
+    return units[op.mmUnit].getLatencyCycles() +
+           divideRoundingUp(macs, units[op.mmUnit].getMacsPerCycle());
+  }
+  default:
+    return 0;
+  }
+}
+
+void EPUTimingModel::resetState() {
+  timelines.clear();
+  dmaInFlight.clear();
+  coreFirstTimeline.clear();
+  report = EPUTimingReport();
+
+  for (const ComputeCore &core : processor.compute_cores) {
+    coreFirstTimeline.push_back(timelines.size());
+    timelines.resize(timelines.size() + 1 + core.getMatmulUnits().size());
+
+    EPUCoreTiming coreTiming;
+    coreTiming.matmulUnits.resize(core.getMatmulUnits().size());
+    report.cores.push_back(coreTiming);
+  }
+}
+
+EPUTimingModel::ResourceTimeline *
+EPUTimingModel::getResource(const DecodedOp &op) {
+  if (op.core < 0 || op.core >= static_cast<int>(coreFirstTimeline.size()))
+    return nullptr;
+
+  size_t first = coreFirstTimeline[op.core];
+  if (op.opCode == OpCode::MATMUL)
+    return &timelines[first + 1 + op.mmUnit];
+  return &timelines[first];
+}
+
+uint64_t EPUTimingModel::scheduleOp(const DecodedOp &op, uint64_t readyAt) {
+  uint64_t cycles = getOpCycles(op);
+  if (cycles == 0)
+    return readyAt;
+
+  ResourceTimeline *resource = getResource(op);
+  uint64_t start = std::max(readyAt, resource->freeAt);
+  uint64_t end = start + cycles;
+  resource->freeAt = end;
+  resource->busy.push_back({start, end});
+
+  EPUCoreTiming &coreTiming = report.cores[op.core];
+  if (op.opCode == OpCode::MATMUL) {
+    EPUMatmulUnitTiming &unit = coreTiming.matmulUnits[op.mmUnit];
+    ++unit.numOps;
+    unit.busyCycles += cycles;
+  } else {
+    ++coreTiming.dmaOps;
+    coreTiming.dmaBusyCycles += cycles;
+    coreTiming.dmaBytes += op.copy.getNumBytes();
+  }
+
+  return end;
+}
+
+EPUTimingReport EPUTimingModel::finish(uint64_t endCycle) {
+  report.totalCycles = endCycle;
+
+  for (size_t core = 0; core < report.cores.size(); ++core) {
+    EPUCoreTiming &coreTiming = report.cores[core];
+
+    // The core is busy whenever any of its resources is.
+    std::vector<std::pair<uint64_t, uint64_t>> intervals;
+    size_t first = coreFirstTimeline[core];
+    size_t last = first + 1 + coreTiming.matmulUnits.size();
+    for (size_t t = first; t < last; ++t)
+      intervals.insert(intervals.end(), timelines[t].busy.begin(),
+                       timelines[t].busy.end());
+    std::sort(intervals.begin(), intervals.end());
+
+    uint64_t busy = 0;
+    uint64_t coveredUntil = 0;
+    for (const auto &interval : intervals) {
+      uint64_t begin = std::max(interval.first, coveredUntil);
+      if (interval.second > begin) {
+        busy += interval.second - begin;
+        coveredUntil = interval.second;
+      }
+    }
+
+    coreTiming.busyCycles = busy;
+    coreTiming.idleCycles = endCycle - busy;
+
+    for (EPUMatmulUnitTiming &unit : coreTiming.matmulUnits)
+      unit.utilization =
+          endCycle ? static_cast<double>(unit.busyCycles) / endCycle : 0.0;
+  }
+
+  return report;
+}
+
+uint64_t EPUTimingModel::waitDMA(int32_t core, int32_t token) {
+  uint64_t done = 0;
+  for (auto it = dmaInFlight.begin(); it != dmaInFlight.end();) {
+    if ((core < 0 || it->first.first == core) &&
+        (token < 0 || it->first.second == token)) {
+      done = std::max(done, it->second);
+      it = dmaInFlight.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return done;
+}
+
+uint64_t EPUTimingModel::scheduleInOrder(const DecodedOp &op, uint64_t now) {
+  if (op.error != DecodedOp::NONE)
+    return now;
+
+  // An async copy occupies the DMA engine but the core moves on; whatever
+  // waits for it picks up its finish cycle.
+  if (op.hasFlag(DecodedOp::ASYNC)) {
+    uint64_t &done = dmaInFlight[{op.core, op.dmaToken}];
+    done = std::max(done, scheduleOp(op, now));
+    return now;
+  }
+
+  switch (op.opCode) {
+  case OpCode::DMA_WAIT:
+    return std::max(now, waitDMA(op.core, op.dmaToken));
+  case OpCode::SIGNAL:
+    return std::max(now, waitDMA(op.core, -1));
+  case OpCode::BARRIER:
+    for (int32_t core = 0; core < 32; ++core)
+      if (op.sync.coreMask & (1u << core))
+        now = std::max(now, waitDMA(core, -1));
+    return now;
+  default:
+    return scheduleOp(op, now);
+  }
+}
+
+EPUTimingReport
+EPUTimingModel::estimateInOrder(const EPUDecodedProgram &program) {
+  resetState();
+
+  const std::vector<DecodedOp> &ops = program.ops;
+  uint64_t now = 0;
+  auto nextGroup = program.matmulGroups.begin();
+
+  size_t i = 0;
+  while (i < ops.size()) {
+    if (nextGroup != program.matmulGroups.end() && nextGroup->begin == i) {
+      // Every unit starts on its queue at once.
+      uint64_t groupEnd = now;
+      for (size_t op = nextGroup->begin; op < nextGroup->end; ++op)
+        groupEnd = std::max(groupEnd, scheduleOp(ops[op], now));
+      now = groupEnd;
+      i = nextGroup->end;
+      ++nextGroup;
+    } else if (ops[i].opCode == OpCode::START_PARALLEL) {
+      size_t end = i + 1;
+      while (end < ops.size() && ops[end].opCode != OpCode::END_PARALLEL)
+        ++end;
+
+      // Region ops contend for resources and follow the ordering of the
+      // region's sync ops, as in the simulator: a sync op only holds back
+      // the cores it names. The join waits for the slowest op, copies in
+      // flight included.
+      EPUDependencyGraph graph;
+      EPUSyncOrdering sync(graph, processor.getNumberOfCores());
+      for (size_t op = i + 1; op < end; ++op)
+        sync.addOp(op - i - 1, ops[op], graph.addOp(OpFootprint()));
+
+      // Program order is a topological order of the graph.
+      std::vector<uint64_t> readyAt(graph.size(), now);
+      uint64_t regionEnd = now;
+      for (uint32_t op = 0; op < graph.size(); ++op) {
+        uint64_t finished = scheduleInOrder(ops[i + 1 + op], readyAt[op]);
+        for (uint32_t succ : graph.getSuccessors(op))
+          readyAt[succ] = std::max(readyAt[succ], finished);
+        regionEnd = std::max(regionEnd, finished);
+      }
+      regionEnd = std::max(regionEnd, waitDMA(-1, -1));
+
+      now = regionEnd + processor.getJoinCycles();
+      report.joinCycles += processor.getJoinCycles();
+      i = end + 1;
+    } else if (ops[i].opCode == OpCode::END_PARALLEL) {
+      ++i;
+    } else {
+      now = scheduleInOrder(ops[i], now);
+      ++i;
+    }
+  }
+
+  return finish(std::max(now, waitDMA(-1, -1)));
+}
+
+EPUTimingReport
+EPUTimingModel::estimateDataflow(const std::vector<const DecodedOp *> &ops,
+                                 const EPUDependencyGraph &graph) {
+  resetState();
+
+  // Program order is a topological order of the graph, so every op's
+  // predecessors are scheduled before it.
+  std::vector<uint64_t> readyAt(ops.size(), 0);
+  uint64_t end = 0;
+
+  for (uint32_t op = 0; op < ops.size(); ++op) {
+    uint64_t finished = scheduleOp(*ops[op], readyAt[op]);
+    for (uint32_t succ : graph.getSuccessors(op))
+      readyAt[succ] = std::max(readyAt[succ], finished);
+    end = std::max(end, finished);
+  }
+
+  return finish(end);
+}
+
+void EPUTimingReport::print(std::ostream &os) const {
+  std::ios_base::fmtflags savedFlags = os.flags();
+  std::streamsize savedPrecision = os.precision();
+
+  os << "Predicted cycles: " << totalCycles << " (join " << joinCycles
+     << ")\n";
+
+  for (size_t core = 0; core < cores.size(); ++core) {
+    const EPUCoreTiming &timing = cores[core];
+    os << "  Core " << core << ": busy " << timing.busyCycles << ", idle "
+       << timing.idleCycles << ", DMA " << timing.dmaOps << " ops / "
+       << timing.dmaBytes << " bytes / " << timing.dmaBusyCycles
+       << " cycles\n";
+
+    for (size_t unit = 0; unit < timing.matmulUnits.size(); ++unit) {
+      const EPUMatmulUnitTiming &mm = timing.matmulUnits[unit];
+      os << "    MM unit " << unit << ": " << mm.numOps << " ops, busy "
+         << mm.busyCycles << " cycles, utilization " << std::fixed
+         << std::setprecision(1) << mm.utilization * 100.0 << "%\n";
+    }
+  }
+
+  os.flags(savedFlags);
+  os.precision(savedPrecision);
+}
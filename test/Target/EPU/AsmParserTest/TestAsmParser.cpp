@@ -0,0 +1,209 @@
+// This test covers the EPU assembly lexer. Every instruction form is parsed
+// from an in-memory buffer with irregular spacing and CRLF line endings and
+// its operands are checked; malformed lines must be rejected with the line
+// and column of the problem. A large generated program is parsed from a file
+// with one and with several threads: both must produce the same ops, and
+// errors and unbalanced parallel regions past the first chunk must be
+// reported at their line in the whole file.
+
+#include "Target/EPU/CodeGen/EPUCodeGen.h"
+#include "Target/EPU/Parser/EPUAsmParser.h"
+#include "Target/EPU/Parser/EPUBinaryFormat.h"
+#include "Utils/Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static bool hasSlice(SliceOperand &slice, int base, Dim dim1, Dim dim0) {
+  return slice == SliceOperand(base, dim1, dim0);
+}
+
+// The parser's error message for `text`, or "" if it parsed.
+static std::string parseError(EPUAsmParser &parser, const std::string &text) {
+  try {
+    parser.parseBuffer(text, "test.asm");
+  } catch (const std::runtime_error &e) {
+    return e.what();
+  }
+  return "";
+}
+
+static bool rejectsAt(EPUAsmParser &parser, const std::string &text,
+                      const std::string &location) {
+  std::string error = parseError(parser, text);
+  std::cout << "Rejected: " << error << std::endl;
+  return error.rfind("test.asm:" + location + ": ", 0) == 0;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Asm Parser Test..." << std::endl;
+
+  EPUAsmParser parser(createEPUTarget());
+  bool correct = true;
+
+  // -----------------------------
+  // Every instruction form
+  // -----------------------------
+  {
+    std::string text =
+        "cp_global_to_local <1, 0:32:1, 32:64:1>, 2, <4096, 0:32:1, 0:32:1>\n"
+        "\n"
+        "  cp_local_to_global\t3,<0,0:16:2,0:32:1>,< 7 , 1:9:1 , 2:4:1 >\r\n"
+        "matmul 1, 3, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, "
+        "<8192, 0:32:1, 0:32:1>, accumulator=True\n"
+        "matmul 0, 0, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, "
+        "<8192, 0:32:1, 0:32:1>, accumulator = false\n"
+        "start_parallel\n"
+        "cp_global_to_local_async <1, 0:32:1, 0:32:1>, 0, "
+        "<0, 0:32:1, 0:32:1>, 5\n"
+        "cp_local_to_global_async 0, <0, 0:32:1, 0:32:1>, "
+        "<3, 0:32:1, 0:32:1>, 0\n"
+        "dma_wait 0, 5\n"
+        "signal 1, 4\n"
+        "wait 2, 4\n"
+        "barrier 0, 1,3\n"
+        "end_parallel   ";
+    auto ops = parser.parseBuffer(text);
+
+    correct &= ops.size() == 12;
+    if (ops.size() == 12) {
+      auto *g2l = static_cast<GlobalToLocalMemCopyOp *>(ops[0].get());
+      correct &= g2l->getOpCode() == OpCode::GLOBAL_TO_LOCAL_MEM_COPY;
+      correct &= g2l->getCoreNum() == 2 && !g2l->isAsync();
+      correct &= hasSlice(g2l->getSrcSlice(), 1, Dim(0, 32, 1),
+                          Dim(32, 64, 1));
+      correct &= hasSlice(g2l->getDstSlice(), 4096, Dim(0, 32, 1),
+                          Dim(0, 32, 1));
+
+      auto *l2g = static_cast<LocalToGlobalMemCopyOp *>(ops[1].get());
+      correct &= l2g->getOpCode() == OpCode::LOCAL_TO_GLOBAL_MEM_COPY;
+      correct &= l2g->getCoreNum() == 3;
+      correct &= hasSlice(l2g->getSrcSlice(), 0, Dim(0, 16, 2),
+                          Dim(0, 32, 1));
+      correct &= hasSlice(l2g->getDstSlice(), 7, Dim(1, 9, 1), Dim(2, 4, 1));
+
+      auto *mm = static_cast<MatmulOp *>(ops[2].get());
+      correct &= mm->getOpCode() == OpCode::MATMUL;
+      correct &= mm->getCoreNum() == 1 && mm->getMMUnitNum() == 3;
+      correct &= mm->getAccumulate();
+      correct &= hasSlice(mm->getSliceC(), 8192, Dim(0, 32, 1),
+                          Dim(0, 32, 1));
+      correct &= !static_cast<MatmulOp *>(ops[3].get())->getAccumulate();
+
+      correct &= ops[4]->getOpCode() == OpCode::START_PARALLEL;
+
+      auto *asyncLoad = static_cast<GlobalToLocalMemCopyOp *>(ops[5].get());
+      correct &= asyncLoad->isAsync() && asyncLoad->getDMAToken() == 5;
+      auto *asyncStore = static_cast<LocalToGlobalMemCopyOp *>(ops[6].get());
+      correct &= asyncStore->isAsync() && asyncStore->getDMAToken() == 0;
+
+      auto *dmaWait = static_cast<DMAWaitOp *>(ops[7].get());
+      correct &= dmaWait->getOpCode() == OpCode::DMA_WAIT;
+      correct &= dmaWait->getCoreNum() == 0 && dmaWait->getDMAToken() == 5;
+
+      auto *signal = static_cast<SignalOp *>(ops[8].get());
+      correct &= signal->getOpCode() == OpCode::SIGNAL;
+      correct &= signal->getCoreNum() == 1 && signal->getSemaphore() == 4;
+      auto *wait = static_cast<WaitOp *>(ops[9].get());
+      correct &= wait->getOpCode() == OpCode::WAIT;
+      correct &= wait->getCoreNum() == 2 && wait->getSemaphore() == 4;
+
+      auto *barrier = static_cast<BarrierOp *>(ops[10].get());
+      correct &= barrier->getOpCode() == OpCode::BARRIER;
+      correct &= barrier->getCores() == std::vector<ID>({0, 1, 3});
+
+      correct &= ops[11]->getOpCode() == OpCode::END_PARALLEL;
+    }
+  }
+
+  // -----------------------------
+  // Error locations
+  // -----------------------------
+  correct &= rejectsAt(parser, "start_parallel\nmove 0, 1\n", "2:1");
+  correct &= rejectsAt(parser, "\n\n  signal 0\n", "3:11");
+  correct &= rejectsAt(parser, "wait 0, x\n", "1:9");
+  correct &= rejectsAt(parser,
+                       "cp_global_to_local <1, 0:32, 0:32:1>, 0, "
+                       "<0, 0:32:1, 0:32:1>\n",
+                       "1:28");
+  correct &= rejectsAt(parser,
+                       "matmul 0, 0, <0, 0:32:1, 0:32:1>, "
+                       "<4096, 0:32:1, 0:32:1>, <8192, 0:32:1, 0:32:1>, "
+                       "accumulator=maybe\n",
+                       "1:95");
+  correct &= rejectsAt(parser, "dma_wait 0, -1\n", "1:13");
+  correct &= rejectsAt(parser, "end_parallel now\n", "1:14");
+  correct &= rejectsAt(parser, "barrier 0, 99999999999\n", "1:12");
+  correct &= rejectsAt(parser, "start_parallel\n\n start_parallel\n", "3:2");
+  correct &= rejectsAt(parser, "signal 0, 1\nend_parallel\n", "2:1");
+  correct &= rejectsAt(parser, "  start_parallel\nsignal 0, 1\n", "1:3");
+
+  // -----------------------------
+  // Large program
+  // -----------------------------
+  {
+    // Parallel regions that span chunk boundaries.
+    std::string program = "start_parallel" +
+                          generateMatmulISAForEPU(32, 4096, 1024) +
+                          "\nend_parallel\n";
+    std::string text;
+    while (text.size() < (8u << 20))
+      text += program;
+
+    char file[] = "/tmp/mytmpfileXXXXXX";
+    int fd = mkstemp(file);
+    std::ofstream ofs(file);
+    ofs << text;
+    ofs.close();
+    close(fd);
+
+    size_t expectedOps = parser.parseBuffer(program).size() *
+                         (text.size() / program.size());
+
+    std::string serialText;
+    for (unsigned threads : {1u, 4u}) {
+      parser.setNumThreads(threads);
+      auto start = std::chrono::steady_clock::now();
+      auto ops = parser.parseFile(file);
+      double seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+      std::cout << "Parsed " << ops.size() << " ops from "
+                << text.size() / (1 << 20) << " MiB with " << threads
+                << " threads in " << seconds * 1e3 << " ms ("
+                << text.size() / seconds / (1 << 20) << " MiB/s)"
+                << std::endl;
+      correct &= ops.size() == expectedOps;
+
+      std::ostringstream os;
+      writeEPUAsm(ops, os);
+      if (threads == 1)
+        serialText = os.str();
+      else
+        correct &= os.str() == serialText;
+    }
+    unlink(file);
+
+    // Errors in later chunks are reported at their line in the whole text.
+    std::string lineNo =
+        std::to_string(std::count(text.begin(), text.end(), '\n') + 2);
+    correct &= rejectsAt(parser, text + "\nsignal 0\n", lineNo + ":9");
+    correct &= rejectsAt(parser, text + "\nend_parallel\n", lineNo + ":1");
+    correct &= rejectsAt(parser, "start_parallel\n" + text, "2:1");
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
@@ -0,0 +1,177 @@
+// This test runs a double-buffered matmul whose tile loads are asynchronous
+// copies: core 0 prefetches the next A and B tiles with
+// cp_global_to_local_async while its matmul unit works on the current ones,
+// and waits for them with dma_wait. A parallel region then loads, computes
+// and stores with async copies on two more cores. Results must match a
+// reference in every execution mode and with no DMA threads, the timing
+// model must predict fewer cycles than for the same program with
+// synchronous copies, and malformed DMA ops must be rejected by the parser.
+
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static std::vector<float>
+runProgram(const std::vector<std::unique_ptr<Op>> &ops,
+           const EPUSimulatorOptions &options, const std::vector<float> &A,
+           const std::vector<float> &B, uint64_t *cycles) {
+  EPUSimulator sim(createEPUTarget(), options);
+  sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {32, 128});
+  sim.registerInputHandle(2, B.data(), B.size() * sizeof(float), {128, 32});
+  sim.registerOutputHandle(3, 32 * 32 * sizeof(float), {32, 32});
+  sim.registerOutputHandle(4, 32 * 64 * sizeof(float), {32, 64});
+
+  sim.simulateInstructions(ops);
+  if (cycles)
+    *cycles = sim.getTimingReport().totalCycles;
+
+  std::vector<float> out(32 * 32 + 32 * 64);
+  sim.retrieveOutputData(3, out.data(), 32 * 32 * sizeof(float));
+  sim.retrieveOutputData(4, out.data() + 32 * 32, 32 * 64 * sizeof(float));
+  return out;
+}
+
+static std::string writeTempAsm(const std::string &text) {
+  char file[] = "/tmp/mytmpfileXXXXXX";
+  int fd = mkstemp(file);
+  std::ofstream ofs(file);
+  ofs << text;
+  ofs.close();
+  close(fd);
+  return file;
+}
+
+static std::vector<std::unique_ptr<Op>> parseText(const std::string &text) {
+  auto parser = getTargetParser(createEPUTarget());
+  std::string file = writeTempAsm(text);
+  auto operations = parser->parseFile(file);
+  unlink(file.c_str());
+  return operations;
+}
+
+static bool rejectsAsm(const std::string &text) {
+  try {
+    parseText(text);
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+// The same program with every copy synchronous and no dma_wait.
+static std::string makeSynchronous(const std::string &filename) {
+  std::ifstream in(filename);
+  std::ostringstream out;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.rfind("dma_wait", 0) == 0)
+      continue;
+    size_t async = line.find("_async");
+    if (async != std::string::npos) {
+      line.erase(async, strlen("_async"));
+      line.erase(line.rfind(','));
+    }
+    out << line << "\n";
+  }
+  return out.str();
+}
+
+int main() {
+  std::cout << "\nStarting EPU Async DMA Test..." << std::endl;
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  auto target = createEPUTarget();
+  auto parser = getTargetParser(target);
+  bool correct = true;
+
+  std::string filename = std::string(std::getenv("ROOT_DIR")) +
+                         "/test/Target/EPU/AsyncDMATest/prefetch.asm";
+  auto operations = parser->parseFile(filename);
+
+  std::vector<float> A(32 * 128), B(128 * 32);
+  for (int i = 0; i < 32 * 128; ++i)
+    A[i] = static_cast<float>(i % 13);
+  for (int i = 0; i < 128 * 32; ++i)
+    B[i] = static_cast<float>(i % 7 - 3);
+
+  // -----------------------------
+  // Results across modes
+  // -----------------------------
+  std::vector<float> expected(32 * 32 + 32 * 64, 0.0f);
+  for (int i = 0; i < 32; ++i)
+    for (int j = 0; j < 32; ++j) {
+      for (int k = 0; k < 128; ++k)
+        expected[i * 32 + j] += A[i * 128 + k] * B[k * 32 + j];
+      // Core 1 multiplies the first tiles, core 2 the second ones.
+      for (int half = 0; half < 2; ++half)
+        for (int k = 0; k < 32; ++k)
+          expected[32 * 32 + i * 64 + half * 32 + j] +=
+              A[i * 128 + half * 32 + k] * B[(half * 32 + k) * 32 + j];
+    }
+
+  std::vector<EPUSimulatorOptions> configs(4);
+  configs[0].numWorkerThreads = 2;
+  configs[0].numDMAThreads = 2;
+  configs[1].numWorkerThreads = 2;
+  configs[1].numDMAThreads = 0;
+  configs[2].executionMode = EPUExecutionMode::DATAFLOW;
+  configs[3].executionMode = EPUExecutionMode::PER_CORE;
+  for (const EPUSimulatorOptions &options : configs) {
+    auto got = runProgram(operations, options, A, B, nullptr);
+    if (got != expected) {
+      std::cout << "Wrong result in execution mode "
+                << static_cast<int>(options.executionMode) << " with "
+                << options.numDMAThreads << " DMA threads" << std::endl;
+      correct = false;
+    }
+  }
+
+  // -----------------------------
+  // Predicted overlap
+  // -----------------------------
+  {
+    auto synchronous = parseText(makeSynchronous(filename));
+
+    EPUSimulatorOptions options;
+    options.enableTimingModel = true;
+    uint64_t asyncCycles = 0;
+    uint64_t syncCycles = 0;
+    correct &= runProgram(operations, options, A, B, &asyncCycles) ==
+               expected;
+    correct &= runProgram(synchronous, options, A, B, &syncCycles) ==
+               expected;
+
+    std::cout << "Predicted cycles: " << asyncCycles << " async, "
+              << syncCycles << " sync" << std::endl;
+    correct &= asyncCycles < syncCycles;
+  }
+
+  // -----------------------------
+  // Malformed DMA ops
+  // -----------------------------
+  correct &= rejectsAsm("dma_wait 0\n");
+  correct &= rejectsAsm("dma_wait 0, -1\n");
+  correct &= rejectsAsm("cp_global_to_local_async <1, 0:32:1, 0:32:1>, 0, "
+                        "<0, 0:32:1, 0:32:1>\n");
+  correct &= rejectsAsm("cp_local_to_global_async 0, <0, 0:32:1, 0:32:1>, "
+                        "<3, 0:32:1, 0:32:1>, -2\n");
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
@@ -0,0 +1,30 @@
+cp_global_to_local_async <1, 0:32:1, 0:32:1>, 0, <0, 0:32:1, 0:32:1>, 0
+cp_global_to_local_async <2, 0:32:1, 0:32:1>, 0, <4096, 0:32:1, 0:32:1>, 0
+dma_wait 0, 0
+cp_global_to_local_async <1, 0:32:1, 32:64:1>, 0, <8192, 0:32:1, 0:32:1>, 1
+cp_global_to_local_async <2, 32:64:1, 0:32:1>, 0, <12288, 0:32:1, 0:32:1>, 1
+matmul 0, 0, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <16384, 0:32:1, 0:32:1>, accumulator=False
+dma_wait 0, 1
+cp_global_to_local_async <1, 0:32:1, 64:96:1>, 0, <0, 0:32:1, 0:32:1>, 0
+cp_global_to_local_async <2, 64:96:1, 0:32:1>, 0, <4096, 0:32:1, 0:32:1>, 0
+matmul 0, 0, <8192, 0:32:1, 0:32:1>, <12288, 0:32:1, 0:32:1>, <16384, 0:32:1, 0:32:1>, accumulator=True
+dma_wait 0, 0
+cp_global_to_local_async <1, 0:32:1, 96:128:1>, 0, <8192, 0:32:1, 0:32:1>, 1
+cp_global_to_local_async <2, 96:128:1, 0:32:1>, 0, <12288, 0:32:1, 0:32:1>, 1
+matmul 0, 0, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <16384, 0:32:1, 0:32:1>, accumulator=True
+dma_wait 0, 1
+matmul 0, 0, <8192, 0:32:1, 0:32:1>, <12288, 0:32:1, 0:32:1>, <16384, 0:32:1, 0:32:1>, accumulator=True
+cp_local_to_global 0, <16384, 0:32:1, 0:32:1>, <3, 0:32:1, 0:32:1>
+start_parallel
+cp_global_to_local_async <1, 0:32:1, 0:32:1>, 1, <0, 0:32:1, 0:32:1>, 0
+cp_global_to_local_async <2, 0:32:1, 0:32:1>, 1, <4096, 0:32:1, 0:32:1>, 0
+cp_global_to_local_async <1, 0:32:1, 32:64:1>, 2, <0, 0:32:1, 0:32:1>, 3
+cp_global_to_local_async <2, 32:64:1, 0:32:1>, 2, <4096, 0:32:1, 0:32:1>, 3
+dma_wait 1, 0
+dma_wait 2, 3
+matmul 1, 0, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <8192, 0:32:1, 0:32:1>, accumulator=False
+matmul 2, 1, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <8192, 0:32:1, 0:32:1>, accumulator=False
+barrier 1, 2
+cp_local_to_global_async 1, <8192, 0:32:1, 0:32:1>, <4, 0:32:1, 0:32:1>, 1
+cp_local_to_global_async 2, <8192, 0:32:1, 0:32:1>, <4, 0:32:1, 32:64:1>, 1
+end_parallel
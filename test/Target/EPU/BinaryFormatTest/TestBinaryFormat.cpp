@@ -0,0 +1,231 @@
+// This test covers the binary EPU program format. The assembly programs of
+// the other tests must survive a text -> binary -> text round trip with every
+// operand intact, corrupted binaries must be rejected, and a codegen matmul
+// loaded from a binary file must simulate to the same result as its
+// assembly. A large program is loaded both ways to report the startup cost.
+
+#include "Target/EPU/CodeGen/EPUCodeGen.h"
+#include "Target/EPU/Parser/EPUAsmParser.h"
+#include "Target/EPU/Parser/EPUBinaryFormat.h"
+#include "Utils/Utils.h"
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static std::string toAsm(const std::vector<std::unique_ptr<Op>> &ops) {
+  std::ostringstream os;
+  writeEPUAsm(ops, os);
+  return os.str();
+}
+
+static std::string toBinary(const std::vector<std::unique_ptr<Op>> &ops) {
+  std::ostringstream os;
+  writeEPUBinary(ops, os);
+  return os.str();
+}
+
+static std::vector<std::unique_ptr<Op>> fromBinary(const std::string &bytes) {
+  return loadEPUBinary(reinterpret_cast<const uint8_t *>(bytes.data()),
+                       bytes.size(), "test.bin");
+}
+
+static std::string writeTempFile(const std::string &contents) {
+  char file[] = "/tmp/mytmpfileXXXXXX";
+  int fd = mkstemp(file);
+  std::ofstream ofs(file, std::ios::binary);
+  ofs << contents;
+  ofs.close();
+  close(fd);
+  return file;
+}
+
+static bool rejectsBinary(const std::string &bytes) {
+  try {
+    fromBinary(bytes);
+  } catch (const std::runtime_error &e) {
+    std::cout << "Rejected: " << e.what() << std::endl;
+    return true;
+  }
+  return false;
+}
+
+static std::vector<float> runMatmul(const std::vector<std::unique_ptr<Op>> &ops,
+                                    const std::vector<float> &A,
+                                    const std::vector<float> &B, int M, int K,
+                                    int N) {
+  auto sim = getTargetSimulator(createEPUTarget());
+  sim->registerInputHandle(1, A.data(), A.size() * sizeof(float), {M, K});
+  sim->registerInputHandle(2, B.data(), B.size() * sizeof(float), {K, N});
+  sim->registerOutputHandle(3, M * N * sizeof(float), {M, N});
+  sim->simulateInstructions(ops);
+
+  std::vector<float> C(M * N);
+  sim->retrieveOutputData(3, C.data(), C.size() * sizeof(float));
+  return C;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Binary Format Test..." << std::endl;
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  EPUAsmParser parser(createEPUTarget());
+  std::string testDir = std::string(std::getenv("ROOT_DIR")) +
+                        "/test/Target/EPU/";
+  bool correct = true;
+
+  // -----------------------------
+  // Round trip
+  // -----------------------------
+  for (const char *name :
+       {"SyncTest/sync.asm", "AsyncDMATest/prefetch.asm",
+        "MatmulUnitTest/hazard.asm", "AllMMUnitTest/multicore.asm"}) {
+    auto ops = parser.parseFile(testDir + name);
+    std::string text = toAsm(ops);
+    auto decoded = fromBinary(toBinary(ops));
+
+    bool same = decoded.size() == ops.size() && toAsm(decoded) == text &&
+                toAsm(parser.parseBuffer(text)) == text;
+    if (!same)
+      std::cout << "Round trip changed " << name << std::endl;
+    correct &= same;
+  }
+
+  {
+    auto ops = parser.parseBuffer(
+        "cp_global_to_local_async <1, 0:32:2, -4:64:1>, 3, "
+        "<4096, 0:16:1, 0:32:1>, 7\n"
+        "matmul 2, 3, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, "
+        "<8192, 0:32:1, 0:32:1>, accumulator=True\n"
+        "barrier 3, 1, 2\n");
+    auto decoded = fromBinary(toBinary(ops));
+    correct &= decoded.size() == 3;
+    if (decoded.size() == 3) {
+      auto *copy = static_cast<GlobalToLocalMemCopyOp *>(decoded[0].get());
+      correct &= copy->getCoreNum() == 3 && copy->getDMAToken() == 7;
+      correct &= copy->getSrcSlice() ==
+                 SliceOperand(1, Dim(0, 32, 2), Dim(-4, 64, 1));
+      auto *mm = static_cast<MatmulOp *>(decoded[1].get());
+      correct &= mm->getMMUnitNum() == 3 && mm->getAccumulate();
+      auto *barrier = static_cast<BarrierOp *>(decoded[2].get());
+      correct &= barrier->getCores() == std::vector<ID>({3, 1, 2});
+      correct &= barrier->getCoreNum() == 3;
+    }
+  }
+
+  // -----------------------------
+  // Corrupted binaries
+  // -----------------------------
+  {
+    auto ops = parser.parseBuffer("start_parallel\n"
+                                  "dma_wait 0, 1\n"
+                                  "end_parallel\n");
+    std::string bytes = toBinary(ops);
+    correct &= fromBinary(bytes).size() == 3;
+
+    size_t record1 = sizeof(EPUBinaryHeader) + sizeof(EPUBinaryRecord);
+    auto patched = [&](size_t offset, const void *value, size_t size) {
+      std::string copy = bytes;
+      std::memcpy(&copy[offset], value, size);
+      return copy;
+    };
+    uint32_t version = EPU_BINARY_VERSION + 1;
+    uint32_t recordSize = sizeof(EPUBinaryRecord) - 4;
+    uint16_t opCode = 99;
+    uint16_t flags = EPUBinaryRecord::ACCUMULATE;
+    int32_t token = -1;
+
+    correct &= rejectsBinary("");
+    correct &= rejectsBinary("start_parallel\n");
+    correct &= rejectsBinary(bytes.substr(0, bytes.size() - 1));
+    correct &= rejectsBinary(bytes + std::string(sizeof(EPUBinaryRecord), 0));
+    correct &= rejectsBinary(
+        patched(offsetof(EPUBinaryHeader, version), &version, 4));
+    correct &= rejectsBinary(
+        patched(offsetof(EPUBinaryHeader, recordSize), &recordSize, 4));
+    correct &= rejectsBinary(
+        patched(record1 + offsetof(EPUBinaryRecord, opCode), &opCode, 2));
+    correct &= rejectsBinary(
+        patched(record1 + offsetof(EPUBinaryRecord, flags), &flags, 2));
+    correct &= rejectsBinary(
+        patched(record1 + offsetof(EPUBinaryRecord, dmaToken), &token, 4));
+  }
+
+  // -----------------------------
+  // Simulation from a binary file
+  // -----------------------------
+  {
+    const int M = 32, K = 32, N = 128;
+    auto ops = parser.parseBuffer(generateMatmulISAForEPU(M, N, K));
+    std::string file = writeTempFile(toBinary(ops));
+    // parseFile recognizes the binary format by its magic.
+    auto loaded = parser.parseFile(file);
+    unlink(file.c_str());
+
+    std::vector<float> A(M * K), B(K * N);
+    for (int i = 0; i < M * K; ++i)
+      A[i] = static_cast<float>(i % 9);
+    for (int i = 0; i < K * N; ++i)
+      B[i] = static_cast<float>(i % 5 - 2);
+
+    std::vector<float> expected = runMatmul(ops, A, B, M, K, N);
+    correct &= runMatmul(loaded, A, B, M, K, N) == expected;
+    for (int i = 0; i < M; ++i)
+      for (int j = 0; j < N; ++j) {
+        float sum = 0;
+        for (int k = 0; k < K; ++k)
+          sum += A[i * K + k] * B[k * N + j];
+        correct &= expected[i * N + j] == sum;
+      }
+  }
+
+  // -----------------------------
+  // Startup cost
+  // -----------------------------
+  {
+    std::string program = generateMatmulISAForEPU(32, 4096, 1024);
+    std::string text;
+    while (text.size() < (8u << 20))
+      text += program;
+
+    std::string textFile = writeTempFile(text);
+    std::string binaryFile = writeTempFile(toBinary(parser.parseBuffer(text)));
+
+    auto time = [&](const std::string &file, size_t &numOps) {
+      auto start = std::chrono::steady_clock::now();
+      numOps = parser.parseFile(file).size();
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start)
+          .count();
+    };
+    size_t textOps = 0, binaryOps = 0;
+    double textSeconds = time(textFile, textOps);
+    double binarySeconds = time(binaryFile, binaryOps);
+    unlink(textFile.c_str());
+    unlink(binaryFile.c_str());
+
+    std::cout << "Loaded " << textOps << " ops in " << textSeconds * 1e3
+              << " ms from assembly, " << binarySeconds * 1e3
+              << " ms from binary" << std::endl;
+    correct &= textOps == binaryOps;
+    correct &= binarySeconds < textSeconds;
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
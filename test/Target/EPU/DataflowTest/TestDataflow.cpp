@@ -0,0 +1,109 @@
+// This test runs codegen-produced matmul programs, which carry no parallel
+// markers, through the dataflow execution mode and checks that the result is
+// bit-identical to in-order execution and matches a host reference.
+
+#include "Target/EPU/CodeGen/EPUCodeGen.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static std::vector<float>
+runProgram(const std::vector<std::unique_ptr<Op>> &ops, EPUExecutionMode mode,
+           unsigned threads, const std::vector<float> &A,
+           const std::vector<float> &B, int M, int K, int N) {
+  EPUSimulatorOptions options;
+  options.executionMode = mode;
+  options.numWorkerThreads = threads;
+  EPUSimulator sim(createEPUTarget(), options);
+
+  sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {M, K});
+  sim.registerInputHandle(2, B.data(), B.size() * sizeof(float), {K, N});
+  sim.registerOutputHandle(3, M * N * sizeof(float), {M, N});
+
+  sim.simulateInstructions(ops);
+
+  std::vector<float> C(M * N);
+  sim.retrieveOutputData(3, C.data(), C.size() * sizeof(float));
+  return C;
+}
+
+static bool testDataflow(int M, int K, int N) {
+  auto asmStr = generateMatmulISAForEPU(M, N, K);
+
+  char file[] = "/tmp/mytmpfileXXXXXX";
+  int fd = mkstemp(file);
+  std::ofstream ofs(file);
+  ofs << asmStr;
+  ofs.close();
+  close(fd);
+
+  auto target = createEPUTarget();
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(file);
+  unlink(file);
+
+  std::vector<float> A(M * K), B(K * N), expected(M * N, 0.0f);
+  for (int i = 0; i < M; ++i)
+    for (int j = 0; j < K; ++j)
+      A[i * K + j] = static_cast<float>((i + j) / 10.0);
+  for (int i = 0; i < K; ++i)
+    for (int j = 0; j < N; ++j)
+      B[i * N + j] = static_cast<float>((i - j) / 10.0);
+  for (int i = 0; i < M; ++i)
+    for (int j = 0; j < N; ++j)
+      for (int k = 0; k < K; ++k)
+        expected[i * N + j] += A[i * K + k] * B[k * N + j];
+
+  auto inOrder =
+      runProgram(operations, EPUExecutionMode::IN_ORDER, 2, A, B, M, K, N);
+
+  for (unsigned threads : {0u, 1u, 4u}) {
+    auto dataflow = runProgram(operations, EPUExecutionMode::DATAFLOW, threads,
+                               A, B, M, K, N);
+    if (std::memcmp(inOrder.data(), dataflow.data(),
+                    inOrder.size() * sizeof(float)) != 0) {
+      std::cout << "Dataflow result differs from in-order result with "
+                << threads << " threads" << std::endl;
+      return false;
+    }
+  }
+
+  for (int i = 0; i < M * N; ++i) {
+    float tolerance = 1e-3 * std::abs(expected[i]) + 1e-5;
+    if (std::abs(inOrder[i] - expected[i]) > tolerance) {
+      std::cout << "Mismatch at " << i << ": expected " << expected[i]
+                << ", got " << inOrder[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Dataflow Test..." << std::endl;
+
+  std::vector<std::vector<int>> tests = {{32, 32, 128}, {32, 128, 128}};
+
+  for (auto test : tests) {
+    int M = test[0];
+    int K = test[1];
+    int N = test[2];
+
+    std::cout << "Testing dataflow execution for " << M << ", " << K << ", "
+              << N << "\n";
+
+    if (!testDataflow(M, K, N)) {
+      throw std::runtime_error("Error: Output verification failed");
+    }
+  }
+
+  std::cout << "Output verified successfully" << std::endl;
+  return 0;
+}
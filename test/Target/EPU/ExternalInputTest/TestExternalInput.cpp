@@ -0,0 +1,140 @@
+// This test registers the inputs of the basic matmul program without copying
+// them into global memory: A aliases a caller buffer, B is read from a mapped
+// .npy file and, in a second run, from a raw float file. Every run must match
+// the result of the regular copying registration.
+
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+static void writeNpy(const std::string &path, const float *data, int rows,
+                     int cols) {
+  std::string dict = "{'descr': '<f4', 'fortran_order': False, 'shape': (" +
+                     std::to_string(rows) + ", " + std::to_string(cols) +
+                     "), }";
+  // Pad so the data starts on a 64 byte boundary, newline terminated.
+  while ((10 + dict.size() + 1) % 64 != 0)
+    dict += ' ';
+  dict += '\n';
+
+  std::ofstream out(path, std::ios::binary);
+  out.write("\x93NUMPY\x01\x00", 8);
+  uint16_t headerLen = dict.size();
+  char lenBytes[2] = {static_cast<char>(headerLen & 0xff),
+                      static_cast<char>(headerLen >> 8)};
+  out.write(lenBytes, 2);
+  out.write(dict.data(), dict.size());
+  out.write(reinterpret_cast<const char *>(data), rows * cols * sizeof(float));
+}
+
+static void writeRaw(const std::string &path, const float *data,
+                     size_t numBytes) {
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char *>(data), numBytes);
+}
+
+int main() {
+  std::cout << "\nStarting EPU External Input Test..." << std::endl;
+
+  auto target = createEPUTarget();
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  std::string filename = std::string(std::getenv("ROOT_DIR")) +
+                         "/test/Target/EPU/BasicTest/basic.asm";
+
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(filename);
+
+  float inputTensorA[32][32];
+  float inputTensorB[32][32];
+  for (int i = 0; i < 32; ++i) {
+    for (int j = 0; j < 32; ++j) {
+      inputTensorA[i][j] = static_cast<float>((i + j) / 10.0);
+      inputTensorB[i][j] = static_cast<float>((i - j) / 10.0);
+    }
+  }
+
+  float expected[32][32];
+  {
+    EPUSimulator sim(target);
+    sim.registerInputHandle(1, inputTensorA, sizeof(inputTensorA), {32, 32});
+    sim.registerInputHandle(2, inputTensorB, sizeof(inputTensorB), {32, 32});
+    sim.registerOutputHandle(3, sizeof(expected), {32, 32});
+    sim.simulateInstructions(operations);
+    sim.retrieveOutputData(3, expected, sizeof(expected));
+  }
+
+  std::string prefix = "/tmp/epu_external_input_" + std::to_string(getpid());
+  std::string npyPath = prefix + ".npy";
+  std::string rawPath = prefix + ".bin";
+  writeNpy(npyPath, &inputTensorB[0][0], 32, 32);
+  writeRaw(rawPath, &inputTensorB[0][0], sizeof(inputTensorB));
+
+  bool correct = true;
+
+  for (bool useNpy : {true, false}) {
+    EPUSimulator sim(target);
+    sim.registerExternalInputHandle(1, inputTensorA, sizeof(inputTensorA),
+                                    {32, 32});
+    if (useNpy)
+      sim.registerMappedInputHandle(2, npyPath);
+    else
+      sim.registerMappedInputHandle(2, rawPath, {32, 32});
+    sim.registerOutputHandle(3, sizeof(expected), {32, 32});
+    sim.simulateInstructions(operations);
+
+    float output[32][32];
+    sim.retrieveOutputData(3, output, sizeof(output));
+    correct &= std::memcmp(output, expected, sizeof(output)) == 0;
+
+    // Input reads go straight to the aliased storage.
+    float roundTrip[32][32];
+    sim.retrieveInputData(2, roundTrip, sizeof(roundTrip));
+    correct &= std::memcmp(roundTrip, inputTensorB, sizeof(roundTrip)) == 0;
+
+    // Nothing was copied into global memory.
+    correct &= sim.getMemoryUsage().residentGlobalBytes <= 2 * 1024 * 1024;
+  }
+
+  // A raw file has no header to take the shape from, and a wrong shape is
+  // rejected for .npy files.
+  {
+    EPUSimulator sim(target, EPUSimulatorOptions{0});
+    bool threw = false;
+    try {
+      sim.registerMappedInputHandle(2, rawPath);
+    } catch (const std::runtime_error &) {
+      threw = true;
+    }
+    correct &= threw;
+
+    threw = false;
+    try {
+      sim.registerMappedInputHandle(2, npyPath, {16, 64});
+    } catch (const std::runtime_error &) {
+      threw = true;
+    }
+    correct &= threw;
+  }
+
+  std::remove(npyPath.c_str());
+  std::remove(rawPath.c_str());
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
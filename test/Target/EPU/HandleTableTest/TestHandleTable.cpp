@@ -0,0 +1,132 @@
+// This test covers the simulator's handle table: registration is rejected
+// while the table is frozen, a handle ID has a single direction and only
+// changes it once released, a failed re-registration keeps the old handle,
+// unknown or out of range IDs are reported, and the basic matmul program
+// still runs when the handles are registered in reverse order.
+
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+static bool throwsRuntimeError(const std::function<void()> &fn) {
+  try {
+    fn();
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Handle Table Test..." << std::endl;
+
+  auto target = createEPUTarget();
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  std::string filename = std::string(std::getenv("ROOT_DIR")) +
+                         "/test/Target/EPU/BasicTest/basic.asm";
+
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(filename);
+
+  float inputTensorA[32][32];
+  float inputTensorB[32][32];
+  for (int i = 0; i < 32; ++i) {
+    for (int j = 0; j < 32; ++j) {
+      inputTensorA[i][j] = static_cast<float>((i + j) / 10.0);
+      inputTensorB[i][j] = static_cast<float>((i - j) / 10.0);
+    }
+  }
+
+  bool correct = true;
+  EPUSimulator sim(target);
+
+  // Frozen tables reject registration; freezes nest.
+  sim.freezeHandles();
+  sim.freezeHandles();
+  correct &= throwsRuntimeError([&]() {
+    sim.registerOutputHandle(3, 32 * 32 * sizeof(float), {32, 32});
+  });
+  sim.unfreezeHandles();
+  correct &= sim.areHandlesFrozen();
+  sim.unfreezeHandles();
+  correct &= !sim.areHandlesFrozen();
+
+  correct &= throwsRuntimeError([&]() {
+    sim.registerOutputHandle(-1, 32 * 32 * sizeof(float), {32, 32});
+  });
+
+  // Handle 2 starts out as an output and only becomes an input once it is
+  // released.
+  sim.registerOutputHandle(3, 32 * 32 * sizeof(float), {32, 32});
+  sim.registerOutputHandle(2, 32 * 32 * sizeof(float), {32, 32});
+  correct &= throwsRuntimeError([&]() {
+    sim.registerInputHandle(2, inputTensorB, sizeof(inputTensorB), {32, 32});
+  });
+  float zeros[32][32] = {};
+  correct &= throwsRuntimeError([&]() {
+    sim.registerExternalInputHandle(2, zeros, sizeof(zeros), {32, 32});
+  });
+  sim.releaseHandle(2);
+  sim.registerInputHandle(2, inputTensorB, sizeof(inputTensorB), {32, 32});
+  sim.registerInputHandle(1, inputTensorA, sizeof(inputTensorA), {32, 32});
+  correct &= throwsRuntimeError([&]() {
+    sim.registerOutputHandle(1, 32 * 32 * sizeof(float), {32, 32});
+  });
+
+  // Re-registering with more memory than there is fails and keeps the old
+  // handle.
+  size_t inUse = sim.getGlobalMemoryInUse();
+  correct &= throwsRuntimeError([&]() {
+    sim.registerInputHandle(1, inputTensorA,
+                            target.getGlobalMemory() + sizeof(inputTensorA),
+                            {32, 32});
+  });
+  correct &= sim.getGlobalMemoryInUse() == inUse;
+
+  float scratch[32][32];
+  sim.retrieveInputData(1, scratch, sizeof(scratch));
+  correct &= std::memcmp(scratch, inputTensorA, sizeof(scratch)) == 0;
+  correct &= throwsRuntimeError(
+      [&]() { sim.retrieveOutputData(2, scratch, sizeof(scratch)); });
+  correct &= throwsRuntimeError(
+      [&]() { sim.retrieveInputData(3, scratch, sizeof(scratch)); });
+  correct &= throwsRuntimeError(
+      [&]() { sim.retrieveInputData(1000, scratch, sizeof(scratch)); });
+
+  sim.simulateInstructions(operations);
+  correct &= !sim.areHandlesFrozen();
+
+  float outputTensorC[32][32];
+  sim.retrieveOutputData(3, outputTensorC, sizeof(outputTensorC));
+
+  for (int i = 0; i < 32; ++i) {
+    for (int j = 0; j < 32; ++j) {
+      float expected = 0.0f;
+      for (int k = 0; k < 32; ++k)
+        expected += inputTensorA[i][k] * inputTensorB[k][j];
+      if (std::abs(outputTensorC[i][j] - expected) > 1e-3f) {
+        std::cerr << "Mismatch at (" << i << ", " << j << "): got "
+                  << outputTensorC[i][j] << ", expected " << expected << "\n";
+        correct = false;
+      }
+    }
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
@@ -0,0 +1,215 @@
+// This test runs a program of single large ops (a 64x128x128 matmul, block,
+// single-row and strided copies) with intra-op splitting forced on, so every
+// op is cut into pieces across the worker pool. Results must be
+// bit-identical to an unsplit run and the matmul must match a reference
+// loop. A contiguous copy with fewer rows than pieces is split by columns
+// and must match too, and a matmul accumulating into its own operand must
+// not be split at all.
+
+#include "Target/EPU/Parser/EPUAsmParser.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct Outputs {
+  std::vector<float> C = std::vector<float>(64 * 128);
+  std::vector<float> row = std::vector<float>(4096);
+  std::vector<float> strided = std::vector<float>(32 * 32);
+};
+
+static Outputs run(const std::vector<std::unique_ptr<Op>> &operations,
+                   const EPUSimulatorOptions &options,
+                   const std::vector<float> &A, const std::vector<float> &B,
+                   const std::vector<float> &row,
+                   EPUThreadPoolStats &stats) {
+  EPUSimulator sim(createEPUTarget(), options);
+  sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {64, 128});
+  sim.registerInputHandle(2, B.data(), B.size() * sizeof(float), {128, 128});
+  sim.registerOutputHandle(3, 64 * 128 * sizeof(float), {64, 128});
+  sim.registerInputHandle(4, row.data(), row.size() * sizeof(float),
+                          {1, 4096});
+  sim.registerOutputHandle(5, 4096 * sizeof(float), {1, 4096});
+  sim.registerOutputHandle(6, 32 * 32 * sizeof(float), {32, 32});
+
+  sim.simulateInstructions(operations);
+  stats = sim.getThreadPoolStats();
+
+  Outputs out;
+  sim.retrieveOutputData(3, out.C.data(), out.C.size() * sizeof(float));
+  sim.retrieveOutputData(5, out.row.data(), out.row.size() * sizeof(float));
+  sim.retrieveOutputData(6, out.strided.data(),
+                         out.strided.size() * sizeof(float));
+  return out;
+}
+
+// Copies a 2x4096 tensor through local memory and back.
+static std::vector<float> runWideCopy(const EPUSimulatorOptions &options,
+                                      const std::vector<float> &input) {
+  auto target = createEPUTarget();
+  auto operations = EPUAsmParser(target).parseBuffer(
+      "cp_global_to_local <1, 0:2:1, 0:4096:1>, 0, <0, 0:2:1, 0:4096:1>\n"
+      "cp_local_to_global 0, <0, 0:2:1, 0:4096:1>, <2, 0:2:1, 0:4096:1>\n");
+
+  EPUSimulator sim(target, options);
+  sim.registerInputHandle(1, input.data(), input.size() * sizeof(float),
+                          {2, 4096});
+  sim.registerOutputHandle(2, input.size() * sizeof(float), {2, 4096});
+  sim.simulateInstructions(operations);
+
+  std::vector<float> out(input.size());
+  sim.retrieveOutputData(2, out.data(), out.size() * sizeof(float));
+  return out;
+}
+
+// Accumulates A * B into B in place, with A and B 128x128.
+static std::vector<float> runInPlace(const EPUSimulatorOptions &options,
+                                     const std::vector<float> &A,
+                                     const std::vector<float> &B,
+                                     EPUThreadPoolStats &stats) {
+  auto target = createEPUTarget();
+  auto operations = EPUAsmParser(target).parseBuffer(
+      "cp_global_to_local <1, 0:128:1, 0:128:1>, 0, <0, 0:128:1, 0:128:1>\n"
+      "cp_global_to_local <2, 0:128:1, 0:128:1>, 0, "
+      "<65536, 0:128:1, 0:128:1>\n"
+      "matmul 0, 0, <0, 0:128:1, 0:128:1>, <65536, 0:128:1, 0:128:1>, "
+      "<65536, 0:128:1, 0:128:1>, accumulator=True\n"
+      "cp_local_to_global 0, <65536, 0:128:1, 0:128:1>, "
+      "<3, 0:128:1, 0:128:1>\n");
+
+  EPUSimulator sim(target, options);
+  sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {128, 128});
+  sim.registerInputHandle(2, B.data(), B.size() * sizeof(float), {128, 128});
+  sim.registerOutputHandle(3, B.size() * sizeof(float), {128, 128});
+  sim.simulateInstructions(operations);
+  stats = sim.getThreadPoolStats();
+
+  std::vector<float> out(B.size());
+  sim.retrieveOutputData(3, out.data(), out.size() * sizeof(float));
+  return out;
+}
+
+static bool same(const std::vector<float> &a, const std::vector<float> &b) {
+  return std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Intra-Op Test..." << std::endl;
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  std::string filename = std::string(std::getenv("ROOT_DIR")) +
+                         "/test/Target/EPU/IntraOpTest/intraop.asm";
+
+  auto target = createEPUTarget();
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(filename);
+
+  std::vector<float> A(64 * 128), B(128 * 128), row(4096);
+  for (size_t i = 0; i < A.size(); ++i)
+    A[i] = static_cast<float>((i % 41) / 10.0);
+  for (size_t i = 0; i < B.size(); ++i)
+    B[i] = static_cast<float>((static_cast<int>(i % 29) - 14) / 10.0);
+  for (size_t i = 0; i < row.size(); ++i)
+    row[i] = static_cast<float>(i);
+
+  EPUThreadPoolStats serialStats;
+  EPUSimulatorOptions serialOptions;
+  serialOptions.numWorkerThreads = 0;
+  Outputs expected = run(operations, serialOptions, A, B, row, serialStats);
+
+  // Tiny thresholds split every op as far as the pool allows.
+  EPUSimulatorOptions splitOptions;
+  splitOptions.numWorkerThreads = 3;
+  splitOptions.intraOpMinBytes = 1024;
+  splitOptions.intraOpMinFlops = 4096;
+
+  bool correct = true;
+  for (EPUExecutionMode mode :
+       {EPUExecutionMode::IN_ORDER, EPUExecutionMode::DATAFLOW}) {
+    splitOptions.executionMode = mode;
+    EPUThreadPoolStats stats;
+    Outputs split = run(operations, splitOptions, A, B, row, stats);
+
+    std::cout << "Intra-op pieces submitted to the pool: "
+              << stats.tasksSubmitted << std::endl;
+    // IN_ORDER has no parallel regions, so every pool task is a piece.
+    if (mode == EPUExecutionMode::IN_ORDER)
+      correct &= stats.tasksSubmitted > 0;
+
+    correct &= same(split.C, expected.C);
+    correct &= same(split.row, expected.row);
+    correct &= same(split.strided, expected.strided);
+  }
+
+  // With matmul splitting off, every copy stays under the default byte
+  // threshold and runs whole.
+  EPUSimulatorOptions defaultOptions;
+  defaultOptions.numWorkerThreads = 3;
+  defaultOptions.intraOpMinFlops = 0;
+  EPUThreadPoolStats defaultStats;
+  run(operations, defaultOptions, A, B, row, defaultStats);
+  correct &= defaultStats.tasksSubmitted == 0;
+
+  // Two contiguous rows cut into four pieces are split by columns.
+  {
+    std::vector<float> wide(2 * 4096);
+    for (size_t i = 0; i < wide.size(); ++i)
+      wide[i] = static_cast<float>(i);
+
+    EPUSimulatorOptions wideOptions;
+    wideOptions.numWorkerThreads = 4;
+    wideOptions.intraOpMinBytes = 4096;
+    std::vector<float> split = runWideCopy(wideOptions, wide);
+    correct &= same(split, runWideCopy(serialOptions, wide));
+    correct &= same(split, wide);
+  }
+
+  // A matmul accumulating into its own B operand runs whole.
+  {
+    std::vector<float> lhs(128 * 128), square(128 * 128);
+    for (size_t i = 0; i < square.size(); ++i) {
+      lhs[i] = static_cast<float>((i % 23) / 10.0);
+      square[i] = static_cast<float>((i % 37) / 10.0);
+    }
+
+    EPUSimulatorOptions inPlaceOptions = splitOptions;
+    inPlaceOptions.executionMode = EPUExecutionMode::IN_ORDER;
+    inPlaceOptions.intraOpMinBytes = 0;
+    EPUThreadPoolStats stats;
+    std::vector<float> split = runInPlace(inPlaceOptions, lhs, square, stats);
+    correct &= stats.tasksSubmitted == 0;
+    correct &= same(split, runInPlace(serialOptions, lhs, square, stats));
+  }
+
+  for (int m = 0; m < 64 && correct; ++m)
+    for (int n = 0; n < 128; ++n) {
+      float sum = 0.0f;
+      for (int k = 0; k < 128; ++k)
+        sum += A[m * 128 + k] * B[k * 128 + n];
+      if (expected.C[m * 128 + n] != sum) {
+        std::cout << "Matmul mismatch at (" << m << ", " << n << ")"
+                  << std::endl;
+        correct = false;
+        break;
+      }
+    }
+  correct &= same(expected.row, row);
+  for (int i = 0; i < 32; ++i)
+    for (int j = 0; j < 32; ++j)
+      correct &= expected.strided[i * 32 + j] == A[2 * i * 128 + 4 * j];
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
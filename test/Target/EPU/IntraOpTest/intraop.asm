@@ -0,0 +1,8 @@
+cp_global_to_local <1, 0:64:1, 0:128:1>, 0, <0, 0:64:1, 0:128:1>
+cp_global_to_local <2, 0:128:1, 0:128:1>, 0, <32768, 0:128:1, 0:128:1>
+matmul 0, 0, <0, 0:64:1, 0:128:1>, <32768, 0:128:1, 0:128:1>, <98304, 0:64:1, 0:128:1>, accumulator=False
+cp_local_to_global 0, <98304, 0:64:1, 0:128:1>, <3, 0:64:1, 0:128:1>
+cp_global_to_local <4, 0:1:1, 0:4096:1>, 1, <0, 0:1:1, 0:4096:1>
+cp_local_to_global 1, <0, 0:1:1, 0:4096:1>, <5, 0:1:1, 0:4096:1>
+cp_global_to_local <1, 0:64:2, 0:128:4>, 2, <0, 0:32:1, 0:32:1>
+cp_local_to_global 2, <0, 0:32:1, 0:32:1>, <6, 0:32:1, 0:32:1>
@@ -0,0 +1,204 @@
+// This test checks that in-order execution runs consecutive matmuls on
+// different matmul units concurrently. The AllMMUnit program, which issues
+// four matmuls per core without any parallel region, must be grouped per
+// core, give the same result with and without concurrent units, and be
+// predicted faster. A second program chains matmuls through overlapping
+// slices, which must split the groups so that every hazard is respected.
+// Matmuls naming a unit the core does not have must fail to decode, and so
+// must copies and matmuls naming a core the target does not have.
+
+#include "Target/EPU/Parser/EPUAsmParser.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct RunResult {
+  std::vector<float> output;
+  std::vector<EPUDecodedProgram::MatmulGroup> groups;
+  uint64_t cycles = 0;
+};
+
+static RunResult runProgram(const std::vector<std::unique_ptr<Op>> &ops,
+                            bool concurrentUnits, const std::vector<float> &A,
+                            const std::vector<float> &B, int N) {
+  EPUSimulatorOptions options;
+  options.numWorkerThreads = 3;
+  options.concurrentMatmulUnits = concurrentUnits;
+  options.enableTimingModel = true;
+
+  EPUSimulator sim(createEPUTarget(), options);
+  sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {32, 32});
+  sim.registerInputHandle(2, B.data(), B.size() * sizeof(float),
+                          {32, static_cast<int>(B.size() / 32)});
+  sim.registerOutputHandle(3, 32 * N * sizeof(float), {32, N});
+
+  EPUDecodedProgram program = sim.decode(ops);
+  // Twice, so the second run reuses the decoded groups.
+  sim.simulateDecoded(program);
+  sim.simulateDecoded(program);
+
+  RunResult result;
+  result.output.resize(32 * N);
+  sim.retrieveOutputData(3, result.output.data(), 32 * N * sizeof(float));
+  result.groups = program.matmulGroups;
+  result.cycles = sim.getTimingReport().totalCycles;
+  return result;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Matmul Unit Test..." << std::endl;
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  auto target = createEPUTarget();
+  auto parser = getTargetParser(target);
+  std::string testDir = std::string(std::getenv("ROOT_DIR")) +
+                        "/test/Target/EPU/";
+  bool correct = true;
+
+  // -----------------------------
+  // Independent units
+  // -----------------------------
+  {
+    auto operations = parser->parseFile(testDir +
+                                        "AllMMUnitTest/multicore.asm");
+
+    std::vector<float> A(32 * 32), B(32 * 512);
+    for (int i = 0; i < 32 * 32; ++i)
+      A[i] = static_cast<float>(i % 11);
+    for (int i = 0; i < 32 * 512; ++i)
+      B[i] = static_cast<float>(i % 5 - 2);
+
+    RunResult serial = runProgram(operations, false, A, B, 512);
+    RunResult grouped = runProgram(operations, true, A, B, 512);
+
+    correct &= serial.groups.empty();
+    correct &= serial.output == grouped.output;
+    // One group of four matmuls per core.
+    correct &= grouped.groups.size() == 4;
+    for (const auto &group : grouped.groups)
+      correct &= group.end - group.begin == 4;
+
+    std::cout << "Predicted cycles: " << grouped.cycles << " grouped, "
+              << serial.cycles << " serial" << std::endl;
+    correct &= grouped.cycles < serial.cycles;
+
+    for (int i = 0; i < 32; ++i)
+      for (int j = 0; j < 512; ++j) {
+        float sum = 0;
+        for (int k = 0; k < 32; ++k)
+          sum += A[i * 32 + k] * B[k * 512 + j];
+        correct &= grouped.output[i * 512 + j] == sum;
+      }
+  }
+
+  // -----------------------------
+  // Hazards between units
+  // -----------------------------
+  {
+    auto operations = parser->parseFile(testDir + "MatmulUnitTest/hazard.asm");
+
+    std::vector<float> A(32 * 32), B(32 * 32);
+    for (int i = 0; i < 32 * 32; ++i) {
+      A[i] = static_cast<float>(i % 5);
+      B[i] = static_cast<float>(i % 3 - 1);
+    }
+
+    RunResult serial = runProgram(operations, false, A, B, 96);
+    RunResult grouped = runProgram(operations, true, A, B, 96);
+    correct &= serial.output == grouped.output;
+
+    // Only the first two matmuls may overlap: the third reads what unit 0
+    // wrote and the fourth overwrites what the third reads.
+    correct &= grouped.groups.size() == 1;
+    correct &= !grouped.groups.empty() && grouped.groups[0].begin == 2 &&
+               grouped.groups[0].end == 4;
+
+    std::vector<float> AB(32 * 32, 0.0f);
+    for (int i = 0; i < 32; ++i)
+      for (int j = 0; j < 32; ++j)
+        for (int k = 0; k < 32; ++k)
+          AB[i * 32 + j] += A[i * 32 + k] * B[k * 32 + j];
+
+    for (int i = 0; i < 32; ++i)
+      for (int j = 0; j < 32; ++j) {
+        float ABB = 0;
+        for (int k = 0; k < 32; ++k)
+          ABB += AB[i * 32 + k] * B[k * 32 + j];
+        correct &= grouped.output[i * 96 + j] == 2 * AB[i * 32 + j];
+        correct &= grouped.output[i * 96 + 32 + j] == AB[i * 32 + j];
+        correct &= grouped.output[i * 96 + 64 + j] == ABB;
+      }
+  }
+
+  // -----------------------------
+  // Invalid units
+  // -----------------------------
+  {
+    int numUnits = target.getMMUnitsPerCore();
+    std::string slices = "<0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, "
+                         "<8192, 0:32:1, 0:32:1>, accumulator=False\n";
+    std::string text;
+    for (int unit : {numUnits - 1, numUnits, 256, -1})
+      text += "matmul 0, " + std::to_string(unit) + ", " + slices;
+
+    EPUSimulator sim(target);
+    EPUDecodedProgram program =
+        sim.decode(EPUAsmParser(target).parseBuffer(text));
+    correct &= program.ops[0].error == DecodedOp::NONE &&
+               program.ops[0].mmUnit == numUnits - 1;
+    for (int i = 1; i < 4; ++i)
+      correct &= program.ops[i].error == DecodedOp::INVALID_MATMUL_UNIT;
+  }
+
+  // -----------------------------
+  // Invalid cores
+  // -----------------------------
+  {
+    int numCores = target.getNumberOfCores();
+    std::string tile = "<0, 0:32:1, 0:32:1>";
+    std::string text;
+    for (int core : {numCores, -1}) {
+      std::string c = std::to_string(core);
+      text += "cp_global_to_local <1, 0:32:1, 0:32:1>, " + c + ", " + tile +
+              "\n";
+      text += "matmul " + c + ", 0, " + tile + ", " + tile + ", " + tile +
+              ", accumulator=False\n";
+      text += "cp_local_to_global " + c + ", " + tile +
+              ", <2, 0:32:1, 0:32:1>\n";
+    }
+
+    std::vector<float> input(32 * 32, 1.0f);
+    for (EPUExecutionMode mode :
+         {EPUExecutionMode::IN_ORDER, EPUExecutionMode::PER_CORE}) {
+      EPUSimulatorOptions options;
+      options.executionMode = mode;
+      EPUSimulator sim(target, options);
+      sim.registerInputHandle(1, input.data(), input.size() * sizeof(float),
+                              {32, 32});
+      sim.registerOutputHandle(2, input.size() * sizeof(float), {32, 32});
+
+      auto operations = EPUAsmParser(target).parseBuffer(text);
+      EPUDecodedProgram program = sim.decode(operations);
+      for (const DecodedOp &op : program.ops)
+        correct &= op.error == DecodedOp::INVALID_CORE;
+
+      // The ops only report their error.
+      sim.simulateDecoded(program);
+    }
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
@@ -0,0 +1,9 @@
+cp_global_to_local <1, 0:32:1, 0:32:1>, 0, <0, 0:32:1, 0:32:1>
+cp_global_to_local <2, 0:32:1, 0:32:1>, 0, <4096, 0:32:1, 0:32:1>
+matmul 0, 0, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <8192, 0:32:1, 0:32:1>, accumulator=False
+matmul 0, 1, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <12288, 0:32:1, 0:32:1>, accumulator=False
+matmul 0, 2, <8192, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <16384, 0:32:1, 0:32:1>, accumulator=False
+matmul 0, 3, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <8192, 0:32:1, 0:32:1>, accumulator=True
+cp_local_to_global 0, <8192, 0:32:1, 0:32:1>, <3, 0:32:1, 0:32:1>
+cp_local_to_global 0, <12288, 0:32:1, 0:32:1>, <3, 0:32:1, 32:64:1>
+cp_local_to_global 0, <16384, 0:32:1, 0:32:1>, <3, 0:32:1, 64:96:1>
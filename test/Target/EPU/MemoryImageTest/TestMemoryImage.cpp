@@ -0,0 +1,128 @@
+// This test loads weights into one simulator, snapshots its global memory
+// into a memory image and forks several simulators from it. Each fork
+// registers its own activations and output, runs a codegen-produced matmul
+// program and must match a plain simulator. Writes by one fork must not be
+// visible to another fork or to the image.
+
+#include "Target/EPU/CodeGen/EPUCodeGen.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static constexpr int M = 32;
+static constexpr int K = 64;
+static constexpr int N = 128;
+
+static std::vector<float>
+runFork(const std::shared_ptr<const SimulatorMemoryImage> &image,
+        const std::vector<std::unique_ptr<Op>> &ops,
+        const std::vector<float> &A) {
+  EPUSimulator sim(createEPUTarget(), image, EPUSimulatorOptions{0});
+  sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {M, K});
+  sim.registerOutputHandle(3, M * N * sizeof(float), {M, N});
+  sim.simulateInstructions(ops);
+
+  std::vector<float> C(M * N);
+  sim.retrieveOutputData(3, C.data(), C.size() * sizeof(float));
+  return C;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Memory Image Test..." << std::endl;
+
+  auto asmStr = generateMatmulISAForEPU(M, N, K);
+
+  char file[] = "/tmp/mytmpfileXXXXXX";
+  int fd = mkstemp(file);
+  std::ofstream ofs(file);
+  ofs << asmStr;
+  ofs.close();
+  close(fd);
+
+  auto target = createEPUTarget();
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(file);
+  unlink(file);
+
+  std::vector<float> weights(K * N);
+  for (int i = 0; i < K; ++i)
+    for (int j = 0; j < N; ++j)
+      weights[i * N + j] = static_cast<float>((i - j) / 10.0);
+
+  std::vector<std::vector<float>> activations(3, std::vector<float>(M * K));
+  for (int f = 0; f < 3; ++f)
+    for (int i = 0; i < M * K; ++i)
+      activations[f][i] = static_cast<float>((i % 89 - f) / 10.0);
+
+  std::shared_ptr<const SimulatorMemoryImage> image;
+  {
+    EPUSimulator base(target);
+    base.registerInputHandle(2, weights.data(), weights.size() * sizeof(float),
+                             {K, N});
+    image = base.createMemoryImage();
+  }
+
+  bool correct = image->getUsedBytes() == weights.size() * sizeof(float);
+
+  for (int f = 0; f < 3; ++f) {
+    auto forked = runFork(image, operations, activations[f]);
+
+    EPUSimulator plain(target, EPUSimulatorOptions{0});
+    plain.registerInputHandle(1, activations[f].data(),
+                              activations[f].size() * sizeof(float), {M, K});
+    plain.registerInputHandle(2, weights.data(),
+                              weights.size() * sizeof(float), {K, N});
+    plain.registerOutputHandle(3, M * N * sizeof(float), {M, N});
+    plain.simulateInstructions(operations);
+
+    std::vector<float> expected(M * N);
+    plain.retrieveOutputData(3, expected.data(),
+                             expected.size() * sizeof(float));
+    if (std::memcmp(expected.data(), forked.data(),
+                    expected.size() * sizeof(float)) != 0) {
+      std::cout << "Fork " << f << " differs from a plain run" << std::endl;
+      correct = false;
+    }
+  }
+
+  // Two live forks: writes stay private to the fork that made them.
+  EPUSimulator first(target, image, EPUSimulatorOptions{0});
+  EPUSimulator second(target, image, EPUSimulatorOptions{0});
+  std::vector<float> garbage(M * K, 42.0f);
+  first.registerInputHandle(1, garbage.data(), garbage.size() * sizeof(float),
+                            {M, K});
+  second.registerInputHandle(1, activations[1].data(),
+                             activations[1].size() * sizeof(float), {M, K});
+
+  std::vector<float> readBack(M * K);
+  second.retrieveInputData(1, readBack.data(),
+                           readBack.size() * sizeof(float));
+  correct &= readBack == activations[1];
+  std::vector<float> weightsBack(K * N);
+  first.retrieveInputData(2, weightsBack.data(),
+                          weightsBack.size() * sizeof(float));
+  correct &= weightsBack == weights;
+
+  // Forks keep the image alive.
+  image.reset();
+  second.registerOutputHandle(3, M * N * sizeof(float), {M, N});
+  second.simulateInstructions(operations);
+  second.retrieveInputData(2, weightsBack.data(),
+                           weightsBack.size() * sizeof(float));
+  correct &= weightsBack == weights;
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
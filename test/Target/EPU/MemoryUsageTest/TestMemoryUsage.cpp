@@ -0,0 +1,79 @@
+// This test checks that simulator memory is committed lazily: a simulator for
+// the 1 GiB EPU target that runs the basic matmul program should only have a
+// handful of pages resident, all simulated memory must start zeroed, and each
+// core's local memory must sit on its own host pages.
+
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+int main() {
+  std::cout << "\nStarting EPU Memory Usage Test..." << std::endl;
+
+  auto target = createEPUTarget();
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  std::string filename = std::string(std::getenv("ROOT_DIR")) +
+                         "/test/Target/EPU/BasicTest/basic.asm";
+
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(filename);
+
+  bool correct = true;
+
+  for (auto hugePages : {HugePageMode::NONE, HugePageMode::TRANSPARENT,
+                         HugePageMode::EXPLICIT}) {
+    EPUSimulatorOptions options;
+    options.memory.hugePages = hugePages;
+    EPUSimulator sim(target, options);
+
+    // Fresh memory reads as zero.
+    float untouched[32];
+    sim.retrieveLocalMemoryData(3, 1024, untouched, sizeof(untouched));
+    for (float value : untouched)
+      correct &= value == 0.0f;
+
+    float inputTensorA[32][32];
+    float inputTensorB[32][32];
+    for (int i = 0; i < 32; ++i) {
+      for (int j = 0; j < 32; ++j) {
+        inputTensorA[i][j] = static_cast<float>((i + j) / 10.0);
+        inputTensorB[i][j] = static_cast<float>((i - j) / 10.0);
+      }
+    }
+
+    sim.registerInputHandle(1, inputTensorA, sizeof(inputTensorA), {32, 32});
+    sim.registerInputHandle(2, inputTensorB, sizeof(inputTensorB), {32, 32});
+    sim.registerOutputHandle(3, 32 * 32 * sizeof(float), {32, 32});
+    sim.simulateInstructions(operations);
+
+    SimulatorMemoryUsage usage = sim.getMemoryUsage();
+    std::cout << "Reserved " << usage.reservedBytes << " bytes, resident "
+              << usage.residentBytes << " bytes (global "
+              << usage.residentGlobalBytes << ")" << std::endl;
+
+    // 1 GiB reserved, but only the handles and three local tiles touched.
+    // Allow a few huge pages worth for THP / hugetlb backings.
+    correct &= usage.reservedBytes >= target.getGlobalMemory();
+    correct &= usage.residentBytes <= 16 * 1024 * 1024;
+    correct &= usage.residentLocalBytes.size() == 4;
+    correct &= usage.residentLocalBytes[1] > 0;
+    correct &= usage.residentLocalBytes[3] <= usage.residentLocalBytes[1];
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
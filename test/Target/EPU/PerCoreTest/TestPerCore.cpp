@@ -0,0 +1,157 @@
+// This test runs programs in the PER_CORE execution mode, where every
+// simulated core executes its own ops on a dedicated host thread. A
+// hand-written program orders stores of different cores to the same output
+// through memory dependencies and an end_parallel join; codegen-produced
+// matmuls spread over all cores. Results must be bit-identical to in-order
+// execution, with and without pinning the core threads.
+
+#include "Target/EPU/CodeGen/EPUCodeGen.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+static std::vector<float>
+runProgram(const std::vector<std::unique_ptr<Op>> &ops,
+           const EPUSimulatorOptions &options, const std::vector<float> &A,
+           const std::vector<float> &B, int M, int K, int N,
+           EPUCoreStreamStats *stats) {
+  EPUSimulator sim(createEPUTarget(), options);
+  sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {M, K});
+  sim.registerInputHandle(2, B.data(), B.size() * sizeof(float), {K, N});
+  sim.registerOutputHandle(3, M * N * sizeof(float), {M, N});
+  sim.registerOutputHandle(4, 32 * 32 * sizeof(float), {32, 32});
+
+  // Twice, so the second run reuses the core threads.
+  sim.simulateInstructions(ops);
+  sim.simulateInstructions(ops);
+  if (stats)
+    *stats = sim.getCoreStreamStats();
+
+  std::vector<float> out(M * N + 32 * 32);
+  sim.retrieveOutputData(3, out.data(), M * N * sizeof(float));
+  sim.retrieveOutputData(4, out.data() + M * N, 32 * 32 * sizeof(float));
+  return out;
+}
+
+static bool compareModes(const std::vector<std::unique_ptr<Op>> &ops,
+                         const std::vector<float> &A,
+                         const std::vector<float> &B, int M, int K, int N,
+                         std::vector<float> *result) {
+  EPUSimulatorOptions inOrder;
+  inOrder.numWorkerThreads = 2;
+  auto expected = runProgram(ops, inOrder, A, B, M, K, N, nullptr);
+  if (result)
+    *result = expected;
+
+  size_t numOps = 0;
+  for (const auto &op : ops)
+    if (op->getOpCode() != OpCode::START_PARALLEL &&
+        op->getOpCode() != OpCode::END_PARALLEL)
+      ++numOps;
+
+  bool correct = true;
+  for (bool pin : {true, false}) {
+    EPUSimulatorOptions perCore;
+    perCore.executionMode = EPUExecutionMode::PER_CORE;
+    perCore.pinCoreThreads = pin;
+    EPUCoreStreamStats stats;
+    auto got = runProgram(ops, perCore, A, B, M, K, N, &stats);
+
+    if (std::memcmp(expected.data(), got.data(),
+                    expected.size() * sizeof(float)) != 0) {
+      std::cout << "PER_CORE result differs from in-order (pinned: " << pin
+                << ")" << std::endl;
+      correct = false;
+    }
+
+    correct &= stats.opsExecuted.size() == 4;
+    correct &= std::accumulate(stats.opsExecuted.begin(),
+                               stats.opsExecuted.end(), size_t(0)) == numOps;
+    std::cout << "Cross-core waits per core:";
+    for (uint64_t waits : stats.crossCoreWaits)
+      std::cout << " " << waits;
+    std::cout << std::endl;
+  }
+  return correct;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Per-Core Test..." << std::endl;
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  auto target = createEPUTarget();
+  auto parser = getTargetParser(target);
+  bool correct = true;
+
+  // -----------------------------
+  // Cross-core ordering
+  // -----------------------------
+  {
+    std::string filename = std::string(std::getenv("ROOT_DIR")) +
+                           "/test/Target/EPU/PerCoreTest/percore.asm";
+    auto operations = parser->parseFile(filename);
+
+    std::vector<float> A(32 * 32), B(32 * 64);
+    for (int i = 0; i < 32 * 32; ++i)
+      A[i] = static_cast<float>(i % 13);
+    for (int i = 0; i < 32 * 64; ++i)
+      B[i] = static_cast<float>(i % 7 - 3);
+
+    std::vector<float> result;
+    correct &= compareModes(operations, A, B, 32, 32, 64, &result);
+
+    // Core 1's store to the left half comes last, as does core 3's store to
+    // the right half.
+    for (int i = 0; i < 32; ++i)
+      for (int j = 0; j < 32; ++j) {
+        correct &= result[i * 64 + j] == B[i * 64 + j];
+        correct &= result[i * 64 + 32 + j] == result[64 * 32 + i * 32 + j];
+      }
+  }
+
+  // -----------------------------
+  // Codegen matmuls
+  // -----------------------------
+  for (auto [M, K, N] : {std::tuple<int, int, int>{32, 32, 128},
+                         std::tuple<int, int, int>{32, 128, 128}}) {
+    auto asmStr = generateMatmulISAForEPU(M, N, K);
+
+    char file[] = "/tmp/mytmpfileXXXXXX";
+    int fd = mkstemp(file);
+    std::ofstream ofs(file);
+    ofs << asmStr;
+    ofs.close();
+    close(fd);
+
+    auto operations = parser->parseFile(file);
+    unlink(file);
+
+    std::vector<float> A(M * K), B(K * N);
+    for (int i = 0; i < M * K; ++i)
+      A[i] = static_cast<float>((i % 31) / 10.0);
+    for (int i = 0; i < K * N; ++i)
+      B[i] = static_cast<float>((i % 17 - 8) / 10.0);
+
+    correct &= compareModes(operations, A, B, M, K, N, nullptr);
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
@@ -0,0 +1,15 @@
+cp_global_to_local <1, 0:32:1, 0:32:1>, 0, <0, 0:32:1, 0:32:1>
+cp_global_to_local <2, 0:32:1, 0:32:1>, 1, <0, 0:32:1, 0:32:1>
+cp_local_to_global 0, <0, 0:32:1, 0:32:1>, <3, 0:32:1, 0:32:1>
+cp_local_to_global 1, <0, 0:32:1, 0:32:1>, <3, 0:32:1, 0:32:1>
+start_parallel
+cp_global_to_local <1, 0:32:1, 0:32:1>, 2, <0, 0:32:1, 0:32:1>
+cp_global_to_local <2, 0:32:1, 0:32:1>, 2, <4096, 0:32:1, 0:32:1>
+cp_global_to_local <2, 0:32:1, 0:32:1>, 3, <0, 0:32:1, 0:32:1>
+cp_global_to_local <1, 0:32:1, 0:32:1>, 3, <4096, 0:32:1, 0:32:1>
+matmul 2, 0, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <8192, 0:32:1, 0:32:1>, accumulator=False
+matmul 3, 1, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, <8192, 0:32:1, 0:32:1>, accumulator=False
+end_parallel
+cp_local_to_global 2, <8192, 0:32:1, 0:32:1>, <3, 0:32:1, 32:64:1>
+cp_local_to_global 3, <8192, 0:32:1, 0:32:1>, <3, 0:32:1, 32:64:1>
+cp_local_to_global 3, <8192, 0:32:1, 0:32:1>, <4, 0:32:1, 0:32:1>
@@ -0,0 +1,125 @@
+// This test runs the parallel dispatch program with the simulator profiler
+// enabled and checks the per op type and per core counters, then writes a
+// Chrome trace and checks it holds one span per executed op, with names
+// escaped. A run with the profiler disabled must not record anything.
+
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+static size_t countOccurrences(const std::string &text,
+                               const std::string &pattern) {
+  size_t count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1))
+    ++count;
+  return count;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Profiler Test..." << std::endl;
+
+#ifdef SIMULATOR_DISABLE_PROFILING
+  std::cout << "Profiling compiled out, nothing to check" << std::endl;
+  std::cout << "Output verified successfully" << std::endl;
+  return 0;
+#endif
+
+  auto target = createEPUTarget();
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  std::string filename = std::string(std::getenv("ROOT_DIR")) +
+                         "/test/Target/EPU/ParalellDispatchTest/parallel.asm";
+
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(filename);
+
+  float inputTensorA[32][32] = {};
+  float inputTensorB[32][64] = {};
+
+  EPUSimulator sim(target);
+  sim.registerInputHandle(1, inputTensorA, sizeof(inputTensorA), {32, 32});
+  sim.registerInputHandle(2, inputTensorB, sizeof(inputTensorB), {32, 64});
+  sim.registerOutputHandle(3, 32 * 64 * sizeof(float), {32, 64});
+
+  bool correct = true;
+
+  // Disabled by default.
+  sim.simulateInstructions(operations);
+  SimulatorProfile profile = sim.getProfiler().getProfile();
+  for (const OpProfileStats &stats : profile.byOpType)
+    correct &= stats.count == 0;
+
+  sim.getProfiler().enable(/*recordTrace=*/true);
+  sim.simulateInstructions(operations);
+  sim.getProfiler().disable();
+
+  profile = sim.getProfiler().getProfile();
+  profile.print(std::cout);
+
+  const OpProfileStats &loads =
+      profile.byOpType[OpCode::GLOBAL_TO_LOCAL_MEM_COPY];
+  const OpProfileStats &stores =
+      profile.byOpType[OpCode::LOCAL_TO_GLOBAL_MEM_COPY];
+  const OpProfileStats &matmuls = profile.byOpType[OpCode::MATMUL];
+
+  correct &= profile.opTypeNames[OpCode::MATMUL] == "matmul";
+  correct &= loads.count == 4 && loads.bytes == 4 * 32 * 32 * sizeof(float);
+  correct &= stores.count == 2 && stores.bytes == 2 * 32 * 32 * sizeof(float);
+  correct &= matmuls.count == 2 && matmuls.flops == 2 * 2 * 32 * 32 * 32;
+  correct &= matmuls.bytes == 0 && loads.flops == 0;
+
+  correct &= profile.byCore.size() == 4;
+  correct &= profile.byCore[0].count == 0 && profile.byCore[3].count == 0;
+  correct &= profile.byCore[1].count == 4 && profile.byCore[2].count == 4;
+  correct &= profile.byCore[1].flops == 2 * 32 * 32 * 32;
+
+  std::string tracePath =
+      "/tmp/epu_profiler_trace_" + std::to_string(getpid()) + ".json";
+  sim.getProfiler().writeChromeTrace(tracePath);
+
+  std::ifstream traceFile(tracePath);
+  std::stringstream trace;
+  trace << traceFile.rdbuf();
+  std::remove(tracePath.c_str());
+
+  correct &= trace.str().find("\"traceEvents\"") != std::string::npos;
+  correct &= countOccurrences(trace.str(), "\"ph\": \"X\"") == 8;
+  correct &= countOccurrences(trace.str(), "\"name\": \"matmul\"") == 2;
+  correct &= trace.str().find("\"mm unit 0\"") != std::string::npos;
+
+  // Names are escaped, control characters included.
+  sim.getProfiler().setLaneName(7, "dma\t\"0\"\\\n\x01");
+  sim.getProfiler().writeChromeTrace(tracePath);
+
+  std::ifstream escapedFile(tracePath);
+  std::stringstream escaped;
+  escaped << escapedFile.rdbuf();
+  std::remove(tracePath.c_str());
+
+  correct &= escaped.str().find("\"dma\\t\\\"0\\\"\\\\\\n\\u0001\"") !=
+             std::string::npos;
+  correct &= escaped.str().find_first_of("\t\x01") == std::string::npos;
+
+  // Reset clears the counters and the recorded spans.
+  sim.getProfiler().reset();
+  correct &= sim.getProfiler().getProfile().byCore[1].count == 0;
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
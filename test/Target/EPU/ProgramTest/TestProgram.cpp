@@ -0,0 +1,235 @@
+// This test covers EPUProgram, the compact in-memory form of an EPU program.
+// The assembly programs of the other tests parsed straight into an
+// EPUProgram, serially and in parallel chunks, must hold the same ops and
+// dump the same way as the unique_ptr<Op> list parseBuffer returns, and must
+// simulate to the same result. Indices must stay valid as ops are appended,
+// and the program must take well under half the memory of the op list.
+
+#include "Target/EPU/Parser/EPUAsmParser.h"
+#include "Target/EPU/Parser/EPUBinaryFormat.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::string toAsm(const std::vector<std::unique_ptr<Op>> &ops) {
+  std::ostringstream os;
+  writeEPUAsm(ops, os);
+  return os.str();
+}
+
+static std::string readFile(const std::string &filename) {
+  std::ifstream in(filename);
+  std::ostringstream text;
+  text << in.rdbuf();
+  return text.str();
+}
+
+// Captures what `print` writes to std::cout.
+template <typename Print> static std::string captureDump(Print print) {
+  std::ostringstream captured;
+  std::streambuf *saved = std::cout.rdbuf(captured.rdbuf());
+  print();
+  std::cout.rdbuf(saved);
+  return captured.str();
+}
+
+// Heap bytes of an op list: the pointer array, each op object and its
+// allocator header, and the core list of barriers.
+static size_t opListBytes(const std::vector<std::unique_ptr<Op>> &ops) {
+  const size_t mallocHeader = 16;
+  size_t bytes = ops.capacity() * sizeof(std::unique_ptr<Op>);
+  for (const auto &op : ops) {
+    switch (op->getOpCode()) {
+    case OpCode::GLOBAL_TO_LOCAL_MEM_COPY:
+      bytes += sizeof(GlobalToLocalMemCopyOp);
+      break;
+    case OpCode::LOCAL_TO_GLOBAL_MEM_COPY:
+      bytes += sizeof(LocalToGlobalMemCopyOp);
+      break;
+    case OpCode::MATMUL:
+      bytes += sizeof(MatmulOp);
+      break;
+    case OpCode::BARRIER:
+      bytes += sizeof(BarrierOp) + mallocHeader +
+               static_cast<BarrierOp &>(*op).getCores().size() * sizeof(ID);
+      break;
+    default:
+      bytes += sizeof(SignalOp);
+      break;
+    }
+    bytes += mallocHeader;
+  }
+  return bytes;
+}
+
+static bool sameProgram(const std::vector<std::unique_ptr<Op>> &ops,
+                        const EPUProgram &program) {
+  if (program.size() != ops.size() || toAsm(program.toOps()) != toAsm(ops))
+    return false;
+  for (size_t i = 0; i < ops.size(); ++i)
+    if (program.getOpCode(i) != ops[i]->getOpCode() ||
+        program.getCoreNum(i) != ops[i]->getCoreNum())
+      return false;
+  return captureDump([&]() { program.dump(); }) == captureDump([&]() {
+           for (const auto &op : ops)
+             op->dump();
+         });
+}
+
+static bool rejects(EPUAsmParser &parser, const std::string &text,
+                    const std::string &expected) {
+  try {
+    parser.parseProgram(text, "x.asm");
+  } catch (const std::runtime_error &e) {
+    std::cout << "Rejected: " << e.what() << std::endl;
+    return std::string(e.what()).find(expected) != std::string::npos;
+  }
+  return false;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Program Test..." << std::endl;
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  auto target = createEPUTarget();
+  EPUAsmParser parser(target);
+  std::string testDir = std::string(std::getenv("ROOT_DIR")) +
+                        "/test/Target/EPU/";
+  bool correct = true;
+
+  // -----------------------------
+  // Same ops as the op list
+  // -----------------------------
+  for (const char *name :
+       {"BasicTest/basic.asm", "SyncTest/sync.asm", "AsyncDMATest/prefetch.asm",
+        "MatmulUnitTest/hazard.asm", "AllMMUnitTest/multicore.asm",
+        "StridedCopyTest/strided.asm", "PerCoreTest/percore.asm"}) {
+    auto ops = parser.parseFile(testDir + name);
+    bool same = sameProgram(ops, parser.parseProgramFile(testDir + name)) &&
+                sameProgram(ops, EPUProgram::fromOps(ops));
+    if (!same)
+      std::cout << "EPUProgram differs for " << name << std::endl;
+    correct &= same;
+  }
+
+  {
+    auto ops = parser.parseBuffer(
+        "cp_global_to_local_async <1, 0:32:2, -4:64:1>, 3, "
+        "<4096, 0:16:1, 0:32:1>, 7\n"
+        "cp_local_to_global 3, <4096, 0:16:1, 0:32:1>, <2, 0:16:1, 0:32:1>\n"
+        "matmul 2, 3, <0, 0:32:1, 0:32:1>, <4096, 0:32:1, 0:32:1>, "
+        "<8192, 0:32:1, 0:32:1>, accumulator=True\n"
+        "barrier 3, 1, 2\n"
+        "dma_wait 3, 7\n");
+    EPUProgram program = EPUProgram::fromOps(ops);
+    correct &= sameProgram(ops, program);
+    correct &= program.getSlice(0, 0) ==
+               SliceOperand(1, Dim(0, 32, 2), Dim(-4, 64, 1));
+    correct &= program.getBarrierCores(3) == std::vector<ID>({3, 1, 2});
+    correct &= program.getCoreNum(3) == 3;
+  }
+
+  // -----------------------------
+  // Parallel chunks and memory
+  // -----------------------------
+  {
+    std::string program = readFile(testDir + "AllMMUnitTest/multicore.asm");
+    std::string text;
+    while (text.size() < (4u << 20))
+      text += "start_parallel\n" + program + "\nend_parallel\n" +
+              "barrier 0, 1, 2, 3\n";
+
+    parser.setNumThreads(1);
+    auto ops = parser.parseBuffer(text);
+    EPUProgram serial = parser.parseProgram(text);
+    parser.setNumThreads(4);
+    EPUProgram chunked = parser.parseProgram(text);
+
+    correct &= sameProgram(ops, serial);
+    correct &= toAsm(chunked.toOps()) == toAsm(ops);
+
+    size_t listBytes = opListBytes(ops);
+    std::cout << ops.size() << " ops take " << listBytes
+              << " bytes as an op list and " << chunked.getNumBytes()
+              << " bytes as an EPUProgram" << std::endl;
+    correct &= chunked.getNumBytes() * 2 <= listBytes;
+  }
+
+  // -----------------------------
+  // Stable indices
+  // -----------------------------
+  {
+    EPUProgram program;
+    SliceOperand first(1, Dim(0, 32, 1), Dim(0, 32, 1));
+    program.appendCopy(OpCode::GLOBAL_TO_LOCAL_MEM_COPY, 0, first,
+                       SliceOperand(0, Dim(0, 32, 1), Dim(0, 32, 1)));
+    program.appendBarrier({0, 1});
+    for (int i = 0; i < 10000; ++i) {
+      SliceOperand slice(i, Dim(i, i + 32, 1), Dim(0, i + 1, 2));
+      program.appendMatmul(i % 4, i % 8, slice, slice, slice, i % 2);
+      program.appendBarrier({i % 4, 3});
+    }
+    correct &= program.getSlice(0, 0) == first;
+    correct &= program.getBarrierCores(1) == std::vector<ID>({0, 1});
+    correct &= program.getSlice(2 + 2 * 9999, 2) ==
+               SliceOperand(9999, Dim(9999, 10031, 1), Dim(0, 10000, 2));
+    correct &= program.getBarrierCores(3 + 2 * 9999) ==
+               std::vector<ID>({3, 3});
+  }
+
+  // -----------------------------
+  // Errors
+  // -----------------------------
+  correct &=
+      rejects(parser, "\nsignal 40000, 1\n", "x.asm:2:8: core out of range");
+  correct &= rejects(parser, "bogus\n", "x.asm:1:1: unknown instruction");
+  correct &= rejects(parser, "start_parallel\n", "start_parallel without");
+
+  // -----------------------------
+  // Simulation
+  // -----------------------------
+  {
+    std::string filename = testDir + "AllMMUnitTest/multicore.asm";
+    std::vector<float> A(32 * 32), B(32 * 512);
+    for (int i = 0; i < 32 * 32; ++i)
+      A[i] = static_cast<float>(i % 11);
+    for (int i = 0; i < 32 * 512; ++i)
+      B[i] = static_cast<float>(i % 5 - 2);
+
+    std::vector<float> outputs[2];
+    for (int run = 0; run < 2; ++run) {
+      EPUSimulator sim(target);
+      sim.registerInputHandle(1, A.data(), A.size() * sizeof(float),
+                              {32, 32});
+      sim.registerInputHandle(2, B.data(), B.size() * sizeof(float),
+                              {32, 512});
+      sim.registerOutputHandle(3, 32 * 512 * sizeof(float), {32, 512});
+      if (run == 0)
+        sim.simulateInstructions(parser.parseFile(filename));
+      else
+        sim.simulateProgram(parser.parseProgramFile(filename));
+
+      outputs[run].resize(32 * 512);
+      sim.retrieveOutputData(3, outputs[run].data(),
+                             outputs[run].size() * sizeof(float));
+    }
+    correct &= outputs[0] == outputs[1];
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
@@ -0,0 +1,155 @@
+// This test drives one warm simulator through a long stream of jobs with
+// differently sized handles, releasing the handles after every job and
+// resetting it every few jobs. Global memory use must stay bounded, every
+// job must produce the right result from zeroed memory, and the allocator
+// must coalesce and reuse freed ranges.
+
+#include "Simulator/GlobalMemoryAllocator.h"
+#include "Target/EPU/CodeGen/EPUCodeGen.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static std::vector<std::unique_ptr<Op>> parseMatmul(const Processor &target,
+                                                    int M, int K, int N) {
+  auto asmStr = generateMatmulISAForEPU(M, N, K);
+
+  char file[] = "/tmp/mytmpfileXXXXXX";
+  int fd = mkstemp(file);
+  std::ofstream ofs(file);
+  ofs << asmStr;
+  ofs.close();
+  close(fd);
+
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(file);
+  unlink(file);
+  return operations;
+}
+
+static bool testAllocator() {
+  GlobalMemoryAllocator allocator(4096, 64);
+  size_t a, b, c, d;
+  bool correct = allocator.allocate(1000, a) && allocator.allocate(1000, b) &&
+                 allocator.allocate(1000, c);
+  correct &= a % 64 == 0 && b % 64 == 0 && c % 64 == 0;
+  correct &= allocator.getUsedBytes() == 3 * 1024;
+
+  // No room for another 1000 bytes until a neighbour pair is freed.
+  correct &= !allocator.allocate(2000, d);
+  allocator.release(a, 1000);
+  allocator.release(b, 1000);
+  correct &= allocator.getNumFreeRanges() == 2; // [a, c) and the tail
+  correct &= allocator.allocate(2000, d) && d == a;
+
+  allocator.release(c, 1000);
+  allocator.release(d, 2000);
+  correct &= allocator.getNumFreeRanges() == 1 && allocator.getUsedBytes() == 0;
+  return correct;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Reset Test..." << std::endl;
+
+  bool correct = testAllocator();
+
+  auto target = createEPUTarget();
+  auto small = parseMatmul(target, 32, 32, 32);
+  auto large = parseMatmul(target, 32, 128, 128);
+
+  EPUSimulator sim(target, EPUSimulatorOptions{0});
+  size_t maxInUse = 0;
+
+  for (int job = 0; job < 200; ++job) {
+    bool isLarge = job % 3 == 0;
+    int M = 32;
+    int K = isLarge ? 128 : 32;
+    int N = isLarge ? 128 : 32;
+
+    std::vector<float> A(M * K), B(K * N), C(M * N);
+    for (int i = 0; i < M * K; ++i)
+      A[i] = static_cast<float>((i % 13 + job % 7) / 10.0);
+    for (int i = 0; i < K * N; ++i)
+      B[i] = static_cast<float>((i % 11 - job % 5) / 10.0);
+
+    sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {M, K});
+    sim.registerInputHandle(2, B.data(), B.size() * sizeof(float), {K, N});
+    sim.registerOutputHandle(3, C.size() * sizeof(float), {M, N});
+    maxInUse = std::max(maxInUse, sim.getGlobalMemoryInUse());
+
+    EPUDecodedProgram program = sim.decode(isLarge ? large : small);
+    sim.simulateDecoded(program);
+    sim.retrieveOutputData(3, C.data(), C.size() * sizeof(float));
+
+    for (int i = 0; i < M && correct; ++i) {
+      for (int j = 0; j < N; ++j) {
+        float expected = 0.0f;
+        for (int k = 0; k < K; ++k)
+          expected += A[i * K + k] * B[k * N + j];
+        float tolerance = 1e-3f * (1 + std::abs(expected));
+        if (std::abs(C[i * N + j] - expected) > tolerance) {
+          std::cout << "Job " << job << " mismatch at (" << i << ", " << j
+                    << ")" << std::endl;
+          correct = false;
+          break;
+        }
+      }
+    }
+
+    if (job % 10 == 9) {
+      sim.reset();
+      correct &= sim.getGlobalMemoryInUse() == 0;
+
+      // Local memory reads as zero again.
+      float local[64];
+      sim.retrieveLocalMemoryData(1, 0, local, sizeof(local));
+      for (float value : local)
+        correct &= value == 0.0f;
+    } else {
+      sim.releaseHandle(1);
+      sim.releaseHandle(2);
+      sim.releaseHandle(3);
+      correct &= sim.getGlobalMemoryInUse() == 0;
+    }
+  }
+
+  // One large job's worth at most; memory never creeps up.
+  correct &= maxInUse <= (32 * 128 + 128 * 128 + 32 * 128) * sizeof(float);
+
+  // Released handles are gone, and releasing them again is an error.
+  bool threw = false;
+  try {
+    sim.releaseHandle(3);
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  correct &= threw;
+
+  // A fork resets to its image, even after releasing an image handle.
+  std::vector<float> weights(32 * 32, 3.0f);
+  sim.registerInputHandle(2, weights.data(), weights.size() * sizeof(float),
+                          {32, 32});
+  EPUSimulator fork(target, sim.createMemoryImage(), EPUSimulatorOptions{0});
+  fork.releaseHandle(2);
+  fork.registerOutputHandle(3, 32 * 32 * sizeof(float), {32, 32});
+  fork.reset();
+
+  std::vector<float> readBack(32 * 32);
+  fork.retrieveInputData(2, readBack.data(), readBack.size() * sizeof(float));
+  correct &= readBack == weights;
+  correct &= fork.getGlobalMemoryInUse() == sim.getGlobalMemoryInUse();
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
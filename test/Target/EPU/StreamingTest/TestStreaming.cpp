@@ -0,0 +1,221 @@
+// This test runs programs through the streaming simulator, where a parser
+// thread feeds decoded ops to the executing thread through a small queue. A
+// long program built from the AllMMUnit matmuls, streamed from text and from
+// a binary file, must give the same result as simulateInstructions while the
+// executor never holds more than a run of matmuls. The async DMA program
+// checks parallel regions and in-flight copies. A parse error must be thrown
+// after the ops before it have run, and unsupported modes must be rejected.
+
+#include "Target/EPU/Parser/EPUAsmParser.h"
+#include "Target/EPU/Parser/EPUBinaryFormat.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct Tensors {
+  std::vector<float> A;
+  std::vector<float> B;
+};
+
+static EPUSimulatorOptions streamingOptions() {
+  EPUSimulatorOptions options;
+  options.numWorkerThreads = 2;
+  options.streamQueueCapacity = 16;
+  return options;
+}
+
+static std::string readFile(const std::string &filename) {
+  std::ifstream in(filename);
+  std::ostringstream text;
+  text << in.rdbuf();
+  return text.str();
+}
+
+static std::string writeTempFile(const std::string &contents) {
+  char file[] = "/tmp/mytmpfileXXXXXX";
+  int fd = mkstemp(file);
+  std::ofstream ofs(file, std::ios::binary);
+  ofs << contents;
+  ofs.close();
+  close(fd);
+  return file;
+}
+
+// AllMMUnit's multicore program: A is 32x32, B and the output 32x512.
+static void registerMulticore(EPUSimulator &sim, const Tensors &t) {
+  sim.registerInputHandle(1, t.A.data(), t.A.size() * sizeof(float),
+                          {32, 32});
+  sim.registerInputHandle(2, t.B.data(), t.B.size() * sizeof(float),
+                          {32, 512});
+  sim.registerOutputHandle(3, 32 * 512 * sizeof(float), {32, 512});
+}
+
+static std::vector<float> multicoreOutput(EPUSimulator &sim) {
+  std::vector<float> out(32 * 512);
+  sim.retrieveOutputData(3, out.data(), out.size() * sizeof(float));
+  return out;
+}
+
+// The async DMA program: A is 32x128, B 128x32, outputs 32x32 and 32x64.
+static void registerPrefetch(EPUSimulator &sim, const Tensors &t) {
+  sim.registerInputHandle(1, t.A.data(), t.A.size() * sizeof(float),
+                          {32, 128});
+  sim.registerInputHandle(2, t.B.data(), t.B.size() * sizeof(float),
+                          {128, 32});
+  sim.registerOutputHandle(3, 32 * 32 * sizeof(float), {32, 32});
+  sim.registerOutputHandle(4, 32 * 64 * sizeof(float), {32, 64});
+}
+
+static std::vector<float> prefetchOutput(EPUSimulator &sim) {
+  std::vector<float> out(32 * 32 + 32 * 64);
+  sim.retrieveOutputData(3, out.data(), 32 * 32 * sizeof(float));
+  sim.retrieveOutputData(4, out.data() + 32 * 32, 32 * 64 * sizeof(float));
+  return out;
+}
+
+static bool throwsWith(const std::function<void()> &run,
+                       const std::string &expected) {
+  try {
+    run();
+  } catch (const std::runtime_error &e) {
+    std::cout << "Rejected: " << e.what() << std::endl;
+    return std::string(e.what()).find(expected) != std::string::npos;
+  }
+  return false;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Streaming Test..." << std::endl;
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  auto target = createEPUTarget();
+  auto parser = getTargetParser(target);
+  std::string testDir = std::string(std::getenv("ROOT_DIR")) +
+                        "/test/Target/EPU/";
+  bool correct = true;
+
+  // -----------------------------
+  // Long program
+  // -----------------------------
+  Tensors mm;
+  mm.A.resize(32 * 32);
+  mm.B.resize(32 * 512);
+  for (int i = 0; i < 32 * 32; ++i)
+    mm.A[i] = static_cast<float>(i % 11);
+  for (int i = 0; i < 32 * 512; ++i)
+    mm.B[i] = static_cast<float>(i % 5 - 2);
+
+  std::string program = readFile(testDir + "AllMMUnitTest/multicore.asm");
+  std::string text;
+  for (int i = 0; i < 500; ++i)
+    text += program + "\n";
+  auto operations = parser->parseFile(testDir + "AllMMUnitTest/multicore.asm");
+  size_t expectedOps = operations.size() * 500;
+
+  std::vector<float> expected;
+  {
+    EPUSimulator sim(target, streamingOptions());
+    registerMulticore(sim, mm);
+    sim.simulateInstructions(operations);
+    expected = multicoreOutput(sim);
+  }
+
+  for (bool binary : {false, true}) {
+    EPUSimulator sim(target, streamingOptions());
+    registerMulticore(sim, mm);
+
+    if (binary) {
+      std::ostringstream bytes;
+      writeEPUBinary(EPUAsmParser(target).parseBuffer(text), bytes);
+      std::string file = writeTempFile(bytes.str());
+      sim.simulateStreaming(file);
+      unlink(file.c_str());
+    } else {
+      sim.simulateStreamingText(text);
+    }
+
+    const EPUStreamStats &stats = sim.getStreamStats();
+    std::cout << "Streamed " << stats.opsStreamed << " ops from "
+              << (binary ? "binary" : "text") << ", at most "
+              << stats.maxBufferedOps << " buffered, " << stats.parserStalls
+              << " parser stalls, " << stats.executorStalls
+              << " executor stalls" << std::endl;
+    correct &= multicoreOutput(sim) == expected;
+    correct &= stats.opsStreamed == expectedOps;
+    correct &= stats.maxBufferedOps <= 64;
+  }
+
+  // -----------------------------
+  // Regions and async copies
+  // -----------------------------
+  {
+    Tensors pf;
+    pf.A.resize(32 * 128);
+    pf.B.resize(128 * 32);
+    for (int i = 0; i < 32 * 128; ++i)
+      pf.A[i] = static_cast<float>(i % 13);
+    for (int i = 0; i < 128 * 32; ++i)
+      pf.B[i] = static_cast<float>(i % 7 - 3);
+
+    std::string filename = testDir + "AsyncDMATest/prefetch.asm";
+    EPUSimulator reference(target, streamingOptions());
+    registerPrefetch(reference, pf);
+    reference.simulateInstructions(parser->parseFile(filename));
+
+    for (unsigned dmaThreads : {0u, 2u}) {
+      EPUSimulatorOptions options = streamingOptions();
+      options.numDMAThreads = dmaThreads;
+      EPUSimulator sim(target, options);
+      registerPrefetch(sim, pf);
+      sim.simulateStreaming(filename);
+      correct &= prefetchOutput(sim) == prefetchOutput(reference);
+    }
+  }
+
+  // -----------------------------
+  // Errors
+  // -----------------------------
+  {
+    EPUSimulator sim(target, streamingOptions());
+    registerMulticore(sim, mm);
+    std::string lineNo = std::to_string(
+        std::count(program.begin(), program.end(), '\n') + 3);
+    correct &= throwsWith(
+        [&]() { sim.simulateStreamingText(program + "\n\nbogus 1\n"); },
+        "<buffer>:" + lineNo + ":1: unknown instruction 'bogus'");
+    // Everything before the bad line has run.
+    correct &= multicoreOutput(sim) == expected;
+
+    correct &= throwsWith([&]() { sim.simulateStreamingText("wait 0, 3\n"); },
+                          "has no earlier signal");
+    correct &= throwsWith(
+        [&]() { sim.simulateStreamingText("end_parallel\n", "x.asm"); },
+        "x.asm:1:1: end_parallel without start_parallel");
+
+    EPUSimulatorOptions options = streamingOptions();
+    options.executionMode = EPUExecutionMode::DATAFLOW;
+    EPUSimulator dataflow(target, options);
+    correct &= throwsWith(
+        [&]() { dataflow.simulateStreamingText(program); }, "IN_ORDER");
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+// This test exercises the copy engine behind cp_global_to_local and
+// cp_local_to_global. It covers strided slices (gather into local memory and
+// scatter back to global memory), fully contiguous blocks and row-contiguous
+// sub-blocks, and verifies every copied element.
+
+#include "Utils/Utils.h"
+#include <array>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+int main() {
+  std::cout << "\nStarting EPU Strided Copy Test..." << std::endl;
+
+  auto target = createEPUTarget();
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  std::string filename = std::string(std::getenv("ROOT_DIR")) +
+                         "/test/Target/EPU/StridedCopyTest/strided.asm";
+
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(filename);
+
+  auto targetSim = getTargetSimulator(target);
+
+  float inputTensor[64][64];
+  static float stridedOutput[64][64];
+  static float blockOutput[64][64];
+
+  for (int i = 0; i < 64; ++i) {
+    for (int j = 0; j < 64; ++j) {
+      inputTensor[i][j] = static_cast<float>(i * 64 + j);
+    }
+  }
+
+  targetSim->registerInputHandle(1, inputTensor, sizeof(inputTensor),
+                                 {64, 64});
+  targetSim->registerOutputHandle(2, sizeof(stridedOutput), {64, 64});
+  targetSim->registerOutputHandle(3, sizeof(blockOutput), {64, 64});
+
+  targetSim->simulateInstructions(operations);
+
+  targetSim->retrieveOutputData(2, stridedOutput, sizeof(stridedOutput));
+  targetSim->retrieveOutputData(3, blockOutput, sizeof(blockOutput));
+
+  bool correct = true;
+  auto check = [&](const char *what, int i, int j, float got, float expected) {
+    if (correct && got != expected) {
+      std::cout << "Mismatch in " << what << " at (" << i << ", " << j
+                << "): expected " << expected << ", got " << got << std::endl;
+      correct = false;
+    }
+  };
+
+  // Odd columns of even rows, scattered to even columns of odd rows.
+  for (int i = 0; i < 32; ++i) {
+    for (int j = 0; j < 32; ++j) {
+      check("strided copy", i, j, stridedOutput[2 * i + 1][2 * j],
+            inputTensor[2 * i][2 * j + 1]);
+    }
+  }
+
+  // Rows 16..48 as one contiguous block.
+  for (int i = 0; i < 32; ++i) {
+    for (int j = 0; j < 64; ++j) {
+      check("block copy", i, j, blockOutput[i][j], inputTensor[16 + i][j]);
+    }
+  }
+
+  // 32x32 sub-block, row by row.
+  for (int i = 0; i < 32; ++i) {
+    for (int j = 0; j < 32; ++j) {
+      check("row copy", i, j, blockOutput[32 + i][16 + j],
+            inputTensor[i][8 + j]);
+    }
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
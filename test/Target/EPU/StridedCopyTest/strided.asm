@@ -0,0 +1,6 @@
+cp_global_to_local <1, 0:64:2, 1:64:2>, 0, <0, 0:32:1, 0:32:1>
+cp_local_to_global 0, <0, 0:32:1, 0:32:1>, <2, 1:64:2, 0:64:2>
+cp_global_to_local <1, 16:48:1, 0:64:1>, 1, <0, 0:32:1, 0:64:1>
+cp_local_to_global 1, <0, 0:32:1, 0:64:1>, <3, 0:32:1, 0:64:1>
+cp_global_to_local <1, 0:32:1, 8:40:1>, 2, <0, 0:32:1, 0:32:1>
+cp_local_to_global 2, <0, 0:32:1, 0:32:1>, <3, 32:64:1, 16:48:1>
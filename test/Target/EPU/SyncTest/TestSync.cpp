@@ -0,0 +1,194 @@
+// This test exercises the signal, wait and barrier synchronization ops. A
+// hand-written program orders stores of two cores to the same output, and
+// loads before the ops using them, inside a single parallel region purely
+// through a signal/wait pair and barriers. Results must match across the
+// IN_ORDER, DATAFLOW and PER_CORE execution modes. Inside an in-order
+// region a wait must also honor a signal issued before the region. Malformed
+// sync ops must be rejected by the parser, and a wait without an earlier
+// signal by the decoder.
+
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static std::vector<float>
+runProgram(const std::vector<std::unique_ptr<Op>> &ops,
+           const EPUSimulatorOptions &options, const std::vector<float> &A,
+           const std::vector<float> &B) {
+  EPUSimulator sim(createEPUTarget(), options);
+  sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {32, 32});
+  sim.registerInputHandle(2, B.data(), B.size() * sizeof(float), {32, 64});
+  sim.registerOutputHandle(3, 32 * 64 * sizeof(float), {32, 64});
+  sim.registerOutputHandle(4, 32 * 32 * sizeof(float), {32, 32});
+
+  sim.simulateInstructions(ops);
+
+  std::vector<float> out(32 * 64 + 32 * 32);
+  sim.retrieveOutputData(3, out.data(), 32 * 64 * sizeof(float));
+  sim.retrieveOutputData(4, out.data() + 32 * 64, 32 * 32 * sizeof(float));
+  return out;
+}
+
+static std::string writeTempAsm(const std::string &text) {
+  char file[] = "/tmp/mytmpfileXXXXXX";
+  int fd = mkstemp(file);
+  std::ofstream ofs(file);
+  ofs << text;
+  ofs.close();
+  close(fd);
+  return file;
+}
+
+static bool rejectsAsm(const std::string &text) {
+  auto parser = getTargetParser(createEPUTarget());
+  std::string file = writeTempAsm(text);
+  bool rejected = false;
+  try {
+    parser->parseFile(file);
+  } catch (const std::runtime_error &) {
+    rejected = true;
+  }
+  unlink(file.c_str());
+  return rejected;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Sync Test..." << std::endl;
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  auto target = createEPUTarget();
+  auto parser = getTargetParser(target);
+  bool correct = true;
+
+  // -----------------------------
+  // Ordering across modes
+  // -----------------------------
+  {
+    std::string filename = std::string(std::getenv("ROOT_DIR")) +
+                           "/test/Target/EPU/SyncTest/sync.asm";
+    auto operations = parser->parseFile(filename);
+
+    std::vector<float> A(32 * 32), B(32 * 64);
+    for (int i = 0; i < 32 * 32; ++i)
+      A[i] = static_cast<float>(i % 13);
+    for (int i = 0; i < 32 * 64; ++i)
+      B[i] = static_cast<float>(i % 7 - 3);
+
+    EPUSimulatorOptions inOrder;
+    inOrder.numWorkerThreads = 2;
+    auto expected = runProgram(operations, inOrder, A, B);
+
+    // Core 1's store of the left half of B lands after core 0's store of A,
+    // and core 1 multiplies A by the left half of B.
+    for (int i = 0; i < 32; ++i)
+      for (int j = 0; j < 32; ++j) {
+        correct &= expected[i * 64 + j] == B[i * 64 + j];
+        correct &= expected[i * 64 + 32 + j] == B[i * 64 + 32 + j];
+
+        float sum = 0;
+        for (int k = 0; k < 32; ++k)
+          sum += A[i * 32 + k] * B[k * 64 + j];
+        correct &= expected[32 * 64 + i * 32 + j] == sum;
+      }
+
+    for (EPUExecutionMode mode :
+         {EPUExecutionMode::DATAFLOW, EPUExecutionMode::PER_CORE}) {
+      EPUSimulatorOptions options;
+      options.executionMode = mode;
+      auto got = runProgram(operations, options, A, B);
+      if (std::memcmp(expected.data(), got.data(),
+                      expected.size() * sizeof(float)) != 0) {
+        std::cout << "Result differs from in-order execution" << std::endl;
+        correct = false;
+      }
+    }
+  }
+
+  // -----------------------------
+  // Signals from before a region
+  // -----------------------------
+  {
+    // Core 1's first wait consumes the signal issued before the region, its
+    // second the one core 0 issues after its store, so core 1's store of A
+    // lands last; the wait also orders core 1's load before its store.
+    // Core 2 only orders its own ops.
+    std::string file = writeTempAsm(
+        "signal 0, 2\n"
+        "start_parallel\n"
+        "cp_global_to_local <2, 0:32:1, 0:32:1>, 0, <0, 0:32:1, 0:32:1>\n"
+        "cp_global_to_local <1, 0:32:1, 0:32:1>, 1, <0, 0:32:1, 0:32:1>\n"
+        "barrier 0\n"
+        "cp_local_to_global 0, <0, 0:32:1, 0:32:1>, <3, 0:32:1, 0:32:1>\n"
+        "signal 0, 2\n"
+        "wait 1, 2\n"
+        "wait 1, 2\n"
+        "cp_local_to_global 1, <0, 0:32:1, 0:32:1>, <3, 0:32:1, 0:32:1>\n"
+        "cp_global_to_local <2, 0:32:1, 32:64:1>, 2, <0, 0:32:1, 0:32:1>\n"
+        "barrier 2\n"
+        "cp_local_to_global 2, <0, 0:32:1, 0:32:1>, <3, 0:32:1, 32:64:1>\n"
+        "end_parallel\n");
+    auto operations = parser->parseFile(file);
+    unlink(file.c_str());
+
+    std::vector<float> A(32 * 32), B(32 * 64);
+    for (int i = 0; i < 32 * 32; ++i)
+      A[i] = static_cast<float>(i % 13 + 1);
+    for (int i = 0; i < 32 * 64; ++i)
+      B[i] = static_cast<float>(-(i % 7) - 1);
+
+    EPUSimulatorOptions options;
+    options.numWorkerThreads = 4;
+    for (int run = 0; run < 20; ++run) {
+      auto got = runProgram(operations, options, A, B);
+      for (int i = 0; i < 32; ++i)
+        for (int j = 0; j < 32; ++j) {
+          correct &= got[i * 64 + j] == A[i * 32 + j];
+          correct &= got[i * 64 + 32 + j] == B[i * 64 + 32 + j];
+        }
+    }
+  }
+
+  // -----------------------------
+  // Malformed sync ops
+  // -----------------------------
+  correct &= rejectsAsm("signal 0\n");
+  correct &= rejectsAsm("wait 0, 1, 2\n");
+  correct &= rejectsAsm("barrier\n");
+
+  // -----------------------------
+  // Wait without a signal
+  // -----------------------------
+  {
+    std::string file = writeTempAsm("signal 0, 1\nwait 1, 0\n");
+    auto operations = parser->parseFile(file);
+    unlink(file.c_str());
+
+    EPUSimulator sim(target);
+    bool rejected = false;
+    try {
+      sim.decode(operations);
+    } catch (const std::runtime_error &e) {
+      std::cout << "Rejected: " << e.what() << std::endl;
+      rejected = true;
+    }
+    correct &= rejected;
+  }
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
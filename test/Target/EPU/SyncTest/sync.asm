@@ -0,0 +1,17 @@
+start_parallel
+cp_global_to_local <1, 0:32:1, 0:32:1>, 0, <0, 0:32:1, 0:32:1>
+cp_global_to_local <2, 0:32:1, 0:32:1>, 1, <0, 0:32:1, 0:32:1>
+cp_global_to_local <1, 0:32:1, 0:32:1>, 1, <4096, 0:32:1, 0:32:1>
+barrier 0
+cp_local_to_global 0, <0, 0:32:1, 0:32:1>, <3, 0:32:1, 0:32:1>
+cp_global_to_local <2, 0:32:1, 32:64:1>, 0, <4096, 0:32:1, 0:32:1>
+signal 0, 0
+wait 1, 0
+cp_local_to_global 1, <0, 0:32:1, 0:32:1>, <3, 0:32:1, 0:32:1>
+barrier 0, 1
+matmul 1, 0, <4096, 0:32:1, 0:32:1>, <0, 0:32:1, 0:32:1>, <8192, 0:32:1, 0:32:1>, accumulator=False
+cp_local_to_global 0, <4096, 0:32:1, 0:32:1>, <3, 0:32:1, 32:64:1>
+signal 1, 1
+wait 0, 1
+cp_local_to_global 1, <8192, 0:32:1, 0:32:1>, <4, 0:32:1, 0:32:1>
+end_parallel
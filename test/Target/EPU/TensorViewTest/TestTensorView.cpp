@@ -0,0 +1,148 @@
+// This test reads a codegen-produced matmul's tensors in place through
+// TensorViews. Views must show exactly what the retrieve* copies return,
+// reject out-of-range accesses, and stop working once the simulator state
+// they were taken from changes. The copying retrieve* calls must reject
+// reads past the end of a handle or a core's local memory.
+
+#include "Target/EPU/CodeGen/EPUCodeGen.h"
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static constexpr int M = 32;
+static constexpr int K = 64;
+static constexpr int N = 128;
+
+static bool throws(const std::function<void()> &fn) {
+  try {
+    fn();
+  } catch (const std::runtime_error &error) {
+    std::cout << "Rejected: " << error.what() << std::endl;
+    return true;
+  }
+  return false;
+}
+
+int main() {
+  std::cout << "\nStarting EPU Tensor View Test..." << std::endl;
+
+  auto asmStr = generateMatmulISAForEPU(M, N, K);
+
+  char file[] = "/tmp/mytmpfileXXXXXX";
+  int fd = mkstemp(file);
+  std::ofstream ofs(file);
+  ofs << asmStr;
+  ofs.close();
+  close(fd);
+
+  auto target = createEPUTarget();
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(file);
+  unlink(file);
+
+  std::vector<float> A(M * K), B(K * N);
+  for (int i = 0; i < M * K; ++i)
+    A[i] = static_cast<float>((i % 37) / 10.0);
+  for (int i = 0; i < K * N; ++i)
+    B[i] = static_cast<float>((i % 23 - 11) / 10.0);
+
+  EPUSimulator sim(target, EPUSimulatorOptions{0});
+  sim.registerInputHandle(1, A.data(), A.size() * sizeof(float), {M, K});
+  sim.registerInputHandle(2, B.data(), B.size() * sizeof(float), {K, N});
+  sim.registerOutputHandle(3, M * N * sizeof(float), {M, N});
+  sim.simulateInstructions(operations);
+
+  bool correct = true;
+
+  // -----------------------------
+  // Handle views
+  // -----------------------------
+  std::vector<float> C(M * N);
+  sim.retrieveOutputData(3, C.data(), C.size() * sizeof(float));
+
+  TensorView<float> output = sim.getOutputView(3);
+  correct &= output.getRows() == M && output.getCols() == N;
+  correct &= output.isContiguous();
+  correct &= std::memcmp(output.data(), C.data(),
+                         C.size() * sizeof(float)) == 0;
+  correct &= output(M - 1, N - 1) == C[M * N - 1];
+
+  TensorView<float> input = sim.getInputView(1);
+  correct &= input.getRows() == M && input.getCols() == K;
+  correct &= std::memcmp(input.row(3), A.data() + 3 * K,
+                         K * sizeof(float)) == 0;
+
+  correct &= throws([&]() { output(M, 0); });
+  correct &= throws([&]() { output(0, -1); });
+  correct &= throws([&]() { sim.getOutputView(1); });
+
+  // -----------------------------
+  // Local memory views
+  // -----------------------------
+  std::vector<float> local(16 * 32);
+  sim.retrieveLocalMemoryData(0, 0, local.data(),
+                              local.size() * sizeof(float));
+  TensorView<float> localView = sim.getLocalMemoryView(0, 0, 16, 8, 32);
+  correct &= !localView.isContiguous();
+  for (int r = 0; r < 16; ++r)
+    for (int c = 0; c < 8; ++c)
+      correct &= localView(r, c) == local[r * 32 + c];
+
+  size_t localBytes = target.getLocalMemoryPerCore();
+  correct &= throws([&]() {
+    sim.getLocalMemoryView(0, localBytes - 4 * sizeof(float), 1, 8);
+  });
+  correct &= throws([&]() { sim.getLocalMemoryView(0, 2, 1, 1); });
+  correct &= throws([&]() { sim.getLocalMemoryView(4, 0, 1, 1); });
+
+  // -----------------------------
+  // Bounds checks on copies
+  // -----------------------------
+  std::vector<float> tooLarge(M * N + 1);
+  correct &= throws([&]() {
+    sim.retrieveOutputData(3, tooLarge.data(),
+                           tooLarge.size() * sizeof(float));
+  });
+  correct &= throws([&]() {
+    sim.retrieveInputData(1, tooLarge.data(), (M * K + 1) * sizeof(float));
+  });
+  correct &= throws([&]() {
+    sim.retrieveLocalMemoryData(0, localBytes - 4, tooLarge.data(), 8);
+  });
+  correct &= throws([&]() {
+    sim.retrieveLocalMemoryData(0, -4, tooLarge.data(), 4);
+  });
+  correct &= throws([&]() {
+    sim.retrieveLocalMemoryData(0, localBytes + 4, tooLarge.data(), 4);
+  });
+
+  // -----------------------------
+  // Lifetime
+  // -----------------------------
+  // Registering an unrelated handle still invalidates every view.
+  correct &= output.isValid() && localView.isValid();
+  sim.registerOutputHandle(4, sizeof(float), {1, 1});
+  correct &= !output.isValid() && !input.isValid() && !localView.isValid();
+  correct &= throws([&]() { output.data(); });
+
+  TensorView<float> fresh = sim.getOutputView(3);
+  correct &= fresh(1, 2) == C[N + 2];
+  sim.reset();
+  correct &= !fresh.isValid();
+  correct &= throws([&]() { fresh(1, 2); });
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+// This test checks the cycle predictions of the EPU timing model against
+// hand-computed schedules. With the default parameters a 32x32 float copy
+// costs 64 + 4096 / 64 = 128 cycles, a 32x32x32 matmul 16 + 32768 / 1024 = 48
+// cycles and an end_parallel join 32 cycles.
+
+#include "Target/EPU/Simulator/EPUSimulator.h"
+#include "Utils/Utils.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+static EPUTimingReport runProgram(const Processor &target,
+                                  const std::string &filename,
+                                  EPUExecutionMode mode) {
+  auto parser = getTargetParser(target);
+  auto operations = parser->parseFile(filename);
+
+  float inputTensorA[32][32] = {};
+  float inputTensorB[32][64] = {};
+
+  EPUSimulatorOptions options;
+  options.executionMode = mode;
+  options.enableTimingModel = true;
+  EPUSimulator sim(target, options);
+  sim.registerInputHandle(1, inputTensorA, sizeof(inputTensorA), {32, 32});
+  sim.registerInputHandle(2, inputTensorB, sizeof(inputTensorB), {32, 64});
+  sim.registerOutputHandle(3, 32 * 64 * sizeof(float), {32, 64});
+  sim.simulateInstructions(operations);
+
+  // Estimating without running predicts the same schedule.
+  EPUTimingReport estimate = sim.estimateTiming(sim.decode(operations));
+  if (estimate.totalCycles != sim.getTimingReport().totalCycles)
+    throw std::runtime_error("Error: estimate differs from simulated run");
+
+  return sim.getTimingReport();
+}
+
+int main() {
+  std::cout << "\nStarting EPU Timing Model Test..." << std::endl;
+
+  auto target = createEPUTarget();
+
+  if (std::getenv("ROOT_DIR") == nullptr) {
+    throw std::runtime_error(
+        "Error: ROOT_DIR environment variable is not set.");
+  }
+
+  std::string testDir =
+      std::string(std::getenv("ROOT_DIR")) + "/test/Target/EPU/";
+  std::string basic = testDir + "BasicTest/basic.asm";
+  std::string parallel = testDir + "ParalellDispatchTest/parallel.asm";
+  std::string sync = testDir + "TimingModelTest/sync.asm";
+
+  bool correct = true;
+
+  // Two loads, a matmul and a store back to back on core 1.
+  EPUTimingReport report =
+      runProgram(target, basic, EPUExecutionMode::IN_ORDER);
+  correct &= report.totalCycles == 128 + 128 + 48 + 128;
+  correct &= report.cores[1].busyCycles == report.totalCycles;
+  correct &= report.cores[1].idleCycles == 0;
+  correct &= report.cores[0].busyCycles == 0;
+  correct &= report.cores[1].dmaOps == 3;
+  correct &= report.cores[1].matmulUnits[0].numOps == 1;
+  correct &= report.cores[1].matmulUnits[0].busyCycles == 48;
+
+  // Four regions, each running one op on cores 1 and 2 and then joining.
+  report = runProgram(target, parallel, EPUExecutionMode::IN_ORDER);
+  correct &= report.totalCycles == 3 * (128 + 32) + (48 + 32);
+  correct &= report.joinCycles == 4 * 32;
+  correct &= report.cores[2].busyCycles == 3 * 128 + 48;
+  correct &= report.cores[2].idleCycles == 4 * 32;
+
+  // Dataflow drops the joins; the second load on each core queues behind
+  // the first on the core's DMA engine. The two stores interleave rows of
+  // handle 3, so their bounding footprints overlap and they run one after
+  // the other.
+  report = runProgram(target, parallel, EPUExecutionMode::DATAFLOW);
+  correct &= report.totalCycles == 128 + 128 + 48 + 128 + 128;
+  correct &= report.joinCycles == 0;
+  correct &= report.cores[1].busyCycles == 3 * 128 + 48;
+  correct &= report.cores[1].idleCycles == 128;
+
+  // Core 1 waits for core 0's load, but cores 2 and 3 take part in no sync
+  // op: core 3's two loads start with the region, overlapping the signal
+  // and wait, and end with core 1's load.
+  report = runProgram(target, sync, EPUExecutionMode::IN_ORDER);
+  correct &= report.totalCycles == 2 * 128 + 32;
+  correct &= report.cores[1].busyCycles == 128;
+  correct &= report.cores[1].idleCycles == 128 + 32;
+  correct &= report.cores[3].busyCycles == 2 * 128;
+  correct &= report.cores[3].idleCycles == 32;
+
+  // Parameters come from the processor description.
+  for (ComputeCore &core : target.compute_cores) {
+    core.setDMATiming(100, 32);
+    for (MatmulUnit &unit : core.getMatmulUnits())
+      unit.setTiming(10, 512);
+  }
+  target.setJoinCycles(0);
+
+  report = runProgram(target, basic, EPUExecutionMode::IN_ORDER);
+  correct &= report.totalCycles == 3 * (100 + 4096 / 32) + (10 + 32768 / 512);
+
+  report.print(std::cout);
+
+  if (correct) {
+    std::cout << "Output verified successfully" << std::endl;
+  } else {
+    throw std::runtime_error("Error: Output verification failed");
+  }
+
+  return 0;
+}
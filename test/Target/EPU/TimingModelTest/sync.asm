@@ -0,0 +1,9 @@
+start_parallel
+cp_global_to_local <1, 0:32:1, 0:32:1>, 0, <0, 0:32:1, 0:32:1>
+cp_global_to_local <1, 0:32:1, 0:32:1>, 2, <0, 0:32:1, 0:32:1>
+signal 0, 0
+wait 1, 0
+cp_global_to_local <2, 0:32:1, 0:32:1>, 1, <0, 0:32:1, 0:32:1>
+cp_global_to_local <2, 0:32:1, 0:32:1>, 3, <0, 0:32:1, 0:32:1>
+cp_global_to_local <2, 0:32:1, 32:64:1>, 3, <4096, 0:32:1, 0:32:1>
+end_parallel
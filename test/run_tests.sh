@@ -3,4 +3,26 @@ $ROOT_DIR/build/test/Target/EPU/BasicTest/test_epu_basic
 $ROOT_DIR/build/test/Target/EPU/MultiCoreTest/test_epu_multicore
 $ROOT_DIR/build/test/Target/EPU/ParalellDispatchTest/test_epu_parallel_dispatch
 $ROOT_DIR/build/test/Target/EPU/MatmulCodegenTest/test_epu_mm_codegen
-$ROOT_DIR/build/test/Target/EPU/AllMMUnitTest/test_epu_allmmunit
\ No newline at end of file
+$ROOT_DIR/build/test/Target/EPU/AllMMUnitTest/test_epu_allmmunit
+$ROOT_DIR/build/test/Target/EPU/MatmulKernelTest/test_epu_mm_kernel
+$ROOT_DIR/build/test/Target/EPU/StridedCopyTest/test_epu_strided_copy
+$ROOT_DIR/build/test/Target/EPU/DataflowTest/test_epu_dataflow
+$ROOT_DIR/build/test/Target/EPU/MemoryUsageTest/test_epu_memory_usage
+$ROOT_DIR/build/test/Target/EPU/ExternalInputTest/test_epu_external_input
+$ROOT_DIR/build/test/Target/EPU/HandleTableTest/test_epu_handle_table
+$ROOT_DIR/build/test/Target/EPU/TimingModelTest/test_epu_timing_model
+$ROOT_DIR/build/test/Target/EPU/ProfilerTest/test_epu_profiler
+$ROOT_DIR/build/test/Target/EPU/BatchTest/test_epu_batch
+$ROOT_DIR/build/test/Target/EPU/MemoryImageTest/test_epu_memory_image
+$ROOT_DIR/build/test/Target/EPU/ResetTest/test_epu_reset
+$ROOT_DIR/build/test/Target/EPU/PipelineTest/test_epu_pipeline
+$ROOT_DIR/build/test/Target/EPU/TensorViewTest/test_epu_tensor_view
+$ROOT_DIR/build/test/Target/EPU/IntraOpTest/test_epu_intra_op
+$ROOT_DIR/build/test/Target/EPU/PerCoreTest/test_epu_per_core
+$ROOT_DIR/build/test/Target/EPU/SyncTest/test_epu_sync
+$ROOT_DIR/build/test/Target/EPU/AsyncDMATest/test_epu_async_dma
+$ROOT_DIR/build/test/Target/EPU/MatmulUnitTest/test_epu_matmul_unit
+$ROOT_DIR/build/test/Target/EPU/AsmParserTest/test_epu_asm_parser
+$ROOT_DIR/build/test/Target/EPU/BinaryFormatTest/test_epu_binary_format
+$ROOT_DIR/build/test/Target/EPU/StreamingTest/test_epu_streaming
+$ROOT_DIR/build/test/Target/EPU/ProgramTest/test_epu_program
\ No newline at end of file
@@ -0,0 +1,52 @@
+// Converts EPU programs between assembly and the binary program format.
+//
+//   epu_convert <input> <output>
+//
+// The direction follows the input: a binary program is printed as assembly,
+// anything else is parsed as assembly and written as a binary program.
+
+#include "Target/EPU/Parser/EPUAsmParser.h"
+#include "Target/EPU/Parser/EPUBinaryFormat.h"
+#include "Utils/MappedFile.h"
+#include "Utils/Utils.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <input> <output>" << std::endl;
+    return 1;
+  }
+  std::string input = argv[1];
+  std::string output = argv[2];
+
+  try {
+    MappedFile file(input);
+    if (isEPUBinary(file.getData(), file.getSize())) {
+      auto ops = loadEPUBinary(file.getData(), file.getSize(), input);
+      std::ofstream ofs(output, std::ios::trunc);
+      if (!ofs.is_open())
+        throw std::runtime_error("Cannot open file: " + output);
+      writeEPUAsm(ops, ofs);
+      if (!ofs.flush())
+        throw std::runtime_error("Cannot write file: " + output);
+      std::cout << "Wrote " << ops.size() << " ops as assembly to " << output
+                << std::endl;
+    } else {
+      EPUAsmParser parser(createEPUTarget());
+      std::string_view text(reinterpret_cast<const char *>(file.getData()),
+                            file.getSize());
+      auto ops = parser.parseBuffer(text, input);
+      writeEPUBinaryFile(ops, output);
+      std::cout << "Wrote " << ops.size() << " ops as binary to " << output
+                << std::endl;
+    }
+  } catch (const std::runtime_error &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}